@@ -73,7 +73,10 @@ compile() {
     CC="gcc"
     CFLAGS="-std=c99 -Wall"
     LDFLAGS="$(sdl2-config --cflags --libs) -lSDL2_image -lSDL2_ttf -lSDL2_mixer"
-    SOURCES="scripts/main.c scripts/knight.c scripts/map.c scripts/render.c scripts/input.c scripts/camera.c scripts/blocks.c scripts/enemy.c scripts/ui.c scripts/sound.c"
+    if [ "$(uname -s)" = "Linux" ]; then
+        LDFLAGS="${LDFLAGS} -lrt"  # 共享内存状态导出（旧版glibc的shm_open在librt中）
+    fi
+    SOURCES="scripts/main.c scripts/game.c scripts/replay.c scripts/hash.c scripts/statehash.c scripts/alloc_track.c scripts/log.c scripts/telemetry.c scripts/snapshot.c scripts/rewind.c scripts/coop.c scripts/netplay.c scripts/shm_export.c scripts/endless.c scripts/tilepage.c scripts/spawn.c scripts/patrol.c scripts/trigger.c scripts/events.c scripts/timer.c scripts/anim.c scripts/drawlist.c scripts/knight.c scripts/map.c scripts/render.c scripts/input.c scripts/camera.c scripts/blocks.c scripts/enemy.c scripts/ui.c scripts/sound.c"
     TARGET="knight_game"
     
     # 显示编译命令
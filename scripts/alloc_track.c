@@ -0,0 +1,137 @@
+// alloc_track.c
+// 内存分配统计实现
+//
+// 两个入口：SDL_SetMemoryFunctions 捕获SDL及其扩展库（TTF、纹理等）的分配；
+// 使用 ALLOC_TRACK_WRAP 编译并以 -Wl,--wrap=malloc 等链接时（make debug），
+// 游戏代码自身的malloc/calloc/realloc也会经过这里。
+// 只统计主线程，音频线程的分配不影响逐帧结果。
+
+#include "alloc_track.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tracking = 0;
+static int assert_enabled = 0;
+static SDL_threadID main_thread = 0;
+
+// 当前帧统计
+static unsigned int frame_allocs = 0;
+static unsigned long frame_bytes = 0;
+
+// 汇总统计
+static unsigned long long total_allocs = 0;
+static unsigned long long total_bytes = 0;
+static unsigned int steady_frames = 0;      // 稳态帧数
+static unsigned int dirty_frames = 0;       // 发生了分配的稳态帧数
+static unsigned int max_frame_allocs = 0;   // 单个稳态帧的最大分配次数
+
+// SDL原有的内存函数
+static SDL_malloc_func real_sdl_malloc = NULL;
+static SDL_calloc_func real_sdl_calloc = NULL;
+static SDL_realloc_func real_sdl_realloc = NULL;
+static SDL_free_func real_sdl_free = NULL;
+
+static void count_alloc(size_t size) {
+    if (!tracking || SDL_ThreadID() != main_thread) return;
+    frame_allocs++;
+    frame_bytes += size;
+}
+
+static void* SDLCALL track_malloc(size_t size) {
+    count_alloc(size);
+    return real_sdl_malloc(size);
+}
+
+static void* SDLCALL track_calloc(size_t count, size_t size) {
+    count_alloc(count * size);
+    return real_sdl_calloc(count, size);
+}
+
+static void* SDLCALL track_realloc(void* ptr, size_t size) {
+    count_alloc(size);
+    return real_sdl_realloc(ptr, size);
+}
+
+static void SDLCALL track_free(void* ptr) {
+    real_sdl_free(ptr);
+}
+
+#ifdef ALLOC_TRACK_WRAP
+// 链接器 --wrap 生成的符号：__real_xxx 指向libc原函数
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    count_alloc(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    count_alloc(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    count_alloc(size);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+// 安装统计钩子
+void alloc_track_install(int assert_mode) {
+    SDL_GetMemoryFunctions(&real_sdl_malloc, &real_sdl_calloc, &real_sdl_realloc, &real_sdl_free);
+    if (SDL_SetMemoryFunctions(track_malloc, track_calloc, track_realloc, track_free) != 0) {
+        printf("无法安装内存统计钩子: %s\n", SDL_GetError());
+        return;
+    }
+    main_thread = SDL_ThreadID();
+    assert_enabled = assert_mode;
+    tracking = 1;
+#ifdef ALLOC_TRACK_WRAP
+    printf("内存分配统计已开启（SDL内存函数 + malloc包装）%s\n", assert_mode ? "，稳态帧零分配断言" : "");
+#else
+    printf("内存分配统计已开启（SDL内存函数）%s\n", assert_mode ? "，稳态帧零分配断言" : "");
+#endif
+}
+
+// 是否已安装统计钩子
+int alloc_track_enabled() {
+    return tracking;
+}
+
+// 开始统计新的一帧
+void alloc_track_frame_begin() {
+    frame_allocs = 0;
+    frame_bytes = 0;
+}
+
+// 结束一帧
+void alloc_track_frame_end(int steady_state) {
+    if (!tracking) return;
+    
+    total_allocs += frame_allocs;
+    total_bytes += frame_bytes;
+    if (!steady_state) return;
+    
+    steady_frames++;
+    if (frame_allocs == 0) return;
+    
+    dirty_frames++;
+    if (frame_allocs > max_frame_allocs) {
+        max_frame_allocs = frame_allocs;
+    }
+    if (assert_enabled) {
+        printf("断言失败：稳态游戏帧发生了 %u 次内存分配（%lu 字节）\n", frame_allocs, frame_bytes);
+        alloc_track_report();
+        abort();
+    }
+}
+
+// 打印统计汇总
+void alloc_track_report() {
+    if (!tracking) return;
+    printf("内存分配统计：共 %llu 次 / %llu 字节；稳态帧 %u 个，其中 %u 个有分配（单帧最多 %u 次）\n",
+           total_allocs, total_bytes, steady_frames, dirty_frames, max_frame_allocs);
+}
@@ -0,0 +1,16 @@
+// alloc_track.h
+// 内存分配统计头文件（按帧统计主线程的分配次数和字节数）
+
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+// 安装统计钩子（需在SDL初始化之前调用）
+// assert_mode为1时，稳态游戏帧一旦发生分配就打印信息并中止程序
+void alloc_track_install(int assert_mode);
+int alloc_track_enabled();           // 是否已安装统计钩子
+
+void alloc_track_frame_begin();      // 开始统计新的一帧
+void alloc_track_frame_end(int steady_state); // 结束一帧；steady_state表示本帧应当零分配
+void alloc_track_report();           // 打印统计汇总（程序退出时调用）
+
+#endif // ALLOC_TRACK_H
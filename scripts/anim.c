@@ -0,0 +1,186 @@
+// anim.c
+// 动画片段表和图集实现
+
+#include "anim.h"
+#include "log.h"
+#include <SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+
+static AnimClip clips[ANIM_MAX_CLIPS];
+static int clip_count = 0;
+static SDL_Rect frame_rects[ANIM_MAX_FRAMES];   // 每一帧在图集中的位置
+static int frame_count = 0;
+static SDL_Texture* atlas = NULL;
+
+// 释放载入过程中的帧图片
+static void free_surfaces(SDL_Surface** surfaces, int count) {
+    for (int i = 0; i < count; i++) {
+        if (surfaces[i]) SDL_FreeSurface(surfaces[i]);
+    }
+}
+
+// 帧文件名模板必须正好含一个%d且没有其他%转换（模板来自数据文件，会被用作格式串）
+static int valid_pattern(const char* pattern) {
+    int conversions = 0;
+    for (const char* p = pattern; *p; p++) {
+        if (*p != '%') continue;
+        if (p[1] != 'd') return 0;
+        conversions++;
+        p++;
+    }
+    return conversions == 1;
+}
+
+// 解析片段表的一行，载入这个片段的所有帧图片；空行和注释返回0，出错返回-1
+static int parse_clip(const char* line, int line_number, SDL_Surface** surfaces) {
+    char name[32], mode[16], pattern[224];
+    int frames, ticks;
+    if (line[0] == '#' || sscanf(line, "%31s", name) != 1) return 0;
+    if (sscanf(line, "%31s %d %d %15s %223s", name, &frames, &ticks, mode, pattern) != 5 ||
+        frames < 1 || ticks < 1 || (strcmp(mode, "loop") != 0 && strcmp(mode, "once") != 0)) {
+        printf("动画片段表第%d行格式错误: %s", line_number, line);
+        return -1;
+    }
+    if (!valid_pattern(pattern)) {
+        LOG_ERROR("动画片段表第%d行：帧文件名必须正好包含一个%%d: %s", line_number, pattern);
+        return -1;
+    }
+    if (clip_count >= ANIM_MAX_CLIPS || frame_count + frames > ANIM_MAX_FRAMES) {
+        printf("动画片段表第%d行：片段或帧数超过上限\n", line_number);
+        return -1;
+    }
+
+    AnimClip* clip = &clips[clip_count];
+    strcpy(clip->name, name);
+    clip->first_frame = frame_count;
+    clip->frame_count = frames;
+    clip->frame_ticks = ticks;
+    clip->loop = strcmp(mode, "loop") == 0 ? ANIM_LOOP : ANIM_ONCE;
+
+    char filename[256];
+    for (int i = 0; i < frames; i++) {
+        snprintf(filename, sizeof(filename), pattern, i + 1);
+        SDL_Surface* surface = IMG_Load(filename);
+        if (!surface) {
+            printf("无法加载%s动画帧 %d: %s\n", name, i + 1, filename);
+            return -1;
+        }
+        if (surface->w > ANIM_ATLAS_WIDTH) {
+            LOG_ERROR("%s动画帧 %d 宽%d像素，超过图集宽度%d: %s", name, i + 1, surface->w, ANIM_ATLAS_WIDTH, filename);
+            SDL_FreeSurface(surface);
+            return -1;
+        }
+        surfaces[frame_count++] = surface;
+    }
+    clip_count++;
+    return 1;
+}
+
+// 按行依次排放所有帧，返回图集高度（载入时已保证每帧都不比图集宽）
+static int layout_atlas(SDL_Surface** surfaces) {
+    int x = 0, y = 0, row_height = 0;
+    for (int i = 0; i < frame_count; i++) {
+        int w = surfaces[i]->w, h = surfaces[i]->h;
+        if (x + w > ANIM_ATLAS_WIDTH) {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        frame_rects[i].x = x;
+        frame_rects[i].y = y;
+        frame_rects[i].w = w;
+        frame_rects[i].h = h;
+        x += w;
+        if (h > row_height) row_height = h;
+    }
+    return y + row_height;
+}
+
+int anim_load(SDL_Renderer* renderer, const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("无法打开动画片段表: %s\n", path);
+        return 0;
+    }
+
+    SDL_Surface* surfaces[ANIM_MAX_FRAMES];
+    char line[320];
+    int line_number = 0;
+    clip_count = 0;
+    frame_count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (parse_clip(line, ++line_number, surfaces) < 0) {
+            fclose(file);
+            free_surfaces(surfaces, frame_count);
+            clip_count = frame_count = 0;
+            return 0;
+        }
+    }
+    fclose(file);
+
+    // 把所有帧原样复制进一张图集（不混合，保留透明度）
+    int height = layout_atlas(surfaces);
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, ANIM_ATLAS_WIDTH, height > 0 ? height : 1, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!sheet) {
+        printf("无法创建动画图集: %s\n", SDL_GetError());
+        free_surfaces(surfaces, frame_count);
+        clip_count = frame_count = 0;
+        return 0;
+    }
+    for (int i = 0; i < frame_count; i++) {
+        SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(surfaces[i], NULL, sheet, &frame_rects[i]);
+    }
+    free_surfaces(surfaces, frame_count);
+    atlas = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if (!atlas) {
+        printf("无法创建动画图集纹理: %s\n", SDL_GetError());
+        clip_count = frame_count = 0;
+        return 0;
+    }
+
+    printf("动画加载成功！%d 个片段，%d 帧，图集 %dx%d\n", clip_count, frame_count, ANIM_ATLAS_WIDTH, height);
+    return 1;
+}
+
+void anim_unload() {
+    if (atlas) {
+        SDL_DestroyTexture(atlas);
+        atlas = NULL;
+    }
+    clip_count = 0;
+    frame_count = 0;
+}
+
+int anim_find_clip(const char* name) {
+    for (int i = 0; i < clip_count; i++) {
+        if (strcmp(clips[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+const AnimClip* anim_get_clip(int clip) {
+    return (clip >= 0 && clip < clip_count) ? &clips[clip] : NULL;
+}
+
+void anim_advance(Animator* animators, int count, unsigned int now) {
+    for (int i = 0; i < count; i++) {
+        Animator* animator = &animators[i];
+        const AnimClip* clip = &clips[animator->clip];
+        unsigned int step = now > animator->start ? (now - animator->start) / (unsigned int)clip->frame_ticks : 0;
+        if (clip->loop == ANIM_LOOP) {
+            animator->frame = (int)(step % (unsigned int)clip->frame_count);
+        } else {
+            animator->frame = step < (unsigned int)clip->frame_count ? (int)step : clip->frame_count - 1;
+        }
+    }
+}
+
+int anim_get_frame(const Animator* animator, SDL_Texture** texture, SDL_Rect* source) {
+    if (!atlas || animator->clip < 0 || animator->clip >= clip_count) return 0;
+    *texture = atlas;
+    *source = frame_rects[clips[animator->clip].first_frame + animator->frame];
+    return 1;
+}
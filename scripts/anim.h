@@ -0,0 +1,51 @@
+// anim.h
+// 动画片段表头文件（片段的帧数、每帧时长、播放方式和图集位置由数据文件定义）
+//
+// assets/animations.txt每行定义一个片段：名称、帧数、每帧的逻辑帧数、播放方式（loop循环，
+// once播放一次后停在最后一帧）和图片路径（正好一个%d，为从1开始的帧号，含其他%转换的行被拒绝）。载入精灵时把所有片段的
+// 每一帧拼进一张图集纹理，记录每帧在图集中的位置。修改帧数、速度或换图只需改数据文件。
+//
+// 骑士和敌人只记录当前动画状态和开始的逻辑帧，当前是第几帧由开始后经过的逻辑帧数直接
+// 算出，模拟中不再逐帧推进动画（远处的敌人也就不需要冻结和补帧）。渲染时把本帧要画的
+// 所有动画放进一个紧凑数组，由anim_advance一次算出各自的帧号。
+
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <SDL.h>
+
+#define ANIM_TABLE_PATH "assets/animations.txt"
+#define ANIM_MAX_CLIPS 32          // 片段数上限
+#define ANIM_MAX_FRAMES 128        // 所有片段的总帧数上限
+#define ANIM_ATLAS_WIDTH 256       // 图集宽度（按行依次排放，放不下时换行）
+
+// 播放方式
+typedef enum {
+    ANIM_LOOP,                     // 循环播放
+    ANIM_ONCE                      // 播放一次，停在最后一帧
+} AnimLoopMode;
+
+// 动画片段
+typedef struct {
+    char name[32];
+    int first_frame;               // 第一帧在帧表中的位置
+    int frame_count;               // 帧数
+    int frame_ticks;               // 每帧持续的逻辑帧数
+    AnimLoopMode loop;             // 播放方式
+} AnimClip;
+
+// 一个正在播放的动画（渲染时临时组成数组，frame由anim_advance写入）
+typedef struct {
+    int clip;                      // 片段编号
+    unsigned int start;            // 开始播放的逻辑帧
+    int frame;                     // 当前帧（片段内的序号）
+} Animator;
+
+int anim_load(SDL_Renderer* renderer, const char* path); // 读取片段表并生成图集，成功返回1
+void anim_unload();                                      // 释放图集和片段表
+int anim_find_clip(const char* name);                    // 按名称查找片段（找不到返回-1）
+const AnimClip* anim_get_clip(int clip);                 // 片段信息
+void anim_advance(Animator* animators, int count, unsigned int now); // 按当前逻辑帧算出每个动画的帧号
+int anim_get_frame(const Animator* animator, SDL_Texture** texture, SDL_Rect* source); // 当前帧的图集纹理和源矩形，没有图集时返回0
+
+#endif // ANIM_H
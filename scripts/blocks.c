@@ -3,6 +3,7 @@
 
 #include "blocks.h"
 #include "map.h"
+#include "tilepage.h"
 #include <stdio.h>
 
 // 更新方块状态
@@ -13,6 +14,12 @@ void update_blocks() {
 
 // 获取指定位置的方块类型
 BlockType get_block_type(int map_x, int map_y) {
+    // 分页关卡：格子编码就是方块类型（敌人标记当作空地）
+    int code = tilepage_lookup(map_x, map_y);
+    if (code >= 0) {
+        return code == TILE_CODE_ENEMY ? BLOCK_NONE : (BlockType)code;
+    }
+    
     // 检查地图边界
     if (map_x < 0 || map_x >= MAP_WIDTH || map_y < 0 || map_y >= MAP_HEIGHT) {
         return BLOCK_NONE;
@@ -48,11 +55,8 @@ BlockType get_block_type(int map_x, int map_y) {
 
 // 二连跳奖励方块消失机制
 int collect_double_jump_block(int map_x, int map_y) {
-    if (map_x < 0 || map_x >= MAP_WIDTH || map_y < 0 || map_y >= MAP_HEIGHT) {
-        return 0;
-    }
-    if (game_map[map_y][map_x] == 'F') {
-        game_map[map_y][map_x] = ' '; // 方块消失
+    if (get_block_type(map_x, map_y) == BLOCK_DOUBLE_JUMP) {
+        map_set_tile(map_x, map_y, ' '); // 方块消失
         return 1;
     }
     return 0;
@@ -60,11 +64,8 @@ int collect_double_jump_block(int map_x, int map_y) {
 
 // 冲刺奖励方块消失机制
 int collect_dash_block(int map_x, int map_y) {
-    if (map_x < 0 || map_x >= MAP_WIDTH || map_y < 0 || map_y >= MAP_HEIGHT) {
-        return 0;
-    }
-    if (game_map[map_y][map_x] == 'D') {
-        game_map[map_y][map_x] = ' ';
+    if (get_block_type(map_x, map_y) == BLOCK_DASH) {
+        map_set_tile(map_x, map_y, ' ');
         return 1;
     }
     return 0;
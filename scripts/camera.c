@@ -6,7 +6,7 @@
 #include <math.h>
 
 // 全局摄像机对象
-Camera camera;
+WORLD_LOCAL Camera camera;
 
 // 摄像机参数
 #define TILE_SIZE 32
@@ -21,7 +21,7 @@ Camera camera;
 #define CAMERA_PREDICTION_FRAMES 8  // 预测8帧后的位置
 #define CAMERA_MAX_PREDICTION_DISTANCE 80.0f // 最大预测距离
 
-float camera_offset_x = 0.0f;
+WORLD_LOCAL float camera_offset_x = 0.0f;
 
 // 初始化摄像机
 void init_camera(int screen_width, int screen_height) {
@@ -38,6 +38,18 @@ void init_camera(int screen_width, int screen_height) {
     camera.velocity_y = 0.0f;
 }
 
+// 摄像机回到初始位置（保留屏幕尺寸），每局开始时调用
+void reset_camera() {
+    init_camera(camera.screen_width, camera.screen_height);
+    camera_offset_x = 0.0f;
+}
+
+// 摄像机整体平移（无限模式滚动地图时调用，平移后画面不变）
+void camera_shift_x(float dx) {
+    camera.x += dx;
+    camera.target_x += dx;
+}
+
 // 优化的摄像机更新函数（考虑角色状态）
 void update_camera_with_state(float target_x, float target_y, float target_vx, int is_dashing, int facing_right) {
     // 根据冲刺状态选择参数
@@ -106,7 +118,7 @@ void update_camera_with_state(float target_x, float target_y, float target_vx, i
     }
     
     // 限制摄像机边界（不能超出地图范围）
-    float max_camera_x = (MAP_WIDTH * TILE_SIZE) - camera.screen_width;
+    float max_camera_x = (map_get_width() * TILE_SIZE) - camera.screen_width;
     if (camera.x < 0) camera.x = 0;
     if (camera.x > max_camera_x) camera.x = max_camera_x;
     
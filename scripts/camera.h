@@ -4,6 +4,12 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
+#include "world_local.h"
+
+// 逻辑分辨率（与render.c的视野一致：20x11格，每格16像素）
+#define CAMERA_LOGICAL_WIDTH 320
+#define CAMERA_LOGICAL_HEIGHT 176
+
 // 摄像机结构体
 typedef struct {
     float x, y;              // 摄像机在世界中的位置
@@ -19,13 +25,15 @@ typedef struct {
 } Camera;
 
 // 全局摄像机对象
-extern Camera camera;
+extern WORLD_LOCAL Camera camera;
 
 // 全局摄像机额外偏移变量
-extern float camera_offset_x;
+extern WORLD_LOCAL float camera_offset_x;
 
 // 摄像机相关函数接口
 void init_camera(int screen_width, int screen_height);  // 初始化摄像机
+void reset_camera();                                    // 摄像机回到初始位置（保留屏幕尺寸）
+void camera_shift_x(float dx);                          // 摄像机整体平移（无限模式滚动地图时调用）
 
 // 优化的更新函数：接受角色状态参数
 void update_camera_with_state(float target_x, float target_y, float target_vx, int is_dashing, int facing_right);
@@ -0,0 +1,148 @@
+// coop.c
+// 双人合作模式实现
+//
+// 骑士、输入等模块都围绕全局骑士knight编写。合作模式不改动这些模块，
+// 而是在逻辑帧内按玩家编号依次把每名玩家换入全局骑士和按键状态，执行单人逻辑后再换出。
+// 两端按相同顺序、相同输入更新，结果完全一致（回滚网络同步依赖这一点）。
+// 逻辑帧之间，全局骑士始终是本地玩家，渲染、摄像机和界面都不需要区分模式。
+
+#include "coop.h"
+#include "snapshot.h"
+#include "game.h"
+#include "input.h"
+#include "enemy.h"
+#include "camera.h"
+#include "events.h"
+#include "hash.h"
+#include "statehash.h"
+#include <string.h>
+
+static CoopPlayer players[COOP_PLAYER_COUNT];
+static int active = 0;
+static int local_player = 0;
+
+// 编译期检查：合作模式快照不超过COOP_SNAPSHOT_MAX_SIZE
+typedef char coop_size_check[(SNAPSHOT_MAX_SIZE + sizeof(players) <= COOP_SNAPSHOT_MAX_SIZE) ? 1 : -1];
+
+// 把玩家p换入全局骑士
+static void load_player(int p) {
+    knight = players[p].knight;
+    knight_set_progress(&players[p].progress);
+    set_previous_input_mask(players[p].previous_input);
+}
+
+// 把全局骑士保存回玩家p
+static void store_player(int p) {
+    players[p].knight = knight;
+    knight_get_progress(&players[p].progress);
+    players[p].previous_input = get_previous_input_mask();
+}
+
+// 开始合作模式
+void coop_begin(int local) {
+    local_player = (local >= 0 && local < COOP_PLAYER_COUNT) ? local : 0;
+    memset(players, 0, sizeof(players));
+    for (int p = 0; p < COOP_PLAYER_COUNT; p++) {
+        store_player(p);
+    }
+    active = 1;
+}
+
+// 结束合作模式
+void coop_end() {
+    active = 0;
+}
+
+// 是否处于合作模式
+int coop_is_active() {
+    return active;
+}
+
+// 本地玩家编号
+int coop_local_player() {
+    return local_player;
+}
+
+// 执行一个双人逻辑帧（与update_game相同的顺序：骑士、敌人、碰撞）
+void coop_tick(const unsigned int masks[COOP_PLAYER_COUNT]) {
+    unsigned int live_mask = get_input_mask();
+    float local_camera_offset = camera_offset_x;
+    store_player(local_player);
+
+    for (int p = 0; p < COOP_PLAYER_COUNT; p++) {
+        load_player(p);
+        set_input_mask(masks[p]);
+        process_input();
+        update_knight();
+        if (p == local_player) {
+            local_camera_offset = camera_offset_x; // 摄像机只跟随本地玩家的镜头偏移
+        }
+        store_player(p);
+    }
+
+    update_enemies();
+
+    int lives_left = 0;
+    for (int p = 0; p < COOP_PLAYER_COUNT; p++) {
+        load_player(p);
+        set_input_mask(masks[p]);
+        if (check_knight_enemy_collision()) {
+            knight_take_damage();
+            if (p == local_player) {
+                events_push(GAME_EVENT_ENEMY_HIT, p, knight.x, knight.y);
+            }
+        }
+        lives_left += knight_get_lives() > 0;
+        update_input_frame();
+        store_player(p);
+    }
+
+    // 换回本地玩家，键盘状态恢复为真实按键
+    load_player(local_player);
+    camera_offset_x = local_camera_offset;
+    set_input_mask(live_mask);
+
+    // 所有玩家都耗尽生命才结束
+    if (lives_left == 0) {
+        events_push(GAME_EVENT_GAME_OVER, 0, knight.x, knight.y);
+    }
+
+    update_camera_with_state(knight.x, knight.y, knight.vx, knight.is_dashing, knight.facing_right);
+    game_finish_tick();
+}
+
+// 保存合作模式完整状态：单人快照之后紧跟所有玩家的状态
+size_t coop_save(void* buffer, size_t capacity) {
+    store_player(local_player);
+    if (capacity < sizeof(players)) return 0;
+    size_t size = snapshot_save(buffer, capacity - sizeof(players));
+    if (size == 0) return 0;
+    memcpy((unsigned char*)buffer + size, players, sizeof(players));
+    return size + sizeof(players);
+}
+
+// 恢复合作模式完整状态
+int coop_load(const void* buffer, size_t size) {
+    if (size < sizeof(players)) return 0;
+    size_t base = size - sizeof(players);
+    if (!snapshot_load(buffer, base)) return 0;
+    memcpy(players, (const unsigned char*)buffer + base, sizeof(players));
+    return 1;
+}
+
+// 双方共享部分的状态哈希：所有玩家、敌人、地图（摄像机只跟随本地玩家，两端本来就不同）
+uint64_t coop_state_hash() {
+    WorldHash world;
+    store_player(local_player);
+    compute_world_hash(&world);
+    uint64_t parts[2] = { world.enemies, world.map };
+    return hash64(parts, sizeof(parts), hash64(players, sizeof(players), 0));
+}
+
+// 交换全局骑士与另一名玩家（仅交换骑士本身，用于渲染）
+void coop_swap_partner() {
+    int partner = (local_player + 1) % COOP_PLAYER_COUNT;
+    Knight temp = knight;
+    knight = players[partner].knight;
+    players[partner].knight = temp;
+}
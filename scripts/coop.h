@@ -0,0 +1,40 @@
+// coop.h
+// 双人合作模式头文件（同一关卡中的两名骑士）
+
+#ifndef COOP_H
+#define COOP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "knight.h"
+#include "snapshot.h"
+
+#define COOP_PLAYER_COUNT 2
+
+// 合作模式快照 = 单人快照 + 所有玩家的状态
+#define COOP_SNAPSHOT_MAX_SIZE (SNAPSHOT_MAX_SIZE + 512)
+
+// 每名玩家的独立状态。骑士模块只认识全局骑士knight，
+// 逻辑帧内依次把每名玩家换入全局骑士执行更新，再换出保存。
+typedef struct {
+    Knight knight;
+    KnightProgress progress;
+    unsigned int previous_input;  // 该玩家上一帧的按键（"刚按下"判断依据）
+} CoopPlayer;
+
+void coop_begin(int local_player);  // 开始合作模式（在reset_game之后调用，所有玩家从出生点出发）
+void coop_end();                    // 结束合作模式
+int coop_is_active();               // 是否处于合作模式
+int coop_local_player();            // 本地玩家编号
+
+// 执行一个双人逻辑帧（代替game_tick），masks为每名玩家这一帧的按键
+void coop_tick(const unsigned int masks[COOP_PLAYER_COUNT]);
+
+size_t coop_save(void* buffer, size_t capacity); // 保存合作模式完整状态，返回写入字节数
+int coop_load(const void* buffer, size_t size);  // 恢复合作模式完整状态，成功返回1
+uint64_t coop_state_hash();                      // 双方共享部分的状态哈希（不含只属于本地的摄像机）
+
+// 交换全局骑士与另一名玩家（渲染另一名玩家时使用，调用两次即复原）
+void coop_swap_partner();
+
+#endif // COOP_H
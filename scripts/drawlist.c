@@ -0,0 +1,222 @@
+// drawlist.c
+// 绘制命令队列实现
+
+#include "drawlist.h"
+#include <stdio.h>
+#include <string.h>
+
+static DrawCommand commands[DRAW_QUEUE_SIZE];
+static int command_count = 0;
+static int view_w = 0, view_h = 0;
+
+// 纹理编号表（第一次出现时分配，编号从1开始）
+static SDL_Texture* textures[DRAW_MAX_TEXTURES];
+static int texture_count = 0;
+
+static DrawStats stats;
+
+// 一批命令的顶点（每条命令一个四边形）和公用的索引（第k个四边形是4k起的两个三角形）
+static SDL_Vertex vertices[DRAW_QUEUE_SIZE * 4];
+static int indices[DRAW_QUEUE_SIZE * 6];
+static int indices_ready = 0;
+
+// 纹理的编号（编号表满了之后都用最后一个编号，只影响排序，不影响正确性）
+static uint32_t texture_id(SDL_Texture* texture) {
+    if (!texture) return 0;
+    for (int i = 0; i < texture_count; i++) {
+        if (textures[i] == texture) return (uint32_t)(i + 1);
+    }
+    if (texture_count == DRAW_MAX_TEXTURES) return DRAW_MAX_TEXTURES;
+    textures[texture_count++] = texture;
+    return (uint32_t)texture_count;
+}
+
+void drawlist_begin(int view_width, int view_height) {
+    command_count = 0;
+    view_w = view_width;
+    view_h = view_height;
+}
+
+int drawlist_visible(const SDL_Rect* dest) {
+    if (dest->x >= view_w || dest->y >= view_h || dest->x + dest->w <= 0 || dest->y + dest->h <= 0) {
+        stats.culled++;
+        return 0;
+    }
+    return 1;
+}
+
+// 视野剔除后取一条空命令并填好排序键，不需要画时返回NULL
+static DrawCommand* push(DrawLayer layer, int depth, SDL_Texture* texture, const SDL_Rect* dest) {
+    if (!drawlist_visible(dest)) return NULL;
+    if (command_count == DRAW_QUEUE_SIZE) {
+        stats.overflow++;
+        return NULL;
+    }
+    DrawCommand* command = &commands[command_count++];
+    command->key = ((uint32_t)layer << 24) | ((uint32_t)(depth & 0xFF) << 16) | (texture_id(texture) << 8);
+    command->texture = texture;
+    command->dest = *dest;
+    return command;
+}
+
+void drawlist_texture(DrawLayer layer, int depth, SDL_Texture* texture, const SDL_Rect* source,
+                      const SDL_Rect* dest, int flip_horizontal) {
+    if (!texture) return;
+    DrawCommand* command = push(layer, depth, texture, dest);
+    if (!command) return;
+    if (source) {
+        command->source = *source;
+    } else {
+        command->source.w = 0;
+    }
+    command->flip_horizontal = flip_horizontal;
+}
+
+void drawlist_rect(DrawLayer layer, int depth, SDL_Color color, const SDL_Rect* dest) {
+    DrawCommand* command = push(layer, depth, NULL, dest);
+    if (!command) return;
+    command->color = color;
+}
+
+// 按排序键的高三个字节做基数排序（低位在前，每一趟都是稳定的计数排序），
+// 结果是命令下标的顺序；所有命令在某个字节上都相同时跳过这一趟
+static const uint16_t* sort_commands() {
+    static uint16_t order[DRAW_QUEUE_SIZE], scratch[DRAW_QUEUE_SIZE];
+    uint16_t* from = order;
+    uint16_t* to = scratch;
+    for (int i = 0; i < command_count; i++) order[i] = (uint16_t)i;
+
+    for (int shift = 8; shift < 32; shift += 8) {
+        int counts[256];
+        memset(counts, 0, sizeof(counts));
+        for (int i = 0; i < command_count; i++) counts[(commands[i].key >> shift) & 0xFF]++;
+        if (counts[(commands[0].key >> shift) & 0xFF] == command_count) continue;
+
+        int offset = 0;
+        for (int b = 0; b < 256; b++) {
+            int count = counts[b];
+            counts[b] = offset;
+            offset += count;
+        }
+        for (int i = 0; i < command_count; i++) {
+            uint16_t index = from[i];
+            to[counts[(commands[index].key >> shift) & 0xFF]++] = index;
+        }
+        uint16_t* swap = from;
+        from = to;
+        to = swap;
+    }
+    return from;
+}
+
+// 两条相邻命令是否属于同一批（同一纹理，或同一颜色的纯色矩形）
+static int same_run(const DrawCommand* a, const DrawCommand* b) {
+    if (a->texture != b->texture) return 0;
+    if (a->texture) return 1;
+    return a->color.r == b->color.r && a->color.g == b->color.g &&
+           a->color.b == b->color.b && a->color.a == b->color.a;
+}
+
+// 逐条复制一批命令（渲染器不支持SDL_RenderGeometry时使用）
+static void submit_copies(SDL_Renderer* renderer, const uint16_t* order, int first, int count) {
+    for (int i = first; i < first + count; i++) {
+        const DrawCommand* command = &commands[order[i]];
+        if (command->texture) {
+            const SDL_Rect* source = command->source.w > 0 ? &command->source : NULL;
+            if (command->flip_horizontal) {
+                SDL_RenderCopyEx(renderer, command->texture, source, &command->dest, 0.0, NULL, SDL_FLIP_HORIZONTAL);
+            } else {
+                SDL_RenderCopy(renderer, command->texture, source, &command->dest);
+            }
+        } else {
+            SDL_RenderFillRect(renderer, &command->dest);
+        }
+    }
+}
+
+// 把一批命令（同一纹理，或同一颜色的纯色矩形）拼成四边形，用一次SDL_RenderGeometry提交
+static void submit_run(SDL_Renderer* renderer, const uint16_t* order, int first, int count) {
+    const DrawCommand* head = &commands[order[first]];
+    SDL_Texture* texture = head->texture;
+    float texture_w = 1.0f, texture_h = 1.0f;
+    if (texture) {
+        int w = 0, h = 0;
+        SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+        texture_w = (float)(w > 0 ? w : 1);
+        texture_h = (float)(h > 0 ? h : 1);
+    }
+    SDL_Color color = texture ? (SDL_Color){255, 255, 255, 255} : head->color;
+
+    for (int i = 0; i < count; i++) {
+        const DrawCommand* command = &commands[order[first + i]];
+        float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+        if (texture && command->source.w > 0) {
+            u0 = command->source.x / texture_w;
+            v0 = command->source.y / texture_h;
+            u1 = (command->source.x + command->source.w) / texture_w;
+            v1 = (command->source.y + command->source.h) / texture_h;
+        }
+        if (command->flip_horizontal) {
+            float swap = u0;
+            u0 = u1;
+            u1 = swap;
+        }
+        float x0 = (float)command->dest.x, y0 = (float)command->dest.y;
+        float x1 = x0 + command->dest.w, y1 = y0 + command->dest.h;
+        SDL_Vertex* quad = &vertices[i * 4];
+        quad[0] = (SDL_Vertex){ { x0, y0 }, color, { u0, v0 } };
+        quad[1] = (SDL_Vertex){ { x1, y0 }, color, { u1, v0 } };
+        quad[2] = (SDL_Vertex){ { x1, y1 }, color, { u1, v1 } };
+        quad[3] = (SDL_Vertex){ { x0, y1 }, color, { u0, v1 } };
+    }
+    if (SDL_RenderGeometry(renderer, texture, vertices, count * 4, indices, count * 6) != 0) {
+        stats.fallback_runs++;
+        submit_copies(renderer, order, first, count);
+    }
+}
+
+void drawlist_submit(SDL_Renderer* renderer) {
+    if (command_count == 0) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+    const uint16_t* order = sort_commands();
+    if (!indices_ready) {
+        static const int quad[6] = { 0, 1, 2, 2, 3, 0 };
+        for (int i = 0; i < DRAW_QUEUE_SIZE * 6; i++) indices[i] = (i / 6) * 4 + quad[i % 6];
+        indices_ready = 1;
+    }
+
+    // 排序后相邻的同一纹理（或同一颜色）的命令为一批，每批一次绘制调用
+    Uint8 old_r, old_g, old_b, old_a;
+    SDL_GetRenderDrawColor(renderer, &old_r, &old_g, &old_b, &old_a);
+    int first = 0;
+    for (int i = 1; i <= command_count; i++) {
+        if (i < command_count && same_run(&commands[order[first]], &commands[order[i]])) continue;
+        const DrawCommand* head = &commands[order[first]];
+        if (!head->texture) {
+            SDL_SetRenderDrawColor(renderer, head->color.r, head->color.g, head->color.b, head->color.a);
+        }
+        submit_run(renderer, order, first, i - first);
+        stats.runs++;
+        first = i;
+    }
+    SDL_SetRenderDrawColor(renderer, old_r, old_g, old_b, old_a);
+
+    stats.frames++;
+    stats.commands += (unsigned int)command_count;
+    stats.total_submit_us += (float)((double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency());
+    command_count = 0;
+}
+
+void drawlist_get_stats(DrawStats* out) {
+    *out = stats;
+}
+
+void drawlist_report() {
+    if (stats.frames == 0) return;
+    printf("绘制队列: %u 帧，平均每帧 %.1f 条命令、%.1f 批，视野外剔除 %u 条，溢出 %u 条；排序和提交平均 %.1f 微秒\n",
+           stats.frames, (float)stats.commands / stats.frames, (float)stats.runs / stats.frames,
+           stats.culled, stats.overflow, stats.total_submit_us / stats.frames);
+    if (stats.fallback_runs > 0) {
+        printf("绘制队列: 渲染器不支持SDL_RenderGeometry，%u 批改为逐条复制\n", stats.fallback_runs);
+    }
+}
@@ -0,0 +1,58 @@
+// drawlist.h
+// 绘制命令队列头文件（按图层、前后顺序和纹理排序后成批提交）
+//
+// render_game不再按实体顺序直接画图，而是把每个方块、敌人和骑士作为一条绘制命令放进
+// 本帧的队列。放入时先与视野矩形比较，完全在视野外的命令直接丢弃（远处的敌人画的时候
+// 没有任何开销）。提交前按排序键做基数排序：图层在最高位，其次是同一图层内的前后顺序，
+// 最后是纹理编号，因此使用同一纹理的命令排在一起，连续使用同一纹理（或同一颜色）的
+// 命令拼成一组四边形，用一次SDL_RenderGeometry提交（渲染器不支持时逐条复制），
+// 纹理切换和绘制调用次数都降到最少。基数排序是稳定的，键相同的命令保持放入顺序。
+// 界面文字和菜单仍然在提交之后直接绘制。
+
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <SDL.h>
+#include <stdint.h>
+
+#define DRAW_QUEUE_SIZE 512        // 每帧的命令数上限（视野内约250个方块加上敌人和骑士）
+#define DRAW_MAX_TEXTURES 255      // 分配了编号的纹理数（编号0表示纯色矩形）
+
+// 图层（从下到上）
+typedef enum {
+    DRAW_LAYER_TILES,              // 地图方块
+    DRAW_LAYER_ENEMIES,            // 敌人
+    DRAW_LAYER_PLAYERS             // 骑士（本地玩家的前后顺序更大，画在最上面）
+} DrawLayer;
+
+// 一条绘制命令
+typedef struct {
+    uint32_t key;                  // 排序键：图层(8位) | 前后顺序(8位) | 纹理编号(8位) | 0
+    SDL_Texture* texture;          // 为NULL时画纯色矩形
+    SDL_Rect source;               // 纹理中的源矩形（w为0时使用整张纹理）
+    SDL_Rect dest;                 // 屏幕上的目标矩形
+    int flip_horizontal;           // 是否水平翻转
+    SDL_Color color;               // 纯色矩形的颜色
+} DrawCommand;
+
+// 统计信息
+typedef struct {
+    unsigned int frames;           // 提交次数
+    unsigned int commands;         // 提交的命令数
+    unsigned int culled;           // 在视野外丢弃的命令数
+    unsigned int runs;             // 批次数（每批切换一次纹理或颜色，一次绘制调用）
+    unsigned int fallback_runs;    // 渲染器不支持SDL_RenderGeometry、逐条复制的批次数
+    unsigned int overflow;         // 队列已满丢弃的命令数
+    float total_submit_us;         // 排序和提交的总耗时（微秒）
+} DrawStats;
+
+void drawlist_begin(int view_width, int view_height); // 开始新的一帧（清空队列，设置视野大小）
+int drawlist_visible(const SDL_Rect* dest);            // 目标矩形是否与视野相交（不相交时计入剔除数）
+void drawlist_texture(DrawLayer layer, int depth, SDL_Texture* texture, const SDL_Rect* source,
+                      const SDL_Rect* dest, int flip_horizontal); // 放入纹理命令（source为NULL时使用整张纹理）
+void drawlist_rect(DrawLayer layer, int depth, SDL_Color color, const SDL_Rect* dest); // 放入纯色矩形命令
+void drawlist_submit(SDL_Renderer* renderer);         // 排序并成批提交本帧的命令
+void drawlist_get_stats(DrawStats* out);              // 读取统计信息
+void drawlist_report();                               // 打印统计信息（没有提交过时不打印）
+
+#endif // DRAWLIST_H
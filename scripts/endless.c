@@ -0,0 +1,290 @@
+// endless.c
+// 无限模式实现（区块生成、后台生成线程、地图窗口滚动）
+
+#include "endless.h"
+#include "knight.h"
+#include "enemy.h"
+#include "spawn.h"
+#include "patrol.h"
+#include "trigger.h"
+#include "camera.h"
+#include "hash.h"
+#include "log.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+// 编译期检查：地图宽度正好是整数个区块
+typedef char endless_width_check[(MAP_WIDTH % ENDLESS_CHUNK_WIDTH == 0) ? 1 : -1];
+
+#define GROUND_ROW 13            // 草地所在行（骑士站在第12行）
+#define SAVE_TOP_ROW 4           // 存档点从二连跳能到的最高行一直延伸到地面，跳过去也会触发
+
+// 缓冲区状态
+enum {
+    BUFFER_IDLE,
+    BUFFER_REQUESTED,            // 等待生成（chunk已设置）
+    BUFFER_GENERATING,           // 后台线程或主线程正在生成
+    BUFFER_READY                 // 生成完毕，等待滚动时取走
+};
+
+typedef struct {
+    SDL_atomic_t state;
+    int chunk;                   // 区块编号（只在IDLE/READY状态下由主线程修改）
+    char tiles[MAP_HEIGHT][ENDLESS_CHUNK_WIDTH];
+} ChunkBuffer;
+
+static ChunkBuffer buffers[ENDLESS_QUEUE_CHUNKS];
+static SDL_Thread* worker = NULL;
+static SDL_sem* work_sem = NULL;
+static SDL_atomic_t quitting;
+static SDL_atomic_t background_count;
+
+static int active = 0;
+static unsigned int endless_seed = 0;
+static int base_chunk = 0;       // 地图窗口最左边区块的编号
+static EndlessStats stats;
+
+// 区块内使用的伪随机数（线性同余，种子由世界种子和区块编号决定）
+static unsigned int next_random(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned int)(*state >> 33);
+}
+
+static int random_range(uint64_t* state, int low, int high) {
+    return low + (int)(next_random(state) % (unsigned int)(high - low + 1));
+}
+
+// 生成一个区块（只读全局种子，可以在任意线程调用）
+// 区块开头和结尾各保留3列平地，区块交界处不会出现过宽的坑
+static void generate_chunk(unsigned int seed, int index, char tiles[MAP_HEIGHT][ENDLESS_CHUNK_WIDTH]) {
+    memset(tiles, ' ', MAP_HEIGHT * ENDLESS_CHUNK_WIDTH);
+    for (int x = 0; x < ENDLESS_CHUNK_WIDTH; x++) {
+        tiles[GROUND_ROW][x] = 'G';
+        tiles[GROUND_ROW + 1][x] = 'M';
+    }
+    if (index == 0) return; // 起点区块是平地
+
+    uint64_t state = hash_mix64(((uint64_t)seed << 32) ^ (uint64_t)(unsigned int)index);
+    int difficulty = index < 10 ? index : 10;
+    int x = 3;
+    int end = ENDLESS_CHUNK_WIDTH - 3;
+    while (x < end) {
+        int kind = random_range(&state, 0, 99);
+        if (kind < 30) {
+            // 坑：底部是陷阱。拿到能力之前的坑不超过3格（不用助跑也能跳过）
+            int max_gap = index < 3 ? 3 : 3 + difficulty / 4;
+            int width = random_range(&state, 2, max_gap);
+            if (width > end - x) width = end - x;
+            for (int i = 0; i < width; i++) {
+                tiles[GROUND_ROW][x + i] = ' ';
+                tiles[GROUND_ROW + 1][x + i] = 'T';
+            }
+            x += width + 2;
+        } else if (kind < 50) {
+            // 台阶：1~3格高（一次跳跃能上4格）
+            int height = random_range(&state, 1, 1 + difficulty / 5);
+            int width = random_range(&state, 2, 4);
+            if (width > end - x) width = end - x;
+            for (int i = 0; i < width; i++) {
+                for (int k = 1; k <= height; k++) tiles[GROUND_ROW - k][x + i] = 'M';
+            }
+            x += width + 2;
+        } else if (kind < 70) {
+            // 敌人：两侧用屏障限制巡逻范围
+            if (x + 8 > end) {
+                x++;
+                continue;
+            }
+            tiles[GROUND_ROW - 1][x] = 'B';
+            tiles[GROUND_ROW - 1][x + 4] = 'E';
+            tiles[GROUND_ROW - 1][x + 7] = 'B';
+            x += 8;
+        } else if (kind < 85) {
+            // 悬空平台
+            int width = random_range(&state, 3, 5);
+            int row = random_range(&state, 8, 10);
+            if (width > end - x) width = end - x;
+            for (int i = 0; i < width; i++) tiles[row][x + i] = 'M';
+            x += width + 1;
+        } else {
+            x += random_range(&state, 2, 4);
+        }
+    }
+
+    // 每个区块开头一列存档点；第1、2个区块分别放二连跳和冲刺
+    for (int y = SAVE_TOP_ROW; y < GROUND_ROW; y++) tiles[y][1] = 'S';
+    if (index == 1) tiles[GROUND_ROW - 1][2] = 'F';
+    if (index == 2) tiles[GROUND_ROW - 1][2] = 'D';
+}
+
+// 后台生成线程：生成所有已请求的区块
+static int worker_main(void* data) {
+    (void)data;
+    for (;;) {
+        SDL_SemWait(work_sem);
+        if (SDL_AtomicGet(&quitting)) break;
+        for (int i = 0; i < ENDLESS_QUEUE_CHUNKS; i++) {
+            ChunkBuffer* buffer = &buffers[i];
+            if (SDL_AtomicCAS(&buffer->state, BUFFER_REQUESTED, BUFFER_GENERATING)) {
+                generate_chunk(endless_seed, buffer->chunk, buffer->tiles);
+                SDL_AtomicSet(&buffer->state, BUFFER_READY);
+                SDL_AtomicAdd(&background_count, 1);
+            }
+        }
+    }
+    return 0;
+}
+
+// 请求后台线程生成一个区块（缓冲区必须处于IDLE或READY状态）
+static void request_chunk(int chunk) {
+    ChunkBuffer* buffer = &buffers[chunk % ENDLESS_QUEUE_CHUNKS];
+    buffer->chunk = chunk;
+    SDL_AtomicSet(&buffer->state, BUFFER_REQUESTED);
+    SDL_SemPost(work_sem);
+}
+
+// 取出一个区块写入地图的column列起，然后让缓冲区去生成更远的区块
+static void take_chunk(int chunk, int column) {
+    ChunkBuffer* buffer = &buffers[chunk % ENDLESS_QUEUE_CHUNKS];
+    for (;;) {
+        int state = SDL_AtomicGet(&buffer->state);
+        if (state == BUFFER_READY) break;
+        if (state == BUFFER_REQUESTED && SDL_AtomicCAS(&buffer->state, BUFFER_REQUESTED, BUFFER_GENERATING)) {
+            // 后台线程还没开始：主线程直接生成（内容相同，只是多花几微秒）
+            generate_chunk(endless_seed, buffer->chunk, buffer->tiles);
+            SDL_AtomicSet(&buffer->state, BUFFER_READY);
+            stats.chunks_fallback++;
+            break;
+        }
+        // 后台线程正在生成这个区块，只需要等几微秒
+    }
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        memcpy(game_map[y] + column, buffer->tiles[y], ENDLESS_CHUNK_WIDTH);
+    }
+    request_chunk(chunk + ENDLESS_QUEUE_CHUNKS);
+}
+
+// 收回所有缓冲区：撤销还没开始的请求，等待正在生成的区块完成
+static void reclaim_buffers() {
+    for (int i = 0; i < ENDLESS_QUEUE_CHUNKS; i++) {
+        for (;;) {
+            int state = SDL_AtomicGet(&buffers[i].state);
+            if (state == BUFFER_GENERATING) continue;
+            if (SDL_AtomicCAS(&buffers[i].state, state, BUFFER_IDLE)) break;
+        }
+    }
+}
+
+// 开启无限模式并启动生成线程
+int endless_begin(unsigned int seed) {
+    endless_seed = seed;
+    SDL_AtomicSet(&quitting, 0);
+    SDL_AtomicSet(&background_count, 0);
+    for (int i = 0; i < ENDLESS_QUEUE_CHUNKS; i++) {
+        SDL_AtomicSet(&buffers[i].state, BUFFER_IDLE);
+    }
+    work_sem = SDL_CreateSemaphore(0);
+    if (!work_sem) {
+        printf("无限模式初始化失败: %s\n", SDL_GetError());
+        return 0;
+    }
+    worker = SDL_CreateThread(worker_main, "endless_gen", NULL);
+    if (!worker) {
+        printf("无法创建区块生成线程: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(work_sem);
+        work_sem = NULL;
+        return 0;
+    }
+    memset(&stats, 0, sizeof(stats));
+    active = 1;
+    printf("无限模式，种子 %u\n", seed);
+    return 1;
+}
+
+// 停止生成线程
+void endless_end() {
+    if (!active) return;
+    SDL_AtomicSet(&quitting, 1);
+    SDL_SemPost(work_sem);
+    SDL_WaitThread(worker, NULL);
+    SDL_DestroySemaphore(work_sem);
+    worker = NULL;
+    work_sem = NULL;
+    active = 0;
+}
+
+int endless_is_active() {
+    return active;
+}
+
+// 生成起始窗口，并让后台线程从窗口之后的区块开始生成
+void endless_reset() {
+    if (!active) return;
+    reclaim_buffers();
+    base_chunk = 0;
+    char tiles[MAP_HEIGHT][ENDLESS_CHUNK_WIDTH];
+    for (int c = 0; c < ENDLESS_WINDOW_CHUNKS; c++) {
+        generate_chunk(endless_seed, c, tiles);
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            memcpy(game_map[y] + c * ENDLESS_CHUNK_WIDTH, tiles[y], ENDLESS_CHUNK_WIDTH);
+        }
+    }
+    for (int i = 0; i < ENDLESS_QUEUE_CHUNKS; i++) {
+        request_chunk(ENDLESS_WINDOW_CHUNKS + i);
+    }
+}
+
+// 地图窗口左移一个区块
+static void scroll_window() {
+    Uint64 start = SDL_GetPerformanceCounter();
+    float dx = -(float)(ENDLESS_CHUNK_WIDTH * TILE_SIZE);
+    map_shift_left(ENDLESS_CHUNK_WIDTH);
+    knight_shift_x(dx);
+    enemy_shift_x(dx);
+    spawn_shift_x(dx);
+    camera_shift_x(dx);
+
+    int column = MAP_WIDTH - ENDLESS_CHUNK_WIDTH;
+    take_chunk(base_chunk + ENDLESS_WINDOW_CHUNKS, column);
+    base_chunk++;
+
+    // 新区块中的敌人标记加入出生点索引（按列扫描，保持索引按x排序），骑士靠近时才创建敌人
+    for (int x = column; x < MAP_WIDTH; x++) {
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            if (game_map[y][x] != 'E') continue;
+            spawn_append(ENEMY_GOOMBA, x * TILE_SIZE, y * TILE_SIZE);
+            game_map[y][x] = ' ';
+        }
+    }
+    patrol_shift_left(ENDLESS_CHUNK_WIDTH); // 巡逻路段索引随窗口平移
+    trigger_shift_left(ENDLESS_CHUNK_WIDTH); // 触发区域随窗口平移，加入新区块的区域
+
+    stats.chunks_scrolled++;
+    float us = (float)((double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency());
+    if (us > stats.max_scroll_us) stats.max_scroll_us = us;
+    LOG_DEBUG("无限模式滚动到区块%d，耗时%.1f微秒", base_chunk, us);
+}
+
+// 骑士跑过第ENDLESS_SCROLL_CHUNK个区块的起点时滚动地图
+void endless_update() {
+    if (!active) return;
+    while (knight.x >= ENDLESS_SCROLL_CHUNK * ENDLESS_CHUNK_WIDTH * TILE_SIZE) {
+        scroll_window();
+    }
+    int distance = base_chunk * ENDLESS_CHUNK_WIDTH + (int)(knight.x / TILE_SIZE);
+    if (distance > stats.distance) stats.distance = distance;
+}
+
+void endless_get_stats(EndlessStats* out) {
+    *out = stats;
+    out->chunks_background = (unsigned int)SDL_AtomicGet(&background_count);
+}
+
+void endless_report() {
+    if (!active) return;
+    EndlessStats s;
+    endless_get_stats(&s);
+    printf("无限模式: 最远 %d 格，滚动 %u 个区块（后台生成 %u 个，主线程补生成 %u 个），单次滚动最长 %.1f 微秒\n",
+           s.distance, s.chunks_scrolled, s.chunks_background, s.chunks_fallback, s.max_scroll_us);
+}
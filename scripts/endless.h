@@ -0,0 +1,40 @@
+// endless.h
+// 无限模式头文件（按区块程序生成地形，后台线程提前生成，地图窗口随骑士滚动）
+//
+// 地图数组game_map作为一个由ENDLESS_WINDOW_CHUNKS个区块组成的窗口。骑士跑过第
+// ENDLESS_SCROLL_CHUNK个区块的起点时，窗口整体左移一个区块：最左边的区块被丢弃，
+// 骑士、存档点、敌人和摄像机同步平移，最右边填入下一个区块。坐标因此始终在
+// 地图范围内，内存和浮点精度都不随跑动距离变化。
+//
+// 后台线程把接下来的区块生成到ENDLESS_QUEUE_CHUNKS个缓冲区组成的环中，滚动时只做
+// 一次复制；缓冲区被取走后立即分配给更远的区块。区块内容只取决于种子和区块编号，
+// 后台线程来不及时主线程直接生成同一个区块，结果相同。
+
+#ifndef ENDLESS_H
+#define ENDLESS_H
+
+#include "map.h"
+
+#define ENDLESS_CHUNK_WIDTH 40                                  // 每个区块的列数
+#define ENDLESS_WINDOW_CHUNKS (MAP_WIDTH / ENDLESS_CHUNK_WIDTH) // 地图窗口中的区块数
+#define ENDLESS_SCROLL_CHUNK 3                                  // 骑士到达这个区块时滚动
+#define ENDLESS_QUEUE_CHUNKS 4                                  // 后台提前生成的区块数
+
+// 无限模式统计信息
+typedef struct {
+    int distance;                 // 运行期间最远到达的列（从起点算起）
+    unsigned int chunks_scrolled; // 滚动进窗口的区块数
+    unsigned int chunks_background; // 后台线程生成的区块数
+    unsigned int chunks_fallback; // 后台来不及、由主线程生成的区块数
+    float max_scroll_us;          // 单次滚动的最长耗时（微秒）
+} EndlessStats;
+
+int endless_begin(unsigned int seed); // 开启无限模式并启动生成线程，成功返回1
+void endless_end();                   // 停止生成线程
+int endless_is_active();              // 是否处于无限模式
+void endless_reset();                 // 生成起始窗口（reset_game在重置地图后调用）
+void endless_update();                // 骑士跑得足够远时滚动地图（每个逻辑帧调用）
+void endless_get_stats(EndlessStats* stats); // 获取统计信息
+void endless_report();                // 打印统计信息
+
+#endif // ENDLESS_H
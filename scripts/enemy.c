@@ -3,15 +3,19 @@
 
 #include "enemy.h"
 #include "map.h"
+#include "spawn.h"
+#include "patrol.h"
 #include "knight.h"
-#include "sound.h"
+#include "events.h"
+#include "log.h"
+#include "telemetry.h"
 #include <stdio.h>
 #include <math.h>
 #include "blocks.h" // 确保包含blocks.h
 
 // 全局敌人数组
-Enemy enemies[MAX_ENEMIES];
-int enemy_count = 0;
+WORLD_LOCAL Enemy enemies[MAX_ENEMIES];
+WORLD_LOCAL int enemy_count = 0;
 
 // 敌人物理常量
 #define TILE_SIZE 16
@@ -21,32 +25,19 @@ int enemy_count = 0;
 #define GOOMBA_SPEED 1.0f
 #define GOOMBA_WIDTH 16
 #define GOOMBA_HEIGHT 16
-#define DEATH_ANIMATION_TIME 1.0f  // 死亡动画持续时间（秒）
+#define DEATH_ANIMATION_TICKS TIMER_TICKS(1.0f) // 死亡动画持续时间（1秒）
 
 // 初始化敌人系统
 void init_enemies() {
-    enemy_count = 0;
-    
-    // 从地图中读取敌人位置
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            if (game_map[y][x] == 'E') {
-                // 在地图位置创建栗子小子敌人
-                add_enemy(ENEMY_GOOMBA, x * TILE_SIZE, y * TILE_SIZE);
-                
-                // 将地图中的敌人标记替换为空地，避免渲染时显示
-                game_map[y][x] = ' ';
-            }
-        }
-    }
-    
-    printf("敌人系统初始化完成，从地图中创建了%d个敌人\n", enemy_count);
+    patrol_build_index();
+    spawn_build_index();
+    LOG_INFO("敌人系统初始化完成，地图中有%d个敌人出生点", spawn_get_count());
 }
 
 // 添加敌人
 void add_enemy(EnemyType type, float x, float y) {
     if (enemy_count >= MAX_ENEMIES) {
-        printf("警告：敌人数量已达到最大值！\n");
+        LOG_WARN("敌人数量已达到最大值！");
         return;
     }
     
@@ -59,7 +50,7 @@ void add_enemy(EnemyType type, float x, float y) {
     enemy->state = ENEMY_STATE_ALIVE;
     enemy->alive = 1;
     enemy->direction = -1;  // 默认向左移动
-    enemy->death_timer = 0;
+    timer_stop(&enemy->death_timer);
     enemy->on_ground = 0;
     
     // 根据敌人类型设置属性
@@ -77,10 +68,14 @@ void add_enemy(EnemyType type, float x, float y) {
     
     // 初始化动画状态
     enemy->anim_state = ENEMY_ANIM_IDLE;
-    enemy->anim_timer = 0.0f;
-    enemy->anim_frame = 0;
+    enemy->anim_start = timer_now();
     enemy->is_taking_damage = 0;
-    enemy->hit_timer = 0.0f;
+    timer_stop(&enemy->hit_timer);
+    enemy->spawn_id = -1;
+    enemy->patrol_state = 0;
+    enemy->patrol_left = x;
+    enemy->patrol_right = x;
+    enemy->patrol_y = y;
     
     enemy_count++;
 }
@@ -92,10 +87,15 @@ int check_enemy_collision(Enemy* enemy, float new_x, float new_y) {
     int grid_y = (int)(new_y / TILE_SIZE);
     
     // 边界检查
-    if (grid_x < 0 || grid_x >= MAP_WIDTH || grid_y < 0 || grid_y >= MAP_HEIGHT) {
+    if (grid_x < 0 || grid_x >= map_get_width() || grid_y < 0 || grid_y >= MAP_HEIGHT) {
         return 1; // 碰撞
     }
     
+    // 高于这一列最上面的实心格子时不用查地图（没有路段索引时surface为-1）
+    int surface = patrol_surface_row(grid_x);
+    if (grid_y < surface) return 0;
+    if (grid_y == surface) return 1;
+    
     // 使用block_type判断所有地面类型
     BlockType block_type = get_block_type(grid_x, grid_y);
     if (block_type == BLOCK_NORMAL ||  
@@ -199,9 +199,8 @@ void update_enemy_ai(Enemy* enemy) {
         case ENEMY_STATE_STOMPED:
             // 被踩死状态：停止移动，播放死亡动画
             enemy->vx = 0;
-            enemy->death_timer += 1.0f / 60.0f; // 假设60FPS
             
-            if (enemy->death_timer >= DEATH_ANIMATION_TIME) {
+            if (timer_expired(&enemy->death_timer)) {
                 enemy->state = ENEMY_STATE_DEAD;
                 enemy->alive = 0;
             }
@@ -215,13 +214,9 @@ void update_enemy_ai(Enemy* enemy) {
 
 // 更新敌人动画
 void update_enemy_animation(Enemy* enemy) {
-    // 更新受击状态计时器
-    if (enemy->hit_timer > 0) {
-        enemy->hit_timer -= 1.0f / 60.0f; // 假设60FPS
-        if (enemy->hit_timer <= 0) {
-            enemy->hit_timer = 0.0f;
-            enemy->is_taking_damage = 0;
-        }
+    // 受击状态到期
+    if (timer_expired(&enemy->hit_timer)) {
+        enemy->is_taking_damage = 0;
     }
     
     // 更新动画状态
@@ -232,43 +227,55 @@ void update_enemy_animation(Enemy* enemy) {
         new_anim_state = ENEMY_ANIM_IDLE;  // 默认动画
     }
     
-    // 如果动画状态改变，重置动画
+    // 如果动画状态改变，从当前帧重新开始播放
     if (new_anim_state != enemy->anim_state) {
         enemy->anim_state = new_anim_state;
-        enemy->anim_timer = 0.0f;
-        enemy->anim_frame = 0;
+        enemy->anim_start = timer_now();
     }
-    
-    // 更新动画帧
-    const float ANIM_SPEED = 0.15f; // 敌人动画播放速度（每帧0.15秒，比角色慢一点）
-    enemy->anim_timer += 1.0f / 60.0f; // 假设60FPS
-    
-    if (enemy->anim_timer >= ANIM_SPEED) {
-        enemy->anim_timer = 0.0f;
-        
-        // 获取当前动画的最大帧数
-        int max_frames = 4; // 所有敌人动画都是4帧
-        
-        // 对于受击动画，只播放一次
-        if (enemy->anim_state == ENEMY_ANIM_HIT) {
-            enemy->anim_frame++;
-            if (enemy->anim_frame >= max_frames) {
-                enemy->anim_frame = max_frames - 1; // 停留在最后一帧
-            }
-        } else {
-            enemy->anim_frame = (enemy->anim_frame + 1) % max_frames; // 循环播放
-        }
+}
+
+// 巡逻端点是否可用：落地后从路段索引中查一次；换了高度（掉到别的平台）时重新查找
+static int patrol_ready(Enemy* enemy) {
+    if (enemy->state != ENEMY_STATE_ALIVE || enemy->type != ENEMY_GOOMBA) return 0;
+    // 按端点移动时不会离开路段，也不会改变高度；只有路段不规则、照常更新的敌人需要检查高度
+    if (enemy->patrol_state != 0 && enemy->y != enemy->patrol_y) enemy->patrol_state = 0;
+    if (enemy->patrol_state == 0) {
+        if (!enemy->on_ground || enemy->vy != 0) return 0; // 还在下落，下一帧再查
+        enemy->patrol_y = enemy->y;
+        enemy->patrol_state = patrol_find(enemy, &enemy->patrol_left, &enemy->patrol_right) ? 1 : -1;
+    }
+    return enemy->patrol_state > 0;
+}
+
+// 按巡逻端点走一步，结果与update_enemy_ai+update_enemy_physics相同
+static void patrol_step(Enemy* enemy) {
+    enemy->vx = enemy->direction * GOOMBA_SPEED;
+    float new_x = enemy->x + enemy->vx;
+    if (new_x < enemy->patrol_left || new_x > enemy->patrol_right) {
+        enemy->direction *= -1;
+        enemy->vx *= -1;
+    } else {
+        enemy->x = new_x;
     }
 }
 
 // 更新所有敌人
 void update_enemies() {
+    spawn_update(); // 先按摄像机位置激活和回收敌人
+    
     for (int i = 0; i < enemy_count; i++) {
-        if (enemies[i].alive) {
-            update_enemy_ai(&enemies[i]);
-            update_enemy_physics(&enemies[i]);
-            update_enemy_animation(&enemies[i]);
+        Enemy* enemy = &enemies[i];
+        if (!enemy->alive) continue;
+        
+        if (patrol_ready(enemy)) {
+            patrol_step(enemy);
+        } else {
+            // 还在下落、被踩死或者巡逻路线不规则：照常更新
+            update_enemy_ai(enemy);
+            update_enemy_physics(enemy);
         }
+        
+        update_enemy_animation(enemy);
     }
 }
 
@@ -280,16 +287,17 @@ void stomp_enemy(int enemy_index) {
     if (enemy->state == ENEMY_STATE_ALIVE) {
         // 先播放受击动画
         enemy->is_taking_damage = 1;
-        enemy->hit_timer = DEATH_ANIMATION_TIME; // 受击动画持续整个死亡过程
+        timer_start(&enemy->hit_timer, DEATH_ANIMATION_TICKS); // 受击动画持续整个死亡过程
         
         enemy->state = ENEMY_STATE_STOMPED;
-        enemy->death_timer = 0;
+        timer_start(&enemy->death_timer, DEATH_ANIMATION_TICKS);
+        spawn_mark_killed(enemy->spawn_id); // 被踩死的敌人不再从出生点重新出现
         
-        // 播放击杀敌人音效
-        play_sound(SOUND_EXPLOSION);
+        // 击杀音效和日志在逻辑帧结束时统一处理
+        telemetry_event(TELEMETRY_STOMP, enemy->x + enemy->width / 2.0f, enemy->y + enemy->height / 2.0f, enemy_index);
+        events_push(GAME_EVENT_STOMP, enemy_index, enemy->x, enemy->y);
         
         // 可以在这里添加得分逻辑
-        printf("踩死了一个敌人！\n");
     }
 }
 
@@ -300,6 +308,7 @@ void kill_enemy(int enemy_index) {
     Enemy* enemy = &enemies[enemy_index];
     enemy->state = ENEMY_STATE_DEAD;
     enemy->alive = 0;
+    spawn_mark_killed(enemy->spawn_id);
 }
 
 // 检查骑士与敌人的碰撞
@@ -362,6 +371,23 @@ void remove_dead_enemies() {
     enemy_count = write_index;
 }
 
+// 所有敌人整体平移，移出地图左侧的直接移除（无限模式滚动地图时调用）
+void enemy_shift_x(float dx) {
+    int removed = 0;
+    for (int i = 0; i < enemy_count; i++) {
+        enemies[i].x += dx;
+        enemies[i].patrol_state = 0; // 路段索引会按滚动后的窗口重建，重新查找
+        if (enemies[i].x + enemies[i].width <= 0) {
+            enemies[i].alive = 0;
+            enemies[i].state = ENEMY_STATE_DEAD;
+            removed = 1;
+        }
+    }
+    if (removed) {
+        remove_dead_enemies();
+    }
+}
+
 // 获取敌人信息（用于渲染）
 void get_enemy_info(int index, float* x, float* y, int* w, int* h, EnemyState* state) {
     if (index < 0 || index >= enemy_count) return;
@@ -389,10 +415,10 @@ EnemyAnimationState get_enemy_animation_state(int index) {
     return enemies[index].anim_state;
 }
 
-// 获取敌人动画帧
-int get_enemy_animation_frame(int index) {
+// 获取敌人动画开始的逻辑帧
+unsigned int get_enemy_animation_start(int index) {
     if (index < 0 || index >= enemy_count) return 0;
-    return enemies[index].anim_frame;
+    return enemies[index].anim_start;
 }
 
 // 获取敌人面向方向
@@ -5,6 +5,8 @@
 #define ENEMY_H
 
 #include "map.h"
+#include "world_local.h"
+#include "timer.h"
 
 // 敌人类型枚举
 typedef enum {
@@ -35,27 +37,34 @@ typedef struct {
     EnemyState state;        // 敌人状态
     int alive;               // 是否存活（1=存活，0=死亡）
     int direction;           // 移动方向（-1=左，1=右）
-    float death_timer;       // 死亡动画计时器
+    TickTimer death_timer;   // 死亡动画结束的逻辑帧
     int on_ground;           // 是否在地面上
     
     // 动画相关
     EnemyAnimationState anim_state;  // 当前动画状态
-    float anim_timer;                // 动画计时器
-    int anim_frame;                  // 当前动画帧
+    unsigned int anim_start;         // 当前动画开始的逻辑帧
     int is_taking_damage;            // 是否正在受击
-    float hit_timer;                 // 受击状态计时器
+    TickTimer hit_timer;             // 受击状态结束的逻辑帧
+    
+    int spawn_id;                    // 出生点编号（-1表示不是从出生点创建的）
+    
+    // 巡逻（站在规则路段上的地面敌人按巡逻端点移动，见patrol.h）
+    int patrol_state;                // 巡逻端点：0=未查找，1=有效，-1=所在路段不规则（换了高度后重新查找）
+    float patrol_left, patrol_right; // 巡逻端点（在两者之间来回走，走过端点的一步改为转向）
+    float patrol_y;                  // 查找端点时所在的高度
 } Enemy;
 
 // 敌人数组和数量
 #define MAX_ENEMIES 20
-extern Enemy enemies[MAX_ENEMIES];
-extern int enemy_count;
+extern WORLD_LOCAL Enemy enemies[MAX_ENEMIES];
+extern WORLD_LOCAL int enemy_count;
 
 // 函数声明
-void init_enemies();                                    // 初始化敌人系统
+void init_enemies();                                    // 初始化敌人系统（重建出生点索引，敌人在进入摄像机附近时创建）
 void add_enemy(EnemyType type, float x, float y);      // 添加敌人
 void update_enemies();                                  // 更新所有敌人
 void remove_dead_enemies();                             // 移除死亡的敌人
+void enemy_shift_x(float dx);                           // 所有敌人整体平移，移出地图左侧的直接移除（无限模式）
 int check_knight_enemy_collision();                    // 检查骑士与敌人的碰撞
 void stomp_enemy(int enemy_index);                     // 踩死敌人
 void kill_enemy(int enemy_index);                      // 杀死敌人
@@ -64,6 +73,7 @@ void kill_enemy(int enemy_index);                      // 杀死敌人
 void update_enemy_physics(Enemy* enemy);               // 更新敌人物理
 void update_enemy_ai(Enemy* enemy);                    // 更新敌人AI
 int check_enemy_collision(Enemy* enemy, float new_x, float new_y); // 检查敌人碰撞
+int check_enemy_ground_collision(Enemy* enemy, float x, float y);  // 检查敌人脚底是否碰到地面
 
 // 获取敌人信息函数
 void get_enemy_info(int index, float* x, float* y, int* w, int* h, EnemyState* state);
@@ -71,7 +81,7 @@ int get_alive_enemy_count();                           // 获取活着的敌人
 
 // 获取敌人动画信息函数
 EnemyAnimationState get_enemy_animation_state(int index);  // 获取敌人动画状态
-int get_enemy_animation_frame(int index);                  // 获取敌人动画帧
+unsigned int get_enemy_animation_start(int index);         // 获取敌人动画开始的逻辑帧
 int get_enemy_direction(int index);                        // 获取敌人面向方向
 
 #endif // ENEMY_H 
\ No newline at end of file
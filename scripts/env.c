@@ -0,0 +1,278 @@
+// env.c
+// 批量训练环境实现
+//
+// 每个工作线程负责一段连续的环境编号，线程局部的世界中同一时刻只"驻留"一个环境。
+// 切换到另一个环境时先把驻留的环境保存为快照，再恢复目标环境的快照；
+// 每个线程只有一个环境时不需要任何快照操作。
+
+#include "env.h"
+#include "game.h"
+#include "knight.h"
+#include "enemy.h"
+#include "map.h"
+#include "blocks.h"
+#include "input.h"
+#include "ui.h"
+#include "snapshot.h"
+#include "events.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    ENV_JOB_RESET,
+    ENV_JOB_STEP,
+    ENV_JOB_QUIT
+} EnvJob;
+
+// 单个环境不在线程中驻留时的状态
+typedef struct {
+    unsigned char snapshot[SNAPSHOT_MAX_SIZE];
+    size_t snapshot_size;
+    unsigned int episode_ticks;  // 本局已推进的逻辑帧
+    float last_x;                // 上一帧骑士x坐标（计算前进奖励）
+    int last_lives;              // 上一帧生命数
+} EnvSlot;
+
+typedef struct {
+    Env* env;
+    int first, last;     // 负责的环境编号范围 [first, last)
+    int resident;        // 当前驻留在线程局部世界中的环境（-1表示没有）
+    SDL_Thread* thread;
+    SDL_sem* start;
+} EnvWorker;
+
+struct Env {
+    int num_envs;
+    int num_threads;
+    EnvSlot* slots;
+    EnvWorker* workers;
+    SDL_sem* done;
+
+    // 当前任务参数（主线程写入后发信号，工作线程只读）
+    EnvJob job;
+    const unsigned int* actions;
+    float* obs;
+    float* rewards;
+    unsigned char* dones;
+};
+
+// 切换驻留环境：保存当前驻留的环境，need_load时恢复目标环境
+static void activate(EnvWorker* worker, int index, int need_load) {
+    if (worker->resident == index) return;
+    Env* env = worker->env;
+    if (worker->resident >= 0) {
+        EnvSlot* old = &env->slots[worker->resident];
+        old->snapshot_size = snapshot_save(old->snapshot, SNAPSHOT_MAX_SIZE);
+    }
+    if (need_load) {
+        EnvSlot* slot = &env->slots[index];
+        snapshot_load(slot->snapshot, slot->snapshot_size);
+    }
+    worker->resident = index;
+}
+
+// 在驻留的世界中开始新的一局
+static void reset_episode(EnvSlot* slot) {
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    slot->episode_ticks = 0;
+    slot->last_x = knight.x;
+    slot->last_lives = knight.lives;
+}
+
+// 把驻留世界的观测写入out
+static void write_observation(float* out) {
+    float center_x = knight.x + knight.width * 0.5f;
+    float center_y = knight.y + knight.height * 0.5f;
+    int tile_x = (int)(center_x / TILE_SIZE);
+    int tile_y = (int)(center_y / TILE_SIZE);
+
+    // 方块窗口（get_block_type对地图外返回BLOCK_NONE）
+    for (int dy = 0; dy < ENV_VIEW_H; dy++) {
+        for (int dx = 0; dx < ENV_VIEW_W; dx++) {
+            *out++ = (float)get_block_type(tile_x + dx - ENV_VIEW_W / 2, tile_y + dy - ENV_VIEW_H / 2);
+        }
+    }
+
+    *out++ = knight.vx;
+    *out++ = knight.vy;
+    *out++ = (float)knight.on_ground;
+    *out++ = (float)knight.can_double_jump;
+    *out++ = (float)knight.can_dash;
+    *out++ = (float)knight.is_dashing;
+    *out++ = (float)knight.lives;
+    *out++ = (float)knight_is_invulnerable();
+
+    // 最近的存活敌人：插入排序维护前ENV_NEAR_ENEMIES个
+    float near_dx[ENV_NEAR_ENEMIES], near_dy[ENV_NEAR_ENEMIES], near_dist[ENV_NEAR_ENEMIES];
+    int near_count = 0;
+    for (int i = 0; i < enemy_count; i++) {
+        const Enemy* enemy = &enemies[i];
+        if (!enemy->alive || enemy->state != ENEMY_STATE_ALIVE) continue;
+        float dx = (enemy->x + enemy->width * 0.5f - center_x) / TILE_SIZE;
+        float dy = (enemy->y + enemy->height * 0.5f - center_y) / TILE_SIZE;
+        float dist = dx * dx + dy * dy;
+        int pos = near_count < ENV_NEAR_ENEMIES ? near_count++ : ENV_NEAR_ENEMIES;
+        while (pos > 0 && near_dist[pos - 1] > dist) {
+            if (pos < ENV_NEAR_ENEMIES) {
+                near_dx[pos] = near_dx[pos - 1];
+                near_dy[pos] = near_dy[pos - 1];
+                near_dist[pos] = near_dist[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < ENV_NEAR_ENEMIES) {
+            near_dx[pos] = dx;
+            near_dy[pos] = dy;
+            near_dist[pos] = dist;
+        }
+    }
+    for (int i = 0; i < ENV_NEAR_ENEMIES; i++) {
+        int present = i < near_count;
+        *out++ = (float)present;
+        *out++ = present ? near_dx[i] : 0.0f;
+        *out++ = present ? near_dy[i] : 0.0f;
+    }
+}
+
+// 推进驻留世界一个逻辑帧，返回奖励，结束时*done=1
+static float step_episode(EnvSlot* slot, unsigned int action, int* done) {
+    set_input_mask(action);
+    game_tick();
+    slot->episode_ticks++;
+
+    KnightProgress progress;
+    knight_get_progress(&progress);
+
+    float reward = (knight.x - slot->last_x) / TILE_SIZE;
+    if (knight.lives < slot->last_lives) reward -= 1.0f;
+    if (progress.game_won) reward += 10.0f;
+    slot->last_x = knight.x;
+    slot->last_lives = knight.lives;
+
+    *done = get_game_state() != GAME_STATE_PLAYING || slot->episode_ticks >= ENV_MAX_EPISODE_TICKS;
+    return reward;
+}
+
+// 工作线程：等待任务，处理负责范围内的环境
+static int worker_main(void* data) {
+    EnvWorker* worker = (EnvWorker*)data;
+    Env* env = worker->env;
+    events_set_dropping(1); // 工作线程的世界没有界面和声音，只保留游戏状态切换
+
+    for (;;) {
+        SDL_SemWait(worker->start);
+        if (env->job == ENV_JOB_QUIT) break;
+
+        for (int i = worker->first; i < worker->last; i++) {
+            EnvSlot* slot = &env->slots[i];
+            float* obs = env->obs + (size_t)i * ENV_OBS_SIZE;
+            if (env->job == ENV_JOB_RESET) {
+                activate(worker, i, 0);
+                reset_episode(slot);
+            } else {
+                activate(worker, i, 1);
+                int done = 0;
+                env->rewards[i] = step_episode(slot, env->actions[i], &done);
+                env->dones[i] = (unsigned char)done;
+                if (done) {
+                    reset_episode(slot);
+                }
+            }
+            write_observation(obs);
+        }
+        SDL_SemPost(env->done);
+    }
+    return 0;
+}
+
+// 把任务分发给所有工作线程并等待完成
+static void run_job(Env* env, EnvJob job) {
+    env->job = job;
+    for (int t = 0; t < env->num_threads; t++) {
+        SDL_SemPost(env->workers[t].start);
+    }
+    for (int t = 0; t < env->num_threads; t++) {
+        SDL_SemWait(env->done);
+    }
+}
+
+// 创建环境
+Env* env_create(int num_envs, int num_threads) {
+    if (num_envs <= 0) return NULL;
+#ifdef WORLD_THREAD_LOCAL
+    if (num_threads <= 0) num_threads = SDL_GetCPUCount();
+    if (num_threads > num_envs) num_threads = num_envs;
+#else
+    // 世界状态不是线程局部变量时只能有一个工作线程
+    num_threads = 1;
+#endif
+
+    Env* env = (Env*)calloc(1, sizeof(Env));
+    if (!env) return NULL;
+    env->num_envs = num_envs;
+    env->slots = (EnvSlot*)calloc((size_t)num_envs, sizeof(EnvSlot));
+    env->workers = (EnvWorker*)calloc((size_t)num_threads, sizeof(EnvWorker));
+    env->done = SDL_CreateSemaphore(0);
+    if (!env->slots || !env->workers || !env->done) {
+        env_destroy(env);
+        return NULL;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        EnvWorker* worker = &env->workers[t];
+        worker->env = env;
+        worker->first = (int)((long long)num_envs * t / num_threads);
+        worker->last = (int)((long long)num_envs * (t + 1) / num_threads);
+        worker->resident = -1;
+        worker->start = SDL_CreateSemaphore(0);
+        worker->thread = worker->start ? SDL_CreateThread(worker_main, "env_worker", worker) : NULL;
+        if (!worker->thread) {
+            printf("无法创建环境工作线程: %s\n", SDL_GetError());
+            if (worker->start) SDL_DestroySemaphore(worker->start);
+            env_destroy(env);
+            return NULL;
+        }
+        env->num_threads = t + 1;
+    }
+    return env;
+}
+
+// 销毁环境
+void env_destroy(Env* env) {
+    if (!env) return;
+    env->job = ENV_JOB_QUIT;
+    for (int t = 0; t < env->num_threads; t++) {
+        SDL_SemPost(env->workers[t].start);
+    }
+    for (int t = 0; t < env->num_threads; t++) {
+        SDL_WaitThread(env->workers[t].thread, NULL);
+        SDL_DestroySemaphore(env->workers[t].start);
+    }
+    if (env->done) SDL_DestroySemaphore(env->done);
+    free(env->workers);
+    free(env->slots);
+    free(env);
+}
+
+// 环境数量
+int env_num_envs(const Env* env) {
+    return env->num_envs;
+}
+
+// 重置所有环境
+void env_reset(Env* env, float* obs) {
+    env->obs = obs;
+    run_job(env, ENV_JOB_RESET);
+}
+
+// 所有环境推进一个逻辑帧
+void env_step(Env* env, const unsigned int* actions, float* obs, float* rewards, unsigned char* dones) {
+    env->actions = actions;
+    env->obs = obs;
+    env->rewards = rewards;
+    env->dones = dones;
+    run_job(env, ENV_JOB_STEP);
+}
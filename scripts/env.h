@@ -0,0 +1,38 @@
+// env.h
+// 批量训练环境接口（不打开窗口，一次推进多局游戏各一个逻辑帧）
+//
+// 需要以WORLD_THREAD_LOCAL编译（make env_lib），每个工作线程拥有一份独立的世界，
+// 各自负责一段连续的环境编号。观测、奖励和结束标志直接写入调用方提供的连续缓冲区。
+
+#ifndef ENV_H
+#define ENV_H
+
+// 观测布局（每个环境ENV_OBS_SIZE个float）：
+//   [0, ENV_VIEW_W*ENV_VIEW_H)   以骑士所在格为中心的方块窗口，按行存放，值为BlockType（地图外为0）
+//   接下来ENV_KNIGHT_FEATURES个  骑士vx, vy, 是否着地, 是否可二连跳, 是否可冲刺, 是否冲刺中, 生命数, 是否无敌
+//   接下来ENV_NEAR_ENEMIES组     最近的存活敌人（按距离排序）：是否存在, dx, dy（格，相对骑士中心）
+#define ENV_VIEW_W 15
+#define ENV_VIEW_H 11
+#define ENV_KNIGHT_FEATURES 8
+#define ENV_NEAR_ENEMIES 4
+#define ENV_OBS_SIZE (ENV_VIEW_W * ENV_VIEW_H + ENV_KNIGHT_FEATURES + ENV_NEAR_ENEMIES * 3)
+
+// 一局的最大逻辑帧数（超过后视为结束并自动重置）
+#define ENV_MAX_EPISODE_TICKS (60 * 120)
+
+typedef struct Env Env;
+
+// 创建num_envs个环境，num_threads<=0时使用CPU核心数，失败返回NULL
+Env* env_create(int num_envs, int num_threads);
+void env_destroy(Env* env);
+int env_num_envs(const Env* env);
+
+// 重置所有环境，obs至少num_envs*ENV_OBS_SIZE个float
+void env_reset(Env* env, float* obs);
+
+// 每个环境用actions[i]（INPUT_BIT按键位掩码）推进一个逻辑帧（必须先调用过env_reset）。
+// 奖励为骑士向右前进的格数，失去一条命-1，通关+10；
+// 一局结束（生命耗尽、通关或超过最大帧数）时dones[i]=1，并自动重置，obs为新一局的初始观测。
+void env_step(Env* env, const unsigned int* actions, float* obs, float* rewards, unsigned char* dones);
+
+#endif // ENV_H
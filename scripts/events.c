@@ -0,0 +1,194 @@
+// events.c
+// 游戏事件队列实现
+
+#include "events.h"
+#include "ui.h"
+#include "sound.h"
+#include "log.h"
+#include "game.h"
+#include "world_local.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+
+// 本帧的事件队列
+static WORLD_LOCAL GameEvent queue[EVENT_QUEUE_SIZE];
+static WORLD_LOCAL int queue_count = 0;
+
+// 丢弃模式：只保留会切换游戏状态的事件
+static WORLD_LOCAL int dropping = 0;
+
+static WORLD_LOCAL EventStats stats;
+
+// 待确认帧的日志事件（按待确认帧号递增排列，确认后才写日志）
+#define PENDING_LOG_SIZE 64
+static WORLD_LOCAL GameEvent pending_logs[PENDING_LOG_SIZE];
+static WORLD_LOCAL unsigned int pending_ticks[PENDING_LOG_SIZE];
+static WORLD_LOCAL int pending_count = 0;
+
+// 会切换游戏状态的事件（丢弃模式下也必须处理）
+static int changes_game_state(GameEventType type) {
+    return type == GAME_EVENT_GOAL || type == GAME_EVENT_GAME_OVER;
+}
+
+void events_push(GameEventType type, int data, float x, float y) {
+    if (dropping && !changes_game_state(type)) {
+        stats.dropped++;
+        return;
+    }
+    if (queue_count == EVENT_QUEUE_SIZE) events_dispatch();
+    GameEvent* event = &queue[queue_count++];
+    event->type = type;
+    event->data = data;
+    event->x = x;
+    event->y = y;
+    stats.pushed++;
+}
+
+// 本次分发中还没播放过时播放音效
+static void play_once(SoundEffect sound, unsigned int* played) {
+    if (*played & (1u << sound)) {
+        stats.coalesced++;
+        return;
+    }
+    *played |= 1u << sound;
+    play_sound(sound);
+}
+
+// 写事件对应的日志
+static void log_event(const GameEvent* event) {
+    switch (event->type) {
+    case GAME_EVENT_GOAL:
+        LOG_INFO("恭喜通关！你成功到达终点！");
+        break;
+    case GAME_EVENT_SAVE:
+        LOG_INFO("存档点已记录：(%f, %f)", event->x, event->y);
+        break;
+    case GAME_EVENT_TRAP:
+        if (event->data) LOG_INFO("骑士踩到陷阱，扣血并回到存档点！");
+        else LOG_INFO("骑士踩到陷阱，死亡！");
+        break;
+    case GAME_EVENT_DAMAGE:
+        LOG_INFO("骑士受伤！剩余生命：%d", event->data);
+        break;
+    case GAME_EVENT_DEATH:
+        LOG_INFO("骑士死亡！游戏结束！");
+        break;
+    case GAME_EVENT_STOMP:
+        LOG_INFO("踩死了一个敌人！");
+        break;
+    default:
+        break;
+    }
+}
+
+// 写日志，待确认的帧先挂起（满了时最早一帧的日志直接写出）
+static void log_or_defer(const GameEvent* event) {
+    unsigned int pending_tick = game_get_pending_tick();
+    if (pending_tick == GAME_TICK_CONFIRMED) {
+        log_event(event);
+        return;
+    }
+    if (pending_count == PENDING_LOG_SIZE) events_commit_logs(pending_ticks[0] + 1);
+    pending_logs[pending_count] = *event;
+    pending_ticks[pending_count] = pending_tick;
+    pending_count++;
+}
+
+static void dispatch_event(const GameEvent* event, unsigned int* played) {
+    switch (event->type) {
+    case GAME_EVENT_JUMP:
+        play_once(SOUND_JUMP, played);
+        break;
+    case GAME_EVENT_GOAL:
+        set_game_state(GAME_STATE_GAME_OVER);
+        if (dropping) break;
+        play_once(SOUND_COIN, played);
+        log_or_defer(event);
+        break;
+    case GAME_EVENT_SKILL:
+        show_skill_hint(event->data == BLOCK_DASH ? "dash" : "double_jump");
+        play_once(SOUND_POWER_UP, played);
+        break;
+    case GAME_EVENT_SAVE:
+    case GAME_EVENT_TRAP:
+    case GAME_EVENT_DEATH:
+        log_or_defer(event);
+        break;
+    case GAME_EVENT_DAMAGE:
+        log_or_defer(event);
+        play_once(SOUND_HURT, played);
+        break;
+    case GAME_EVENT_STOMP:
+        play_once(SOUND_EXPLOSION, played);
+        log_or_defer(event);
+        break;
+    case GAME_EVENT_ENEMY_HIT:
+        show_damage_indicator();
+        break;
+    case GAME_EVENT_GAME_OVER:
+        set_game_state(GAME_STATE_GAME_OVER);
+        break;
+    default:
+        break;
+    }
+}
+
+void events_dispatch() {
+    if (queue_count == 0) return;
+    Uint64 start = SDL_GetPerformanceCounter();
+    unsigned int played = 0;   // 本次已播放的音效（按SoundEffect编号的位）
+    for (int i = 0; i < queue_count; i++) {
+        dispatch_event(&queue[i], &played);
+    }
+    queue_count = 0;
+    float us = (float)((double)(SDL_GetPerformanceCounter() - start) * 1000000.0 / (double)SDL_GetPerformanceFrequency());
+    stats.flushes++;
+    stats.total_dispatch_us += us;
+    if (us > stats.max_dispatch_us) stats.max_dispatch_us = us;
+}
+
+void events_clear() {
+    queue_count = 0;
+}
+
+void events_set_dropping(int value) {
+    dropping = value;
+    if (dropping) {
+        // 已经在队列中的展示类事件也不再需要
+        int write_index = 0;
+        for (int i = 0; i < queue_count; i++) {
+            if (changes_game_state(queue[i].type)) queue[write_index++] = queue[i];
+        }
+        stats.dropped += (unsigned int)(queue_count - write_index);
+        queue_count = write_index;
+    }
+}
+
+void events_discard_logs(unsigned int pending_tick) {
+    while (pending_count > 0 && pending_ticks[pending_count - 1] >= pending_tick) {
+        pending_count--;
+    }
+}
+
+void events_commit_logs(unsigned int pending_tick) {
+    int committed = 0;
+    while (committed < pending_count && pending_ticks[committed] < pending_tick) {
+        log_event(&pending_logs[committed]);
+        committed++;
+    }
+    pending_count -= committed;
+    memmove(pending_logs, pending_logs + committed, sizeof(GameEvent) * pending_count);
+    memmove(pending_ticks, pending_ticks + committed, sizeof(unsigned int) * pending_count);
+}
+
+void events_get_stats(EventStats* out) {
+    *out = stats;
+}
+
+void events_report() {
+    if (stats.flushes == 0) return;
+    printf("游戏事件: 压入 %u 个，合并音效 %u 个，丢弃 %u 个；分发 %u 次，平均 %.2f 微秒，最长 %.1f 微秒\n",
+           stats.pushed, stats.coalesced, stats.dropped, stats.flushes,
+           stats.total_dispatch_us / stats.flushes, stats.max_dispatch_us);
+}
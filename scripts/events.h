@@ -0,0 +1,61 @@
+// events.h
+// 游戏事件队列头文件（逻辑帧内产生的音效、提示、日志和游戏状态切换）
+//
+// 骑士和敌人的更新代码不再直接播放音效、显示提示或写日志，而是把发生的事情作为带类型的
+// 事件压入本帧的队列，由game_finish_tick在逻辑帧结束时统一分发。同一帧内的同一种音效
+// 只播放一次（一帧踩死五个敌人只响一声）。事件在逻辑帧内都不会被读取，分发时机不影响
+// 模拟结果。
+//
+// 无界面的批量模拟（训练环境、求解器的工作线程）可以打开丢弃模式：除了会切换游戏状态的
+// 事件外，其余事件在压入时直接丢弃，不格式化日志也不进入队列。
+// 联机时待确认帧的日志先挂起（见game_set_pending_tick），回滚时丢弃，输入确认后才写出。
+// 分发耗时记录在统计信息中，退出时与其他模块的统计一起打印。
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "blocks.h"
+
+#define EVENT_QUEUE_SIZE 64   // 每帧的队列容量（满了先分发已有的事件）
+
+// 事件类型
+typedef enum {
+    GAME_EVENT_JUMP,          // 骑士起跳（含二段跳）
+    GAME_EVENT_GOAL,          // 到达终点（切换到结束菜单）
+    GAME_EVENT_SKILL,         // 获得技能（附加数据：方块类型）
+    GAME_EVENT_SAVE,          // 记录存档点（位置为存档位置）
+    GAME_EVENT_TRAP,          // 踩到陷阱（附加数据：1=回到存档点，0=死亡）
+    GAME_EVENT_DAMAGE,        // 骑士受伤（附加数据：剩余生命）
+    GAME_EVENT_DEATH,         // 骑士死亡
+    GAME_EVENT_STOMP,         // 踩死敌人（附加数据：敌人下标）
+    GAME_EVENT_ENEMY_HIT,     // 本地玩家被敌人碰到（显示受伤效果）
+    GAME_EVENT_GAME_OVER,     // 生命耗尽（切换到结束菜单）
+    GAME_EVENT_COUNT
+} GameEventType;
+
+typedef struct {
+    GameEventType type;
+    int data;                 // 附加数据
+    float x, y;               // 位置（只有部分事件使用）
+} GameEvent;
+
+// 事件统计信息
+typedef struct {
+    unsigned int pushed;      // 压入队列的事件数
+    unsigned int dropped;     // 丢弃模式下直接丢弃的事件数
+    unsigned int coalesced;   // 与同一帧的相同音效合并、没有重复播放的音效数
+    unsigned int flushes;     // 分发次数（有事件的逻辑帧）
+    float total_dispatch_us;  // 分发总耗时（微秒）
+    float max_dispatch_us;    // 单次分发的最长耗时（微秒）
+} EventStats;
+
+void events_push(GameEventType type, int data, float x, float y); // 压入一个事件
+void events_dispatch();                // 分发并清空本帧的事件（game_finish_tick调用）
+void events_clear();                   // 丢弃未分发的事件（重置游戏时调用）
+void events_set_dropping(int value);   // 打开或关闭丢弃模式（只影响当前线程的世界）
+void events_discard_logs(unsigned int pending_tick); // 丢弃该待确认帧及之后挂起的日志（game_discard_output调用）
+void events_commit_logs(unsigned int pending_tick);  // 写出该待确认帧之前挂起的日志（game_commit_output调用）
+void events_get_stats(EventStats* stats); // 获取统计信息
+void events_report();                  // 打印统计信息
+
+#endif // EVENTS_H
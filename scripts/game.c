@@ -0,0 +1,211 @@
+// game.c
+// 游戏逻辑主流程实现（与SDL主循环分离，便于回放和离线工具复用）
+
+#include "game.h"
+#include "map.h"
+#include "knight.h"
+#include "input.h"
+#include "blocks.h"
+#include "enemy.h"
+#include "ui.h"
+#include "camera.h"
+#include "endless.h"
+#include "tilepage.h"
+#include "spawn.h"
+#include "trigger.h"
+#include "events.h"
+#include "telemetry.h"
+#include <string.h>
+
+// 游戏是否结束的标志
+WORLD_LOCAL bool game_over = false;
+
+// 逻辑帧计数器
+static WORLD_LOCAL unsigned int tick_count = 0;
+
+// 死亡敌人清理计数器（每秒清理一次）
+static WORLD_LOCAL int cleanup_counter = 0;
+
+// 最近一个逻辑帧结束时的世界状态哈希
+static WORLD_LOCAL WorldHash world_hash;
+
+// 是否正在回滚重算已经模拟过的逻辑帧（此时不应再产生音效等外部副作用）
+static WORLD_LOCAL int resimulating = 0;
+
+// 当前模拟的待确认帧号（GAME_TICK_CONFIRMED表示输出不需要挂起）
+static WORLD_LOCAL unsigned int pending_tick = GAME_TICK_CONFIRMED;
+
+// 挂起的哈希日志（按帧号递增排列，联机时最多挂起回滚窗口内的几帧）
+#define PENDING_HASH_SIZE 32
+typedef struct {
+    unsigned int pending_tick;   // 所属的待确认帧
+    unsigned int tick;           // 写入日志的逻辑帧计数
+    WorldHash hash;
+} PendingHash;
+static WORLD_LOCAL PendingHash pending_hashes[PENDING_HASH_SIZE];
+static WORLD_LOCAL int pending_hash_count = 0;
+
+// 更新游戏状态
+void update_game() {
+    update_knight(); // 更新骑士状态
+    update_enemies(); // 更新敌人状态
+    
+    // 检查骑士与敌人的碰撞
+    if (check_knight_enemy_collision()) {
+        // 骑士受伤
+        knight_take_damage();
+        events_push(GAME_EVENT_ENEMY_HIT, 0, knight.x, knight.y); // 显示受伤效果
+    }
+    
+    // 检查游戏结束条件
+    if (knight_get_lives() <= 0) {
+        events_push(GAME_EVENT_GAME_OVER, 0, knight.x, knight.y);
+    }
+    
+    endless_update(); // 无限模式：骑士跑得足够远时滚动地图
+}
+
+// 重置游戏状态
+void reset_game() {
+    events_clear();    // 上一局未分发的事件不再处理
+    tick_count = 0;    // 计时器以逻辑帧计数为时钟，创建骑士和敌人之前先归零
+    cleanup_counter = 0;
+    reset_map();       // 首先重置地图到初始状态
+    if (endless_is_active()) endless_reset(); // 无限模式用生成的区块覆盖地图
+    trigger_build_index(); // 地图就绪后建立触发区域索引
+    init_knight();
+    init_enemies();
+    init_input();      // 清空按键状态，保证每局从相同的输入状态开始
+    reset_camera();
+    spawn_update();    // 摄像机就位后创建初始视野附近的敌人
+    game_over = false;
+    compute_world_hash(&world_hash);
+    reset_menu_selection();
+    reset_ui_effects();
+}
+
+// 执行一个固定时间步长
+void game_tick() {
+    process_input();
+    update_game();
+    
+    // 摄像机也在逻辑帧内更新，使其状态只取决于输入序列（与渲染帧率无关）
+    update_camera_with_state(knight.x, knight.y, knight.vx, knight.is_dashing, knight.facing_right);
+    
+    // 每个逻辑帧结束时推进按键状态，保证"刚按下"只在一个逻辑帧内生效
+    update_input_frame();
+    game_finish_tick();
+}
+
+// 分页关卡：把摄像机视野（左右各留一屏余量）和活动敌人所在的页标记为最近使用，
+// 这些页不会被淘汰，骑士和敌人的碰撞查询总是命中常驻页
+static void keep_level_pages_resident() {
+    int view_columns = camera.screen_width / TILE_SIZE;
+    int first = (int)(camera.x / TILE_SIZE) - view_columns;
+    tilepage_touch(first, first + view_columns * 3);
+    for (int i = 0; i < enemy_count; i++) {
+        if (!enemies[i].alive) continue;
+        int column = (int)(enemies[i].x / TILE_SIZE);
+        tilepage_touch(column - 1, column + 2);
+    }
+}
+
+// 写出第tick帧之前挂起的哈希日志
+static void commit_hashes(unsigned int tick) {
+    int committed = 0;
+    while (committed < pending_hash_count && pending_hashes[committed].pending_tick < tick) {
+        statehash_log_tick(pending_hashes[committed].tick, &pending_hashes[committed].hash);
+        committed++;
+    }
+    pending_hash_count -= committed;
+    memmove(pending_hashes, pending_hashes + committed, sizeof(PendingHash) * pending_hash_count);
+}
+
+// 逻辑帧收尾（单人和合作模式共用）：方块、死亡敌人清理、帧计数和状态哈希
+void game_finish_tick() {
+    update_blocks();  // 更新方块状态
+    if (tilepage_is_open()) keep_level_pages_resident();
+    
+    // 定期清理死亡的敌人（每秒一次）
+    cleanup_counter++;
+    if (cleanup_counter >= 60) { // 每60帧（1秒）清理一次
+        remove_dead_enemies();
+        cleanup_counter = 0;
+    }
+    
+    tick_count++;
+    
+    compute_world_hash(&world_hash);
+    if (pending_tick == GAME_TICK_CONFIRMED) {
+        statehash_log_tick(tick_count, &world_hash);
+    } else {
+        // 待确认的帧先挂起，满了时最早一帧的哈希直接写出
+        if (pending_hash_count == PENDING_HASH_SIZE) commit_hashes(pending_hashes[0].pending_tick + 1);
+        PendingHash* entry = &pending_hashes[pending_hash_count++];
+        entry->pending_tick = pending_tick;
+        entry->tick = tick_count;
+        entry->hash = world_hash;
+    }
+    events_dispatch(); // 本帧的音效、提示、日志和游戏状态切换
+}
+
+// 标记是否处于回滚重算中
+void game_set_resimulating(int value) {
+    resimulating = value;
+}
+
+// 是否处于回滚重算中
+int game_is_resimulating() {
+    return resimulating;
+}
+
+// 设置当前模拟的待确认帧号
+void game_set_pending_tick(unsigned int tick) {
+    pending_tick = tick;
+}
+
+// 当前逻辑帧的待确认帧号
+unsigned int game_get_pending_tick() {
+    return pending_tick;
+}
+
+// 丢弃第tick帧及之后挂起的输出
+void game_discard_output(unsigned int tick) {
+    while (pending_hash_count > 0 && pending_hashes[pending_hash_count - 1].pending_tick >= tick) {
+        pending_hash_count--;
+    }
+    telemetry_discard(tick);
+    events_discard_logs(tick);
+}
+
+// 写出第tick帧之前挂起的输出
+void game_commit_output(unsigned int tick) {
+    commit_hashes(tick);
+    telemetry_commit(tick);
+    events_commit_logs(tick);
+}
+
+// 获取逻辑帧计数
+unsigned int game_get_tick() {
+    return tick_count;
+}
+
+// 获取最近一个逻辑帧结束时的世界状态哈希
+const WorldHash* game_get_world_hash() {
+    return &world_hash;
+}
+
+// 读取逻辑帧计数状态
+void game_get_counters(GameCounters* counters) {
+    counters->tick = tick_count;
+    counters->cleanup_counter = cleanup_counter;
+    counters->game_over = game_over;
+}
+
+// 恢复逻辑帧计数状态（其余世界状态应已恢复，这里重新计算世界状态哈希）
+void game_set_counters(const GameCounters* counters) {
+    tick_count = counters->tick;
+    cleanup_counter = counters->cleanup_counter;
+    game_over = counters->game_over != 0;
+    compute_world_hash(&world_hash);
+}
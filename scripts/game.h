@@ -0,0 +1,44 @@
+// game.h
+// 游戏逻辑主流程头文件（固定步长更新、重置）
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdbool.h>
+#include "statehash.h"
+#include "world_local.h"
+
+// 逻辑帧计数相关状态（快照时整体读写）
+typedef struct {
+    unsigned int tick;        // 逻辑帧计数
+    int cleanup_counter;      // 死亡敌人清理计数器
+    int game_over;            // 游戏是否结束
+} GameCounters;
+
+// 游戏是否结束的标志
+extern WORLD_LOCAL bool game_over;
+
+// 游戏流程接口
+void update_game();              // 更新游戏状态（骑士、敌人、碰撞）
+void reset_game();               // 重置游戏状态（地图、骑士、敌人）
+void game_tick();                // 执行一个固定时间步长（输入处理+逻辑更新）
+void game_finish_tick();         // 逻辑帧收尾（方块、清理、帧计数、状态哈希），game_tick和合作模式共用
+unsigned int game_get_tick();    // 获取自上次重置以来经过的逻辑帧数
+const WorldHash* game_get_world_hash(); // 获取最近一个逻辑帧结束时的世界状态哈希
+void game_get_counters(GameCounters* counters);       // 读取逻辑帧计数状态
+void game_set_counters(const GameCounters* counters); // 恢复逻辑帧计数状态（并重新计算世界状态哈希）
+
+
+// 回滚重算标志：重算已经模拟过的逻辑帧时，音效等即时副作用应跳过
+void game_set_resimulating(int value);
+int game_is_resimulating();
+
+// 待确认帧的输出：联机时用预测按键模拟的帧可能被回滚，这些帧的统计事件、哈希日志和事件日志
+// 先按帧号挂起，回滚时丢弃，双方输入都确认后再按顺序写出
+#define GAME_TICK_CONFIRMED 0xFFFFFFFFu
+void game_set_pending_tick(unsigned int tick); // 设置当前模拟的待确认帧号（不是待确认帧时设为GAME_TICK_CONFIRMED）
+unsigned int game_get_pending_tick();          // 当前逻辑帧的待确认帧号，输出不需要挂起时为GAME_TICK_CONFIRMED
+void game_discard_output(unsigned int tick);   // 丢弃第tick帧及之后挂起的输出（回滚时调用）
+void game_commit_output(unsigned int tick);    // 写出第tick帧之前挂起的输出（这些帧的输入都已确认）
+
+#endif // GAME_H
@@ -0,0 +1,13 @@
+// hash.h
+// 通用哈希函数头文件（64位xxHash，用于状态校验和去重）
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint64_t hash64(const void* data, size_t size, uint64_t seed); // 计算数据块的XXH64哈希
+uint64_t hash_mix64(uint64_t value);                          // 对单个64位整数做雪崩混合
+
+#endif // HASH_H
@@ -6,8 +6,8 @@
 #include "map.h"
 
 // 键盘状态数组
-static int current_keys[INPUT_COUNT];   // 当前帧的按键状态
-static int previous_keys[INPUT_COUNT];  // 上一帧的按键状态
+static WORLD_LOCAL int current_keys[INPUT_COUNT];   // 当前帧的按键状态
+static WORLD_LOCAL int previous_keys[INPUT_COUNT];  // 上一帧的按键状态
 
 // 按键映射表：将SDL键码映射到游戏动作
 static SDL_Keycode key_mapping[INPUT_COUNT] = {
@@ -19,8 +19,6 @@ static SDL_Keycode key_mapping[INPUT_COUNT] = {
     [INPUT_DASH]  = SDLK_d         // D键冲刺
 };
 
-extern Knight knight;
-
 // 初始化输入系统
 void init_input() {
     // 清空所有按键状态
@@ -84,6 +82,38 @@ int is_action_released(InputAction action) {
     return !current_keys[action] && previous_keys[action];
 }
 
+// 获取当前按键状态位掩码
+unsigned int get_input_mask() {
+    unsigned int mask = 0;
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        if (current_keys[i]) mask |= INPUT_BIT(i);
+    }
+    return mask;
+}
+
+// 直接设置当前按键状态（不经过SDL事件）
+void set_input_mask(unsigned int mask) {
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        current_keys[i] = (mask & INPUT_BIT(i)) ? 1 : 0;
+    }
+}
+
+// 获取上一帧按键状态位掩码
+unsigned int get_previous_input_mask() {
+    unsigned int mask = 0;
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        if (previous_keys[i]) mask |= INPUT_BIT(i);
+    }
+    return mask;
+}
+
+// 设置上一帧按键状态
+void set_previous_input_mask(unsigned int mask) {
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        previous_keys[i] = (mask & INPUT_BIT(i)) ? 1 : 0;
+    }
+}
+
 // 清理输入系统
 void cleanup_input() {
     // 当前实现不需要特殊清理
@@ -27,4 +27,11 @@ int is_action_released(InputAction action);    // 查询动作是否刚被释放
 void cleanup_input();                          // 清理输入系统
 void process_input();
 
+// 按键状态位掩码（每个动作占一位，用于录制和回放）
+#define INPUT_BIT(action) (1u << (action))
+unsigned int get_input_mask();                 // 获取当前按键状态位掩码
+void set_input_mask(unsigned int mask);        // 直接设置当前按键状态（回放时使用）
+unsigned int get_previous_input_mask();        // 获取上一帧按键状态位掩码（"刚按下"判断依据）
+void set_previous_input_mask(unsigned int mask); // 设置上一帧按键状态（快照恢复时使用）
+
 #endif // INPUT_H 
\ No newline at end of file
@@ -4,23 +4,31 @@
 #include "knight.h"
 #include "map.h"
 #include "blocks.h"
-#include "ui.h"
-#include "sound.h"
+#include "trigger.h"
+#include "events.h"
+#include "log.h"
+#include "telemetry.h"
 #include <stdio.h>
 #include <math.h>
 #include "camera.h"
+#include "game.h"
 
-// 全局骑士对象
-Knight knight;
+// 各种状态的时长（逻辑帧）
+#define KNIGHT_HIT_TICKS TIMER_TICKS(0.6f)            // 受击动画
+#define KNIGHT_DEATH_TICKS TIMER_TICKS(1.2f)          // 死亡动画
+#define KNIGHT_INVULNERABLE_TICKS TIMER_TICKS(2.0f)   // 受伤后无敌
+#define KNIGHT_DASH_COOLDOWN_TICKS TIMER_TICKS(0.5f)  // 冲刺冷却
 
-extern int game_over;
+// 全局骑士对象
+WORLD_LOCAL Knight knight;
 
 // 存档点坐标
-static float save_x = 2 * TILE_SIZE;
-static float save_y = 6 * TILE_SIZE;
-static int save_set = 0; // 是否已存档（保留用于初始化检查）
-static int on_save_block = 0; // 当前是否在存档点上（用于避免重复触发）
-static int game_won = 0; // 是否已通关（防止重复触发）
+static WORLD_LOCAL float save_x = 2 * TILE_SIZE;
+static WORLD_LOCAL float save_y = 6 * TILE_SIZE;
+static WORLD_LOCAL int save_set = 0; // 是否已存档（保留用于初始化检查）
+static WORLD_LOCAL int on_save_block = 0; // 当前是否在存档点上（用于避免重复触发）
+static WORLD_LOCAL int game_won = 0; // 是否已通关（防止重复触发）
+static WORLD_LOCAL int trigger_region = -1; // 上一帧所在的触发区域
 
 // 初始化骑士
 void init_knight() {
@@ -34,28 +42,51 @@ void init_knight() {
     knight.alive = 1;              // 存活状态
     knight.on_ground = 0;          // 初始不在地面（会下落到地面）
     knight.lives = 3;              // 初始3条生命
-    knight.hurt_timer = 0.0f;      // 初始无受伤状态
+    timer_stop(&knight.hurt_timer); // 初始无受伤状态
     knight.facing_right = 1;       // 初始面向右
     
     // 初始化动画状态
     knight.anim_state = KNIGHT_ANIM_IDLE;
-    knight.anim_timer = 0.0f;
-    knight.anim_frame = 0;
+    knight.anim_start = timer_now();
     
     // 初始化状态
     knight.is_taking_damage = 0;
     knight.is_dying = 0;
-    knight.state_timer = 0.0f;
+    timer_stop(&knight.state_timer);
     knight.can_double_jump = 0;
     knight.double_jump_used = 0;
     knight.can_dash = 0;
     knight.is_dashing = 0;
-    knight.dash_timer = 0.0f;
-    knight.dash_cooldown = 0.0f;
+    timer_stop(&knight.dash_timer);
+    timer_stop(&knight.dash_cooldown);
     
     // 重置游戏标志和存档状态
     game_won = 0;
+    save_x = knight.x; // 存档点回到出生点，避免重新开始后沿用上一局的存档
+    save_y = knight.y;
+    save_set = 0;
     on_save_block = 0; // 重置存档点状态
+    trigger_region = -1;
+}
+
+// 读取关卡进度
+void knight_get_progress(KnightProgress* progress) {
+    progress->save_x = save_x;
+    progress->save_y = save_y;
+    progress->save_set = save_set;
+    progress->on_save_block = on_save_block;
+    progress->game_won = game_won;
+    progress->trigger_region = trigger_region;
+}
+
+// 恢复关卡进度
+void knight_set_progress(const KnightProgress* progress) {
+    save_x = progress->save_x;
+    save_y = progress->save_y;
+    save_set = progress->save_set;
+    on_save_block = progress->on_save_block;
+    game_won = progress->game_won;
+    trigger_region = progress->trigger_region;
 }
 
 // 检查指定位置是否有碰撞（撞墙或超出边界）
@@ -65,7 +96,7 @@ int check_collision(float x, float y) {
     int grid_y = (int)(y / TILE_SIZE);
     
     // 边界检查
-    if (grid_x < 0 || grid_x >= MAP_WIDTH || grid_y < 0 || grid_y >= MAP_HEIGHT) {
+    if (grid_x < 0 || grid_x >= map_get_width() || grid_y < 0 || grid_y >= MAP_HEIGHT) {
         return 1; // 碰撞
     }
     
@@ -137,30 +168,26 @@ void update_knight() {
     if (!knight.alive) return;
     if (game_over) return;
     
-    // 更新受伤无敌时间
-    if (knight.hurt_timer > 0) {
-        knight.hurt_timer -= 1.0f / 60.0f; // 假设60FPS
-        if (knight.hurt_timer < 0) knight.hurt_timer = 0;
-    }
-    
     // 更新面向方向
     if (knight.vx > 0.1f) knight.facing_right = 1;
     else if (knight.vx < -0.1f) knight.facing_right = 0;
     
-    // 更新状态计时器
-    if (knight.state_timer > 0) {
-        knight.state_timer -= 1.0f / 60.0f; // 假设60FPS
-        if (knight.state_timer <= 0) {
-            knight.state_timer = 0.0f;
-            // 状态结束，重置状态标志
-            if (knight.is_taking_damage) {
-                knight.is_taking_damage = 0;
-            }
-            if (knight.is_dying) {
-                // 死亡动画播放完毕，但保持死亡动画状态和最后一帧
-                knight.alive = 0; // 设置为死亡，但不重置is_dying标志
-            }
+    // 受击/死亡动画到期
+    if (timer_expired(&knight.state_timer)) {
+        // 状态结束，重置状态标志
+        if (knight.is_taking_damage) {
+            knight.is_taking_damage = 0;
         }
+        if (knight.is_dying) {
+            // 死亡动画播放完毕，但保持死亡动画状态和最后一帧
+            knight.alive = 0; // 设置为死亡，但不重置is_dying标志
+        }
+    }
+    
+    // 冲刺到期，开始冷却（冲刺在输入处理时开始，开始的那一帧也算在冲刺时长内）
+    if (knight.is_dashing && timer_expired(&knight.dash_timer)) {
+        knight.is_dashing = 0;
+        timer_start(&knight.dash_cooldown, KNIGHT_DASH_COOLDOWN_TICKS);
     }
     
     // 更新动画状态
@@ -175,44 +202,10 @@ void update_knight() {
         new_anim_state = KNIGHT_ANIM_IDLE;  // 静止时播放静止动画
     }
     
-    // 如果动画状态改变，重置动画
+    // 如果动画状态改变，从当前帧重新开始播放（第几帧由渲染时按动画片段表算出）
     if (new_anim_state != knight.anim_state) {
         knight.anim_state = new_anim_state;
-        knight.anim_timer = 0.0f;
-        knight.anim_frame = 0;
-    }
-    
-    // 更新动画帧
-    const float ANIM_SPEED = 0.1f; // 动画播放速度（每帧0.1秒）
-    knight.anim_timer += 1.0f / 60.0f; // 假设60FPS
-    
-    if (knight.anim_timer >= ANIM_SPEED) {
-        knight.anim_timer = 0.0f;
-        
-        // 获取当前动画的最大帧数
-        int max_frames;
-        if (knight.anim_state == KNIGHT_ANIM_IDLE) {
-            max_frames = 4;  // idle有4帧
-        } else if (knight.anim_state == KNIGHT_ANIM_RUN) {
-            max_frames = 16; // run有16帧
-        } else if (knight.anim_state == KNIGHT_ANIM_HIT) {
-            max_frames = 4;  // hit有4帧
-        } else if (knight.anim_state == KNIGHT_ANIM_DEATH) {
-            max_frames = 4;  // death有4帧
-        } else {
-            max_frames = 1;
-        }
-        
-        // 对于死亡和受击动画，只播放一次
-        if (knight.anim_state == KNIGHT_ANIM_DEATH || knight.anim_state == KNIGHT_ANIM_HIT) {
-            // 只有在动画还没播放完时才推进帧数
-            if (knight.anim_frame < max_frames - 1) {
-                knight.anim_frame++;
-            }
-            // 如果已经到达最后一帧，就停留在最后一帧，不再改变
-        } else {
-            knight.anim_frame = (knight.anim_frame + 1) % max_frames; // 循环播放
-        }
+        knight.anim_start = timer_now();
     }
     
     // 更新水平移动（应用摩擦力和加速度）
@@ -271,7 +264,7 @@ void update_knight() {
             knight.on_ground = 1;
             knight.double_jump_used = 0;
             knight.is_dashing = 0;
-            knight.dash_timer = 0.0f;
+            timer_stop(&knight.dash_timer);
         } else {
             knight.y = new_y;
             knight.on_ground = 0;
@@ -291,79 +284,72 @@ void update_knight() {
         }
     }
 
-    // 检查是否到达通关方块（只触发一次）
+    // 骑士中心所在格子的触发区域：还在上一帧的区域里时不用查询，否则查询一次区域索引
     int knight_grid_x = (int)((knight.x + knight.width / 2) / TILE_SIZE);
     int knight_grid_y = (int)((knight.y + knight.height / 2) / TILE_SIZE);
-    if (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_GOAL && !game_won) {
+    TriggerEvent trigger_events[2];
+    int trigger_event_count = trigger_update(&trigger_region, knight_grid_x, knight_grid_y, trigger_events);
+    BlockType trigger = trigger_get_type(trigger_region);
+    
+    // 检查是否到达通关方块（只触发一次）
+    if (trigger == BLOCK_GOAL && !game_won) {
         // 设置游戏状态为通关，显示通关菜单
         game_won = 1;
-        set_game_state(GAME_STATE_GAME_OVER);
-        play_sound(SOUND_COIN); // 播放通关音效
-        printf("恭喜通关！你成功到达终点！\n");
+        telemetry_knight_event(TELEMETRY_GOAL, 0);
+        events_push(GAME_EVENT_GOAL, 0, knight.x, knight.y);
     }
 
     // 检查是否获得二连跳能力
-    if (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_DOUBLE_JUMP) {
+    if (trigger == BLOCK_DOUBLE_JUMP) {
         if (collect_double_jump_block(knight_grid_x, knight_grid_y)) {
             knight_enable_double_jump();
-            show_skill_hint("double_jump");
-            play_sound(SOUND_POWER_UP); // 播放技能获得音效
+            telemetry_knight_event(TELEMETRY_PICKUP, BLOCK_DOUBLE_JUMP);
+            events_push(GAME_EVENT_SKILL, BLOCK_DOUBLE_JUMP, knight.x, knight.y);
         }
     }
 
     // 检查是否获得冲刺能力
-    if (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_DASH) {
+    if (trigger == BLOCK_DASH) {
         if (collect_dash_block(knight_grid_x, knight_grid_y)) {
             knight_enable_dash();
-            show_skill_hint("dash");
-            play_sound(SOUND_POWER_UP); // 播放技能获得音效
-        }
-    }
-
-    // 处理冲刺状态
-    if (knight.is_dashing) {
-        knight.dash_timer -= 1.0f / 60.0f;
-        if (knight.dash_timer <= 0) {
-            knight.is_dashing = 0;
-            knight.dash_timer = 0.0f;
-            knight.dash_cooldown = 0.5f; // 0.5秒冷却
+            telemetry_knight_event(TELEMETRY_PICKUP, BLOCK_DASH);
+            events_push(GAME_EVENT_SKILL, BLOCK_DASH, knight.x, knight.y);
         }
     }
 
-    // 每帧递减冷却
-    if (knight.dash_cooldown > 0) {
-        knight.dash_cooldown -= 1.0f / 60.0f;
-        if (knight.dash_cooldown < 0) knight.dash_cooldown = 0;
+    // 检查是否到达存档点方块（进入存档点区域时保存；从一个存档点区域直接走进相邻的区域不重复保存）
+    int current_on_save = (trigger == BLOCK_SAVE);
+    int entered_save = 0;
+    for (int i = 0; i < trigger_event_count; i++) {
+        if (trigger_events[i].type == TRIGGER_EVENT_ENTER && trigger_events[i].block == BLOCK_SAVE) entered_save = 1;
     }
-
-    // 检查是否到达存档点方块
-    int current_on_save = (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_SAVE);
-    if (current_on_save && !on_save_block) {
+    if (entered_save && !on_save_block) {
         // 刚刚进入存档点，进行保存
         save_x = knight.x;
         save_y = knight.y;
         save_set = 1;
-        printf("存档点已记录：(%f, %f)\n", save_x, save_y);
+        telemetry_knight_event(TELEMETRY_SAVE, 0);
+        events_push(GAME_EVENT_SAVE, 0, save_x, save_y);
     }
     on_save_block = current_on_save; // 更新存档点状态
     // 检查是否到达陷阱方块
-    if (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_TRAP) {
-        if (knight.lives > 1) {
+    if (trigger == BLOCK_TRAP) {
+        int respawn = knight.lives > 1;
+        telemetry_knight_event(TELEMETRY_TRAP, respawn);
+        if (respawn) {
             knight_take_damage();
             knight.x = save_x;
             knight.y = save_y;
             knight.vx = 0;
             knight.vy = 0;
-            printf("骑士踩到陷阱，扣血并回到存档点！\n");
         } else {
             knight_take_damage();
-            printf("骑士踩到陷阱，死亡！\n");
         }
+        events_push(GAME_EVENT_TRAP, respawn, knight.x, knight.y);
     }
 
     // 检查是否到达镜头移动方块
-    extern float camera_offset_x;
-    if (get_block_type(knight_grid_x, knight_grid_y) == BLOCK_CAMERA_MOVE) {
+    if (trigger == BLOCK_CAMERA_MOVE) {
         camera_offset_x = 15;
     } else {
         camera_offset_x = 0;
@@ -376,11 +362,11 @@ void knight_jump() {
         knight.vy = JUMP_FORCE;
         knight.on_ground = 0;
         knight.double_jump_used = 0;
-        play_sound(SOUND_JUMP); // 播放跳跃音效
+        events_push(GAME_EVENT_JUMP, 0, knight.x, knight.y);
     } else if (knight.can_double_jump && !knight.double_jump_used && knight.alive) {
         knight.vy = JUMP_FORCE;
         knight.double_jump_used = 1;
-        play_sound(SOUND_JUMP); // 播放跳跃音效
+        events_push(GAME_EVENT_JUMP, 1, knight.x, knight.y);
     }
 }
 
@@ -403,19 +389,20 @@ void get_knight_size(int* w, int* h) {
 
 // 骑士受伤
 void knight_take_damage() {
-    if (!knight.alive || knight.hurt_timer > 0 || knight.is_taking_damage || knight.is_dying) return;
+    if (!knight.alive || timer_running(knight.hurt_timer) || knight.is_taking_damage || knight.is_dying) return;
     knight.lives--;
-    printf("骑士受伤！剩余生命：%d\n", knight.lives);
-    play_sound(SOUND_HURT); // 播放受伤音效
+    telemetry_knight_event(TELEMETRY_DAMAGE, knight.lives);
+    events_push(GAME_EVENT_DAMAGE, knight.lives, knight.x, knight.y);
 
     if (knight.lives <= 0) {
         knight.is_dying = 1;
-        knight.state_timer = 1.2f;
-        printf("骑士死亡！游戏结束！\n");
+        timer_start(&knight.state_timer, KNIGHT_DEATH_TICKS);
+        telemetry_knight_event(TELEMETRY_DEATH, 0);
+        events_push(GAME_EVENT_DEATH, 0, knight.x, knight.y);
     } else {
         knight.is_taking_damage = 1;
-        knight.state_timer = 0.6f;
-        knight.hurt_timer = 2.0f;
+        timer_start(&knight.state_timer, KNIGHT_HIT_TICKS);
+        timer_start(&knight.hurt_timer, KNIGHT_INVULNERABLE_TICKS);
         knight.vx *= 0.3f;
         knight.target_vx = 0;
         // 不再回到起点
@@ -424,7 +411,7 @@ void knight_take_damage() {
 
 // 检查骑士是否处于无敌状态
 int knight_is_invulnerable() {
-    return knight.hurt_timer > 0;
+    return timer_running(knight.hurt_timer);
 }
 
 // 获取骑士生命数
@@ -437,8 +424,8 @@ KnightAnimationState get_knight_animation_state() {
     return knight.anim_state;
 }
 
-int get_knight_animation_frame() {
-    return knight.anim_frame;
+unsigned int get_knight_animation_start() {
+    return knight.anim_start;
 }
 
 int is_knight_facing_right() {
@@ -452,9 +439,9 @@ void knight_enable_double_jump() {
 
 // 冲刺逻辑
 void knight_dash() {
-    if (knight.can_dash && !knight.is_dashing && knight.alive && knight.dash_cooldown <= 0.0f) {
+    if (knight.can_dash && !knight.is_dashing && knight.alive && !timer_running(knight.dash_cooldown)) {
         knight.is_dashing = 1;
-        knight.dash_timer = 0.18f; // 冲刺持续0.18秒
+        timer_start(&knight.dash_timer, TIMER_TICKS(DASH_DURATION));
         knight.vx = knight.facing_right ? DASH_SPEED : -DASH_SPEED;
     }
 }
@@ -462,4 +449,11 @@ void knight_dash() {
 // 获得冲刺能力
 void knight_enable_dash() {
     knight.can_dash = 1;
-} 
\ No newline at end of file
+}
+
+// 骑士和存档点整体平移（无限模式滚动地图时调用）
+void knight_shift_x(float dx) {
+    knight.x += dx;
+    save_x += dx;
+    trigger_region = -1; // 触发区域随地图窗口重建，编号会变
+}
@@ -4,6 +4,8 @@
 #ifndef KNIGHT_H
 #define KNIGHT_H
 
+#include "world_local.h"
+#include "timer.h"
 
 // 骑士物理常量
 #define KNIGHT_ACCELERATION 0.35f
@@ -19,6 +21,7 @@
 #define TILE_SIZE 16
 #define KNIGHT_MAX_SPEED 2.2f
 #define DASH_SPEED 6.0f
+#define DASH_DURATION 0.18f         // 冲刺持续时间（秒）
 
 // 骑士动画状态枚举
 typedef enum {
@@ -37,18 +40,17 @@ typedef struct {
     int alive;           // 是否存活（1=存活，0=死亡）
     int on_ground;       // 是否在地面上（1=在地面，0=在空中）
     int lives;           // 生命数量
-    float hurt_timer;    // 受伤无敌时间
+    TickTimer hurt_timer;  // 受伤无敌结束的逻辑帧
     int facing_right;    // 面向方向（1=右，0=左）
     
     // 动画相关
     KnightAnimationState anim_state;  // 当前动画状态
-    float anim_timer;                 // 动画计时器
-    int anim_frame;                   // 当前动画帧
+    unsigned int anim_start;          // 当前动画开始的逻辑帧
     
     // 状态相关
     int is_taking_damage;  // 是否正在受击（播放受击动画）
     int is_dying;          // 是否正在死亡（播放死亡动画）
-    float state_timer;     // 状态计时器（用于控制受击/死亡动画时长）
+    TickTimer state_timer; // 受击/死亡动画结束的逻辑帧
     
     // 二连跳相关
     int can_double_jump;   // 是否获得二连跳能力
@@ -56,15 +58,26 @@ typedef struct {
     // 冲刺相关
     int can_dash;          // 是否获得冲刺能力
     int is_dashing;        // 当前是否正在冲刺
-    float dash_timer;      // 冲刺剩余时间
-    float dash_cooldown;   // 冲刺冷却剩余时间
+    TickTimer dash_timer;  // 冲刺结束的逻辑帧
+    TickTimer dash_cooldown; // 冲刺冷却结束的逻辑帧
 } Knight;
 
+// 骑士的关卡进度（存档点、通关标志），保存在knight.c内部，快照时整体读写
+typedef struct {
+    float save_x, save_y;  // 存档点坐标
+    int save_set;          // 是否已存档
+    int on_save_block;     // 当前是否在存档点上
+    int game_won;          // 是否已通关
+    int trigger_region;    // 上一帧所在的触发区域（-1表示不在任何区域）
+} KnightProgress;
+
 // 全局骑士对象（允许外部模块访问）
-extern Knight knight;
+extern WORLD_LOCAL Knight knight;
 
 // 骑士相关函数接口
 void init_knight();                    // 初始化骑士
+void knight_get_progress(KnightProgress* progress);        // 读取关卡进度
+void knight_set_progress(const KnightProgress* progress);  // 恢复关卡进度
 void update_knight();                  // 更新骑士状态（位置、碰撞等）
 void set_knight_target_velocity(float target_vx);  // 设置骑士目标速度
 void knight_jump();                    // 骑士跳跃
@@ -73,7 +86,7 @@ void get_knight_size(int* w, int* h);          // 获取骑士尺寸
 
 // 动画相关接口
 KnightAnimationState get_knight_animation_state(); // 获取当前动画状态
-int get_knight_animation_frame();                  // 获取当前动画帧
+unsigned int get_knight_animation_start();         // 获取当前动画开始的逻辑帧
 int is_knight_facing_right();                     // 获取面向方向
 
 // 碰撞检测接口
@@ -93,5 +106,6 @@ void update_knight_horizontal_movement(); // 更新骑士的水平速度
 void knight_enable_double_jump(); // 获得二连跳能力
 void knight_enable_dash();        // 获得冲刺能力
 void knight_dash();                // 执行冲刺
+void knight_shift_x(float dx);     // 骑士和存档点整体平移（无限模式滚动地图时调用）
 
 #endif // KNIGHT_H 
\ No newline at end of file
@@ -0,0 +1,178 @@
+// log.c
+// 分级日志实现
+//
+// 每个写日志的线程第一次写入时领取一个单生产者/单消费者环形缓冲区，
+// 之后直接把格式化结果写进缓冲区的槽位，不加锁、不分配内存、不做IO。
+// 后台线程定期把所有缓冲区的内容写到stderr或日志文件。
+// 缓冲区满时新消息被丢弃（只计数），游戏线程永远不会因为日志而等待。
+// 未调用log_init时（如离线工具）直接同步输出到stderr。
+
+#include "log.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+#define LOG_RING_SIZE 256        // 每个线程的缓冲槽数（2的幂）
+#define LOG_MAX_THREADS 8        // 最多支持的写日志线程数
+#define LOG_MESSAGE_LENGTH 120   // 单条日志最大长度（超出部分截断）
+#define LOG_DRAIN_INTERVAL 5     // 后台线程输出间隔（毫秒）
+
+typedef struct {
+    int level;
+    Uint32 time;                       // 写入时的SDL_GetTicks
+    char text[LOG_MESSAGE_LENGTH];
+} LogEntry;
+
+// 单生产者/单消费者环形缓冲区：head只由写入线程修改，tail只由后台线程修改
+typedef struct {
+    LogEntry entries[LOG_RING_SIZE];
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+    SDL_atomic_t dropped;              // 因缓冲区满而丢弃的条数
+} LogRing;
+
+static LogRing rings[LOG_MAX_THREADS];
+static SDL_atomic_t ring_count;        // 已领取的缓冲区数量
+static SDL_atomic_t unassigned_dropped; // 线程数超出上限而丢弃的条数
+
+// 本线程领取的缓冲区
+static __thread LogRing* thread_ring = NULL;
+
+static SDL_Thread* writer_thread = NULL;
+static SDL_atomic_t writer_running;
+static FILE* output = NULL;
+static int started = 0;
+
+static const char* level_names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+static void write_entry(FILE* file, const LogEntry* entry) {
+    fprintf(file, "[%6u.%03u] [%s] %s\n", entry->time / 1000, entry->time % 1000,
+            level_names[entry->level], entry->text);
+}
+
+// 输出所有缓冲区中的日志，返回输出的条数
+static int drain_rings() {
+    int written = 0;
+    int count = SDL_AtomicGet(&ring_count);
+    if (count > LOG_MAX_THREADS) count = LOG_MAX_THREADS;
+    
+    for (int i = 0; i < count; i++) {
+        LogRing* ring = &rings[i];
+        unsigned int tail = (unsigned int)SDL_AtomicGet(&ring->tail);
+        unsigned int head = (unsigned int)SDL_AtomicGet(&ring->head);
+        SDL_MemoryBarrierAcquire();
+        while (tail != head) {
+            write_entry(output, &ring->entries[tail & (LOG_RING_SIZE - 1)]);
+            tail++;
+            written++;
+        }
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&ring->tail, (int)tail);
+    }
+    if (written) fflush(output);
+    return written;
+}
+
+// 后台输出线程
+static int SDLCALL writer_main(void* data) {
+    (void)data;
+    while (SDL_AtomicGet(&writer_running)) {
+        drain_rings();
+        SDL_Delay(LOG_DRAIN_INTERVAL);
+    }
+    drain_rings();
+    return 0;
+}
+
+// 启动后台输出线程
+int log_init(const char* path) {
+    if (started) return 1;
+    
+    output = stderr;
+    if (path) {
+        output = fopen(path, "w");
+        if (!output) {
+            printf("无法创建日志文件: %s\n", path);
+            output = stderr;
+            return 0;
+        }
+    }
+    
+    SDL_AtomicSet(&writer_running, 1);
+    writer_thread = SDL_CreateThread(writer_main, "log_writer", NULL);
+    if (!writer_thread) {
+        printf("日志线程创建失败: %s\n", SDL_GetError());
+        if (output != stderr) fclose(output);
+        output = NULL;
+        return 0;
+    }
+    started = 1;
+    return 1;
+}
+
+// 输出剩余日志并停止后台线程
+void log_shutdown() {
+    if (!started) return;
+    
+    SDL_AtomicSet(&writer_running, 0);
+    SDL_WaitThread(writer_thread, NULL);
+    writer_thread = NULL;
+    
+    // 报告被丢弃的日志条数
+    int dropped = SDL_AtomicGet(&unassigned_dropped);
+    for (int i = 0; i < LOG_MAX_THREADS; i++) {
+        dropped += SDL_AtomicGet(&rings[i].dropped);
+    }
+    if (dropped > 0) {
+        fprintf(output, "日志缓冲区已满，共丢弃 %d 条日志\n", dropped);
+    }
+    
+    if (output != stderr) fclose(output);
+    output = NULL;
+    started = 0;
+}
+
+// 写一条日志
+void log_write(int level, const char* format, ...) {
+    va_list args;
+    
+    if (!started) {
+        // 未启动后台线程：同步输出
+        LogEntry entry;
+        entry.level = level;
+        entry.time = SDL_GetTicks();
+        va_start(args, format);
+        vsnprintf(entry.text, sizeof(entry.text), format, args);
+        va_end(args);
+        write_entry(stderr, &entry);
+        return;
+    }
+    
+    // 第一次写日志时为本线程领取缓冲区
+    if (!thread_ring) {
+        int index = SDL_AtomicAdd(&ring_count, 1);
+        if (index >= LOG_MAX_THREADS) {
+            SDL_AtomicAdd(&unassigned_dropped, 1);
+            return;
+        }
+        thread_ring = &rings[index];
+    }
+    
+    LogRing* ring = thread_ring;
+    unsigned int head = (unsigned int)SDL_AtomicGet(&ring->head);
+    if (head - (unsigned int)SDL_AtomicGet(&ring->tail) >= LOG_RING_SIZE) {
+        SDL_AtomicAdd(&ring->dropped, 1);
+        return;
+    }
+    
+    LogEntry* entry = &ring->entries[head & (LOG_RING_SIZE - 1)];
+    entry->level = level;
+    entry->time = SDL_GetTicks();
+    va_start(args, format);
+    vsnprintf(entry->text, sizeof(entry->text), format, args);
+    va_end(args);
+    
+    // 先写完槽位内容，再发布新的head
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->head, (int)(head + 1));
+}
@@ -0,0 +1,44 @@
+// log.h
+// 分级日志头文件（游戏线程只格式化到本线程的环形缓冲区，由后台线程输出）
+
+#ifndef LOG_H
+#define LOG_H
+
+// 日志级别
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+
+// 编译期级别过滤：低于该级别的日志调用在编译时被完全移除
+// （例如 make CFLAGS+=-DLOG_MIN_LEVEL=2 只保留警告和错误）
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) log_write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) log_write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) log_write(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#define LOG_ERROR(...) log_write(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// 日志系统接口
+int log_init(const char* path);   // 启动后台输出线程（path为NULL时输出到stderr），成功返回1
+void log_shutdown();              // 输出剩余日志并停止后台线程
+void log_write(int level, const char* format, ...); // 写一条日志（不需要结尾换行）
+
+#endif // LOG_H
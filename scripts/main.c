@@ -3,6 +3,9 @@
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include <SDL.h>
 #include "map.h"
 #include "knight.h"
@@ -13,48 +16,184 @@
 #include "enemy.h"
 #include "ui.h"
 #include "sound.h"
+#include "game.h"
+#include "replay.h"
+#include "statehash.h"
+#include "alloc_track.h"
+#include "log.h"
+#include "telemetry.h"
+#include "snapshot.h"
+#include "rewind.h"
+#include "netplay.h"
+#include "endless.h"
+#include "tilepage.h"
+#include "shm_export.h"
+#include "events.h"
+#include "drawlist.h"
 
 
-// 游戏是否结束的标志
-bool game_over = false;
+// 命令行选项：录制/回放输入录像
+static const char* record_path = NULL;
+static const char* replay_path = NULL;
+static const char* hash_log_path = NULL;
+static const char* log_path = NULL;
+static const char* telemetry_path = NULL;
+static const char* shm_name = NULL;
 
-// 更新游戏状态
-void update_game() {
-    update_knight(); // 更新骑士状态
-    update_enemies(); // 更新敌人状态
+// 命令行选项：双人联机（玩家编号、本地端口、对方地址）
+static int netplay_player = -1;
+static int netplay_port = 0;
+static const char* netplay_remote = NULL;
+
+// 命令行选项：无限模式（种子）
+static int endless_mode = 0;
+static unsigned int endless_seed = 1;
+
+// 命令行选项：分页关卡文件（由level_pack生成）
+static const char* level_path = NULL;
+
+// 命令行选项：画面放大方式（平滑缩放、界面按窗口原生分辨率绘制）
+static int scale_linear = 0;
+static int hud_native = 0;
+
+// 命令行选项：内存分配统计（0=关闭，1=统计，2=稳态帧零分配断言）
+static int alloc_track_mode = 0;
+
+// 进入游戏后用于预热的帧数（此后的游戏帧应当零分配）
+#define ALLOC_WARMUP_FRAMES 60
+
+// 开始新的一局（重置游戏并重新开始录制/回放）
+static void start_new_game() {
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    show_game_start_hint(); // 显示游戏开始操作提示
+    telemetry_knight_event(TELEMETRY_SESSION, 0);
+    rewind_reset();
+    rewind_push();
+    netplay_start_session();
     
-    // 检查骑士与敌人的碰撞
-    if (check_knight_enemy_collision()) {
-        // 骑士受伤
-        knight_take_damage();
-        show_damage_indicator(); // 显示受伤效果
+    if (record_path) {
+        replay_record_begin(record_path);
     }
-    
-    // 检查游戏结束条件
-    if (knight_get_lives() <= 0) {
-        set_game_state(GAME_STATE_GAME_OVER);
+    if (replay_path) {
+        replay_play_begin(replay_path);
+    }
+    if (hash_log_path) {
+        statehash_log_begin(hash_log_path);
     }
 }
 
-// 重置游戏状态
-void reset_game() {
-    reset_map();       // 首先重置地图到初始状态
-    init_knight();
-    init_enemies();
-    game_over = false;
-    reset_menu_selection();
+// 是否按住了时间回溯键（Backspace）
+static bool rewind_held = false;
+
+// 菜单画面空闲时最长等待事件的时间（毫秒）
+#define MENU_IDLE_WAIT_MS 250
+
+// 菜单空闲统计：等待次数和跳过渲染的循环次数
+static unsigned int idle_waits = 0;
+static unsigned int idle_skipped_frames = 0;
+
+// 当前画面是否可以空闲等待：菜单画面上没有任何东西随时间变化（界面计时器按逻辑帧走，
+// 菜单中不推进），只有按键、窗口事件或状态切换才需要重画。回溯和联机需要每帧运行
+static bool can_idle(GameState state) {
+    return state != GAME_STATE_PLAYING && !rewind_held && !netplay_is_active();
+}
+
+// 当前快速存档槽位
+static int quicksave_slot = 0;
+
+// 显示带槽位编号的提示
+static void show_slot_hint(const char* key) {
+    char text[128];
+    snprintf(text, sizeof(text), get_text(key), quicksave_slot + 1);
+    show_skill_hint(text);
+}
+
+// 处理快速存档按键：F5存档，F9读档，1-4选择槽位
+static void handle_quicksave_key(SDL_Keycode key) {
+    if (key == SDLK_F5) {
+        if (quicksave_save(quicksave_slot)) {
+            show_slot_hint("quicksave_hint");
+        }
+    } else if (key == SDLK_F9) {
+        // 读档与回溯一样会把逻辑帧计数倒回去
+        if (!snapshot_can_restore()) {
+            show_skill_hint(get_text("quickload_blocked"));
+        } else if (quicksave_load(quicksave_slot)) {
+            show_slot_hint("quickload_hint");
+        } else {
+            show_slot_hint("quickload_empty");
+        }
+    } else if (key >= SDLK_1 && key < SDLK_1 + QUICKSAVE_SLOT_COUNT) {
+        quicksave_slot = key - SDLK_1;
+        show_slot_hint("quickslot_hint");
+    }
+}
+
+// 解析命令行参数
+static void parse_arguments(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            hash_log_path = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            telemetry_path = argv[++i];
+        } else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (strcmp(argv[i], "--netplay") == 0 && i + 3 < argc) {
+            netplay_player = atoi(argv[++i]);
+            netplay_port = atoi(argv[++i]);
+            netplay_remote = argv[++i];
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            level_path = argv[++i];
+        } else if (strcmp(argv[i], "--endless") == 0) {
+            endless_mode = 1;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) {
+                endless_seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            }
+        } else if (strcmp(argv[i], "--scale-linear") == 0) {
+            scale_linear = 1;
+        } else if (strcmp(argv[i], "--hud-native") == 0) {
+            hud_native = 1;
+        } else if (strcmp(argv[i], "--alloc-track") == 0) {
+            alloc_track_mode = 1;
+        } else if (strcmp(argv[i], "--alloc-assert") == 0) {
+            alloc_track_mode = 2;
+        } else {
+            printf("未知参数: %s\n", argv[i]);
+            printf("用法: %s [--record 录像文件] [--replay 录像文件] [--hash-log 哈希日志] [--log 日志文件] [--telemetry 事件文件] [--shm 共享内存名称] [--netplay 玩家编号 本地端口 对方地址:端口] [--level 关卡文件] [--endless [种子]] [--scale-linear] [--hud-native] [--alloc-track|--alloc-assert]\n", argv[0]);
+        }
+    }
 }
 
 int main(int argc, char* argv[]) {
+    parse_arguments(argc, argv);
+    
+    // 内存统计钩子必须在SDL分配任何内存之前安装
+    if (alloc_track_mode) {
+        alloc_track_install(alloc_track_mode == 2);
+    }
+    
+    // 启动后台日志线程（游戏中的日志不再同步写终端）
+    log_init(log_path);
+    
     // 初始化各个模块
+    render_set_scaling(scale_linear, hud_native);
     if (!init_render()) {
         printf("SDL2 初始化失败！\n");
+        log_shutdown();
         return 1;
     }
     
     if (!init_ui()) {
         printf("UI系统初始化失败！\n");
         cleanup_render();
+        log_shutdown();
         return 1;
     }
     
@@ -62,6 +201,19 @@ int main(int argc, char* argv[]) {
         printf("音效系统初始化失败！\n");
         cleanup_ui();
         cleanup_render();
+        log_shutdown();
+        return 1;
+    }
+    
+    // 分页关卡必须在创建敌人之前载入（快照不包含分页关卡的改动，因此不能联机）
+    if (level_path && netplay_remote) {
+        printf("联机不支持分页关卡\n");
+    }
+    if (level_path && (netplay_remote || !tilepage_open(level_path))) {
+        cleanup_sound_system();
+        cleanup_ui();
+        cleanup_render();
+        log_shutdown();
         return 1;
     }
     
@@ -69,6 +221,33 @@ int main(int argc, char* argv[]) {
     init_input();
     init_enemies();
     
+    if (netplay_remote && !netplay_begin(netplay_player, netplay_port, netplay_remote)) {
+        cleanup_sound_system();
+        cleanup_ui();
+        cleanup_render();
+        log_shutdown();
+        return 1;
+    }
+    
+    // 无限模式：地图窗口会滚动，不能与联机同时使用
+    if (endless_mode) {
+        if (netplay_remote || level_path) {
+            printf("无限模式不能与联机或分页关卡同时使用，已忽略 --endless\n");
+        } else {
+            endless_begin(endless_seed);
+        }
+    }
+    
+    // 整个运行期间的所有对局写入同一个事件文件（每局以session事件开头）
+    if (telemetry_path) {
+        telemetry_begin(telemetry_path);
+    }
+    
+    // 共享内存状态导出（失败时只是不导出，游戏照常运行）
+    if (shm_name) {
+        shm_export_begin(shm_name);
+    }
+    
     // 开始播放背景音乐
     play_background_music();
 
@@ -82,9 +261,22 @@ int main(int argc, char* argv[]) {
     // 累计时间变量，用于更精确的帧率控制
     Uint32 last_time = SDL_GetTicks();
     float time_accumulator = 0.0f;
+    
+    // 连续处于游戏状态的帧数（用于判断稳态帧）
+    int playing_frames = 0;
+    
+    // 菜单画面是否需要重画（收到事件或状态切换后置位）
+    bool frame_dirty = true;
+    int rendered_state = -1;
 
     // SDL2主循环
     while (!quit) {
+        // 菜单画面没有变化时阻塞等待事件，不再每帧渲染和呈现相同的画面
+        if (!frame_dirty && can_idle(get_game_state())) {
+            SDL_WaitEventTimeout(NULL, MENU_IDLE_WAIT_MS);
+            idle_waits++;
+        }
+        
         Uint32 current_time = SDL_GetTicks();
         float delta_time = (current_time - last_time) / 1000.0f; // 转换为秒
         last_time = current_time;
@@ -93,12 +285,27 @@ int main(int argc, char* argv[]) {
         time_accumulator += delta_time;
         const float fixed_timestep = 1.0f / TARGET_FPS;
         
+        alloc_track_frame_begin();
+        GameState frame_start_state = get_game_state();
+        unsigned int frame_start_misses = get_text_cache_misses();
+        
         // 处理事件
         while (SDL_PollEvent(&e)) {
+            frame_dirty = true;
             if (e.type == SDL_QUIT) {
                 quit = true;
             }
             
+            // 渲染目标的内容丢失（例如切换显示模式），菜单背景需要重画
+            if (e.type == SDL_RENDER_TARGETS_RESET) {
+                render_invalidate_cache();
+            }
+            
+            // 时间回溯键在游戏中和游戏结束画面都可以使用（录像、回放、哈希日志和联机时不可用）
+            if (snapshot_can_restore() && (e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && e.key.keysym.sym == SDLK_BACKSPACE) {
+                rewind_held = (e.type == SDL_KEYDOWN);
+            }
+            
             // 根据游戏状态处理输入
             GameState current_state = get_game_state();
             
@@ -122,9 +329,7 @@ int main(int argc, char* argv[]) {
                     
                     if (current_state == GAME_STATE_MAIN_MENU) {
                         if (option == 0) { // 开始游戏
-                            set_game_state(GAME_STATE_PLAYING);
-                            reset_game();
-                            show_game_start_hint(); // 显示游戏开始操作提示
+                            start_new_game();
                         } else if (option == 1) { // 退出
                             quit = true;
                         }
@@ -133,18 +338,14 @@ int main(int argc, char* argv[]) {
                             set_game_state(GAME_STATE_PLAYING);
                             resume_background_music(); // 恢复背景音乐
                         } else if (option == 1) { // 重新开始
-                            set_game_state(GAME_STATE_PLAYING);
-                            reset_game();
-                            show_game_start_hint(); // 重新开始时也显示提示
+                            start_new_game(); // 重新开始时也显示提示
                             resume_background_music(); // 恢复背景音乐
                         } else if (option == 2) { // 退出
                             quit = true;
                         }
                     } else if (current_state == GAME_STATE_GAME_OVER) {
                         if (option == 0) { // 重新开始
-                            set_game_state(GAME_STATE_PLAYING);
-                            reset_game();
-                            show_game_start_hint(); // 重新开始时也显示提示
+                            start_new_game(); // 重新开始时也显示提示
                         } else if (option == 1) { // 退出
                             quit = true;
                         }
@@ -164,59 +365,112 @@ int main(int argc, char* argv[]) {
                 if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_TAB) {
                     toggle_language();
                 }
+                
+                // 快速存档/读档（联机时不可用）
+                if (e.type == SDL_KEYDOWN && !e.key.repeat && !netplay_is_active() && !endless_is_active() && !tilepage_is_open()) {
+                    handle_quicksave_key(e.key.keysym.sym);
+                }
             }
         }
         
         // 不再使用is_action_just_pressed检查ESC退出
 
-        // 只在游戏进行中更新游戏逻辑
-        if (get_game_state() == GAME_STATE_PLAYING) {
+        // 按住回溯键时每个渲染帧倒退一个逻辑帧，并渲染恢复后的状态
+        GameState logic_state = get_game_state();
+        if (rewind_held && (logic_state == GAME_STATE_PLAYING || logic_state == GAME_STATE_GAME_OVER)) {
+            rewind_step_back();
+            time_accumulator = 0.0f;
+        } else if (logic_state == GAME_STATE_PLAYING) {
+            // 只在游戏进行中更新游戏逻辑
             // 固定时间步长更新（确保游戏逻辑稳定）
             while (time_accumulator >= fixed_timestep) {
-                process_input();
-                update_game();
-                update_blocks();  // 更新方块状态
+                // 外部程序通过共享内存接管按键时，用它的按键代替键盘
+                unsigned int override_mask;
+                if (shm_export_read_override(&override_mask)) {
+                    set_input_mask(override_mask);
+                }
+                
+                // 联机模式：由回滚同步层推进双人逻辑帧，对方输入落后太多时本帧不再推进
+                if (netplay_is_active()) {
+                    if (!netplay_advance(get_input_mask())) {
+                        time_accumulator = 0.0f;
+                        break;
+                    }
+                    shm_export_publish(get_input_mask());
+                    time_accumulator -= fixed_timestep;
+                    continue;
+                }
                 
-                // 定期清理死亡的敌人（每秒一次）
-                static int cleanup_counter = 0;
-                cleanup_counter++;
-                if (cleanup_counter >= TARGET_FPS) { // 每60帧（1秒）清理一次
-                    remove_dead_enemies();
-                    cleanup_counter = 0;
+                // 回放模式下用录像中的按键覆盖键盘输入
+                unsigned int replay_mask;
+                if (replay_is_playing() && replay_play_next(&replay_mask)) {
+                    set_input_mask(replay_mask);
                 }
+                replay_record_tick(get_input_mask());
+                
+                game_tick();
+                rewind_push();
+                shm_export_publish(get_input_mask());
                 
                 time_accumulator -= fixed_timestep;
             }
-            
-            // 最后更新摄像机（在所有逻辑更新完成后）
-            float knight_x, knight_y;
-            get_knight_position(&knight_x, &knight_y);
-            
-            // 使用优化的摄像机更新函数，传递角色状态信息
-            update_camera_with_state(knight_x, knight_y, knight.vx, knight.is_dashing, knight.facing_right);
+        } else {
+            // 菜单中不推进逻辑，回到游戏时不补跑停留期间的逻辑帧
+            time_accumulator = 0.0f;
         }
         
-        // 更新UI效果（在所有游戏状态下都更新）
-        update_ui_effects(delta_time);
+        // 菜单画面只在有变化时渲染
+        GameState render_state = get_game_state();
+        bool rendered = frame_dirty || (int)render_state != rendered_state || !can_idle(render_state);
+        if (rendered) {
+            render_game();
+            rendered_state = (int)render_state;
+            frame_dirty = false;
+        } else {
+            idle_skipped_frames++;
+        }
+        netplay_frame_end();
         
-        // 更新输入帧状态（在所有游戏状态下都更新，确保状态一致）
-        update_input_frame();
-
-        render_game();
+        // 稳态帧：整帧都处于游戏状态、过了预热期、且没有生成新的文本纹理
+        if (alloc_track_enabled()) {
+            int playing = frame_start_state == GAME_STATE_PLAYING && get_game_state() == GAME_STATE_PLAYING;
+            playing_frames = playing ? playing_frames + 1 : 0;
+            alloc_track_frame_end(playing && playing_frames > ALLOC_WARMUP_FRAMES &&
+                                  get_text_cache_misses() == frame_start_misses);
+        }
         
-        // 确保不超过目标帧率
+        // 确保不超过目标帧率（空闲时已经在等待事件）
         Uint32 frame_end_time = SDL_GetTicks();
         Uint32 frame_duration = frame_end_time - current_time;
-        if (frame_duration < FRAME_TIME) {
+        if (rendered && frame_duration < FRAME_TIME) {
             SDL_Delay(FRAME_TIME - frame_duration);
         }
     }
 
     // 清理各个模块
+    replay_record_end();
+    replay_play_end();
+    netplay_report();
+    netplay_end();     // 先写出联机已确认帧挂起的输出，再关闭哈希日志和事件统计
+    statehash_log_end();
+    telemetry_end();
+    events_report();
+    drawlist_report();
+    if (idle_waits > 0) {
+        printf("菜单空闲: 等待事件 %u 次，跳过渲染 %u 次\n", idle_waits, idle_skipped_frames);
+    }
+    endless_report();
+    endless_end();
+    tilepage_report();
+    tilepage_close();
+    shm_export_end();
     cleanup_input();
     cleanup_sound_system();
     cleanup_ui();
     cleanup_render();
+    alloc_track_report();
+    rewind_report();
+    log_shutdown();
     printf("游戏结束，感谢游玩！\n");
     return 0;
 }
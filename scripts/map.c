@@ -2,6 +2,8 @@
 // 地图数据实现
 
 #include "map.h"
+#include "hash.h"
+#include "tilepage.h"
 #include <string.h>
 
 // 原始地图模板（不会被修改）
@@ -24,7 +26,7 @@ static const char original_map[MAP_HEIGHT][MAP_WIDTH+1] = {
 };
 
 // 当前游戏地图（可以被修改）
-char game_map[MAP_HEIGHT][MAP_WIDTH+1] = {
+WORLD_LOCAL char game_map[MAP_HEIGHT][MAP_WIDTH+1] = {
     "                                                                                           ",
     "                                                                                           ",
     "                                                                                           ",
@@ -42,10 +44,114 @@ char game_map[MAP_HEIGHT][MAP_WIDTH+1] = {
     "MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMTTTMMMMMMMMMTTTTTTTTTTTTMMMMMMMMMMMMM"
 };
 
+// 地图改动哈希：每个被改动格子的(坐标, 当前字符)键异或累加，
+// 修改格子时先异或掉旧键再异或上新键，无需遍历整张地图
+static WORLD_LOCAL uint64_t mutation_hash = 0;
+
+// 地图改动记录（按发生顺序追加，满了之后压缩为当前与原始地图的差异）
+static WORLD_LOCAL MapMutation mutations[MAP_MUTATION_MAX];
+static WORLD_LOCAL int mutation_count = 0;
+
 // 重置地图到初始状态
 void reset_map() {
-    // 从原始地图模板复制数据到游戏地图
+    // 从原始地图模板复制数据到游戏地图（两者大小相同，整块复制）
+    memcpy(game_map, original_map, sizeof(game_map));
+    mutation_hash = 0;
+    mutation_count = 0;
+    if (tilepage_is_open()) tilepage_reset();
+}
+
+// 当前关卡列数
+int map_get_width() {
+    return tilepage_is_open() ? tilepage_width() : MAP_WIDTH;
+}
+
+// 计算单个格子的哈希键
+static uint64_t tile_key(int x, int y, char tile) {
+    return hash_mix64(((uint64_t)x << 24) | ((uint64_t)y << 8) | (unsigned char)tile);
+}
+
+// 把改动记录压缩为当前地图与原始地图的差异（每个格子最多一条）
+static void compact_mutations() {
+    mutation_count = 0;
     for (int y = 0; y < MAP_HEIGHT; y++) {
-        strcpy(game_map[y], original_map[y]);
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            if (game_map[y][x] != original_map[y][x] && mutation_count < MAP_MUTATION_MAX) {
+                MapMutation* m = &mutations[mutation_count++];
+                m->x = (uint8_t)x;
+                m->y = (uint8_t)y;
+                m->tile = game_map[y][x];
+                m->reserved = 0;
+            }
+        }
+    }
+}
+
+// 修改地图格子（同时更新地图改动哈希）
+void map_set_tile(int x, int y, char tile) {
+    if (tilepage_is_open()) {
+        // 分页关卡：改动记入分页存储的改动表，只维护哈希（不支持快照）
+        if (x < 0 || x >= tilepage_width() || y < 0 || y >= MAP_HEIGHT) return;
+        int code = tilepage_code_from_char(tile);
+        int old_code = tilepage_get(x, y);
+        if (old_code == code) return;
+        int original_code = tilepage_get_original(x, y);
+        if (old_code != original_code) mutation_hash ^= tile_key(x, y, tilepage_char_from_code(old_code));
+        if (code != original_code) mutation_hash ^= tile_key(x, y, tilepage_char_from_code(code));
+        tilepage_set(x, y, code);
+        return;
+    }
+    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) {
+        return;
+    }
+    char old_tile = game_map[y][x];
+    if (old_tile == tile) {
+        return;
+    }
+    // 与原始模板相同的格子不计入哈希，改回原样时哈希也随之复原
+    char original = original_map[y][x];
+    if (old_tile != original) mutation_hash ^= tile_key(x, y, old_tile);
+    if (tile != original) mutation_hash ^= tile_key(x, y, tile);
+    game_map[y][x] = tile;
+    
+    if (mutation_count == MAP_MUTATION_MAX) {
+        compact_mutations();
+    }
+    if (mutation_count < MAP_MUTATION_MAX) {
+        MapMutation* m = &mutations[mutation_count++];
+        m->x = (uint8_t)x;
+        m->y = (uint8_t)y;
+        m->tile = tile;
+        m->reserved = 0;
+    }
+}
+
+// 地图整体左移columns列，右侧空出的列填空格（无限模式滚动时由调用方写入新区块）
+// 此后地图不再对应原始模板，改动记录和哈希一并清空（无限模式不支持快照）
+void map_shift_left(int columns) {
+    if (columns <= 0 || columns > MAP_WIDTH) return;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        memmove(game_map[y], game_map[y] + columns, MAP_WIDTH - columns);
+        memset(game_map[y] + MAP_WIDTH - columns, ' ', columns);
+    }
+    mutation_hash = 0;
+    mutation_count = 0;
+}
+
+// 获取自重置以来所有地图改动的哈希
+uint64_t map_get_mutation_hash() {
+    return mutation_hash;
+} 
+// 获取地图改动记录
+int map_get_mutations(const MapMutation** out) {
+    *out = mutations;
+    return mutation_count;
+}
+
+// 重置地图并重新应用改动记录（地图改动哈希随之恢复）
+void map_restore_mutations(const MapMutation* list, int count) {
+    reset_map();
+    for (int i = 0; i < count; i++) {
+        map_set_tile(list[i].x, list[i].y, list[i].tile);
     }
-} 
\ No newline at end of file
+}
@@ -4,13 +4,30 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <stdint.h>
+#include "world_local.h"
+
 #define MAP_WIDTH 200
 #define MAP_HEIGHT 15
 
 // 地图数组声明（每行+1用于字符串结尾）
-extern char game_map[MAP_HEIGHT][MAP_WIDTH+1];
+extern WORLD_LOCAL char game_map[MAP_HEIGHT][MAP_WIDTH+1];
+
+// 地图改动记录（只记录与原始地图不同的格子，用于快照保存和恢复）
+#define MAP_MUTATION_MAX 256
+typedef struct {
+    uint8_t x, y;      // 格子坐标（MAP_WIDTH不超过255）
+    char tile;         // 改动后的字符
+    uint8_t reserved;
+} MapMutation;
 
 // 地图管理函数
 void reset_map();  // 重置地图到初始状态
+void map_set_tile(int x, int y, char tile);  // 修改地图格子（同时更新地图改动哈希）
+uint64_t map_get_mutation_hash();            // 获取自重置以来所有地图改动的哈希
+int map_get_mutations(const MapMutation** mutations); // 获取地图改动记录，返回条数
+void map_restore_mutations(const MapMutation* mutations, int count); // 重置地图并重新应用改动记录
+void map_shift_left(int columns);            // 地图整体左移（无限模式滚动，清空改动记录）
+int map_get_width();                         // 当前关卡列数（分页关卡时为关卡文件的宽度）
 
 #endif // MAP_H 
\ No newline at end of file
@@ -0,0 +1,415 @@
+// netplay.c
+// 双人联机回滚同步实现
+//
+// 每个逻辑帧：读取本地按键，对方按键未到时用最后一次收到的按键作预测，
+// 先保存合作模式完整快照再模拟这一帧。对方真实按键到达后，如果与预测不同，
+// 恢复到该帧之前的快照，用正确的按键重算到当前帧。
+// 本地最多领先对方已确认输入NETPLAY_MAX_ROLLBACK帧，超过时暂停推进等待，
+// 因此一次回滚最多重算NETPLAY_MAX_ROLLBACK帧，重算耗时有上限。
+//
+// 每个数据包都带上对方尚未确认的全部本地按键，丢包后由下一个包补齐，不需要重传。
+// 同时带上最近一个双方输入都已确认的逻辑帧的状态哈希，用于发现不同步。
+//
+// 每一帧都按待确认帧模拟（game_set_pending_tick），它产生的统计事件、哈希日志和事件日志
+// 先挂起；回滚时丢弃重算范围内挂起的输出，由重算重新产生，双方输入都确认后再写出。
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "netplay.h"
+#include "coop.h"
+#include "game.h"
+#include "log.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define NETPLAY_MAGIC 0x54454E4Bu  // "KNET"
+#define INPUT_RING 64              // 按键和哈希环形缓冲区长度（远大于回滚窗口）
+#define SNAPSHOT_RING (NETPLAY_MAX_ROLLBACK + 2)
+#define NO_ROLLBACK 0xFFFFFFFFu
+
+// 数据包（同一台机器上的两个进程之间使用，按本机字节序）
+typedef struct {
+    uint32_t magic;
+    uint16_t session;          // 对局编号，双方开始新的一局后才互相接受
+    uint8_t player;            // 发送方玩家编号
+    uint8_t count;             // 携带的按键数
+    uint32_t first_tick;       // inputs[0]对应的逻辑帧
+    uint32_t ack;              // 已连续收到对方按键的帧数
+    uint32_t sync_tick;        // sync_hash对应的逻辑帧，无效时为NO_ROLLBACK
+    uint32_t reserved;
+    uint64_t sync_hash;        // 该帧结束时的共享状态哈希
+    uint8_t inputs[NETPLAY_INPUT_HISTORY];
+} NetPacket;
+
+static int active = 0;
+static int local_player = 0;
+static uint16_t session = 0;
+
+// 逻辑帧进度
+static unsigned int current_tick = 0;    // 下一个要模拟的逻辑帧
+static unsigned int remote_count = 0;    // 已连续收到对方按键的帧数
+static unsigned int remote_ack = 0;      // 对方已连续收到本地按键的帧数
+static unsigned int rollback_tick = NO_ROLLBACK; // 需要回滚到的最早逻辑帧
+
+static unsigned char local_inputs[INPUT_RING];
+static unsigned char remote_inputs[INPUT_RING];
+static unsigned char predicted_inputs[INPUT_RING]; // 模拟该帧时使用的对方按键
+static uint64_t tick_hashes[INPUT_RING];           // 该帧结束时的共享状态哈希
+
+// 每个逻辑帧开始前的完整快照
+static unsigned char snapshots[SNAPSHOT_RING][COOP_SNAPSHOT_MAX_SIZE];
+static size_t snapshot_sizes[SNAPSHOT_RING];
+
+// 统计
+static NetplayStats stats;
+static double resim_total_us = 0.0;
+static int frame_depth = 0;       // 本渲染帧的最大回滚深度
+static double frame_resim_us = 0.0;
+static int desync_reported = 0;
+
+// ---------------------------------------------------------------------------
+// UDP套接字（目前只支持类Unix系统）
+
+#ifndef _WIN32
+static int sock = -1;
+static struct sockaddr_storage remote_addr;
+static socklen_t remote_addr_len = 0;
+
+// 打开本地端口并解析对方地址
+static int net_open(int local_port, const char* remote) {
+    const char* colon = strrchr(remote, ':');
+    if (!colon) {
+        printf("联机地址格式应为 主机:端口: %s\n", remote);
+        return 0;
+    }
+    char host[128];
+    size_t host_len = (size_t)(colon - remote);
+    if (host_len == 0 || host_len >= sizeof(host)) {
+        printf("联机地址无效: %s\n", remote);
+        return 0;
+    }
+    memcpy(host, remote, host_len);
+    host[host_len] = '\0';
+
+    struct addrinfo hints, *result = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host, colon + 1, &hints, &result) != 0 || !result) {
+        printf("无法解析联机地址: %s\n", remote);
+        return 0;
+    }
+    memcpy(&remote_addr, result->ai_addr, result->ai_addrlen);
+    remote_addr_len = (socklen_t)result->ai_addrlen;
+    freeaddrinfo(result);
+
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        printf("无法创建UDP套接字\n");
+        return 0;
+    }
+    struct sockaddr_in local_addr;
+    memset(&local_addr, 0, sizeof(local_addr));
+    local_addr.sin_family = AF_INET;
+    local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    local_addr.sin_port = htons((uint16_t)local_port);
+    if (bind(sock, (struct sockaddr*)&local_addr, sizeof(local_addr)) != 0) {
+        printf("无法绑定本地端口 %d\n", local_port);
+        close(sock);
+        sock = -1;
+        return 0;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+    return 1;
+}
+
+static void net_close() {
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+}
+
+static void net_send(const void* data, size_t size) {
+    sendto(sock, data, size, 0, (struct sockaddr*)&remote_addr, remote_addr_len);
+}
+
+// 非阻塞接收，没有数据时返回0
+static int net_receive(void* data, size_t size) {
+    ssize_t received = recvfrom(sock, data, size, 0, NULL, NULL);
+    return received > 0 ? (int)received : 0;
+}
+#else
+static int net_open(int local_port, const char* remote) {
+    (void)local_port;
+    (void)remote;
+    printf("联机模式目前只支持Linux和macOS\n");
+    return 0;
+}
+static void net_close() {}
+static void net_send(const void* data, size_t size) { (void)data; (void)size; }
+static int net_receive(void* data, size_t size) { (void)data; (void)size; return 0; }
+#endif
+
+// ---------------------------------------------------------------------------
+// 会话
+
+// 写出双方输入都已确认的帧挂起的输出（这些帧不会再被回滚）
+static void commit_confirmed_output() {
+    game_commit_output(remote_count < current_tick ? remote_count : current_tick);
+}
+
+// 打开连接
+int netplay_begin(int player, int local_port, const char* remote) {
+    if (player < 0 || player >= COOP_PLAYER_COUNT) {
+        printf("联机玩家编号应为0或1\n");
+        return 0;
+    }
+    if (!net_open(local_port, remote)) {
+        return 0;
+    }
+    local_player = player;
+    active = 1;
+    memset(&stats, 0, sizeof(stats));
+    resim_total_us = 0.0;
+    printf("联机模式：玩家%d，本地端口%d，对方%s\n", player + 1, local_port, remote);
+    return 1;
+}
+
+// 关闭连接
+void netplay_end() {
+    if (!active) return;
+    commit_confirmed_output();
+    game_discard_output(0); // 没有确认的帧不再写出
+    net_close();
+    coop_end();
+    active = 0;
+}
+
+// 是否处于联机模式
+int netplay_is_active() {
+    return active;
+}
+
+// 开始新的一局
+void netplay_start_session() {
+    if (!active) return;
+    session++;
+    game_discard_output(0); // 上一局没有确认的帧不再写出
+    current_tick = 0;
+    remote_count = 0;
+    remote_ack = 0;
+    rollback_tick = NO_ROLLBACK;
+    desync_reported = 0;
+    coop_begin(local_player);
+}
+
+// 模拟第tick帧时使用的对方按键：已收到则用真实按键，否则重复最后一次收到的按键
+static unsigned int remote_input_for(unsigned int tick) {
+    if (tick < remote_count) return remote_inputs[tick % INPUT_RING];
+    if (remote_count > 0) return remote_inputs[(remote_count - 1) % INPUT_RING];
+    return 0;
+}
+
+// 保存快照并模拟一帧
+static void simulate_tick(unsigned int tick) {
+    unsigned int slot = tick % SNAPSHOT_RING;
+    snapshot_sizes[slot] = coop_save(snapshots[slot], COOP_SNAPSHOT_MAX_SIZE);
+
+    unsigned int masks[COOP_PLAYER_COUNT];
+    unsigned int remote = remote_input_for(tick);
+    masks[local_player] = local_inputs[tick % INPUT_RING];
+    masks[1 - local_player] = remote;
+    predicted_inputs[tick % INPUT_RING] = (unsigned char)remote;
+
+    game_set_pending_tick(tick);
+    coop_tick(masks);
+    game_set_pending_tick(GAME_TICK_CONFIRMED);
+    tick_hashes[tick % INPUT_RING] = coop_state_hash();
+}
+
+// 回滚到rollback_tick并用正确的按键重算到当前帧
+static void resimulate() {
+    unsigned int from = rollback_tick;
+    rollback_tick = NO_ROLLBACK;
+    if (from >= current_tick) return;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    unsigned int slot = from % SNAPSHOT_RING;
+    if (!coop_load(snapshots[slot], snapshot_sizes[slot])) {
+        LOG_ERROR("联机回滚失败：第%u帧快照无效", from);
+        return;
+    }
+    game_discard_output(from); // 预测错误的输出作废，重算时重新产生
+    game_set_resimulating(1);
+    for (unsigned int tick = from; tick < current_tick; tick++) {
+        simulate_tick(tick);
+    }
+    game_set_resimulating(0);
+
+    double elapsed_us = (double)(SDL_GetPerformanceCounter() - start) * 1000000.0 /
+                        (double)SDL_GetPerformanceFrequency();
+    int depth = (int)(current_tick - from);
+    if (depth > NETPLAY_MAX_ROLLBACK) depth = NETPLAY_MAX_ROLLBACK;
+    if (depth > frame_depth) frame_depth = depth;
+    frame_resim_us += elapsed_us;
+}
+
+// 最近一个双方输入都已确认的逻辑帧，没有时返回NO_ROLLBACK
+static unsigned int confirmed_tick() {
+    unsigned int confirmed = remote_count < current_tick ? remote_count : current_tick;
+    if (confirmed == 0 || current_tick - (confirmed - 1) > INPUT_RING) return NO_ROLLBACK;
+    return confirmed - 1;
+}
+
+// 发送对方尚未确认的全部本地按键
+static void send_inputs() {
+    NetPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.magic = NETPLAY_MAGIC;
+    packet.session = session;
+    packet.player = (uint8_t)local_player;
+
+    unsigned int first = remote_ack;
+    if (current_tick - first > NETPLAY_INPUT_HISTORY) {
+        first = current_tick - NETPLAY_INPUT_HISTORY;
+    }
+    packet.first_tick = first;
+    packet.count = (uint8_t)(current_tick - first);
+    for (unsigned int i = 0; i < packet.count; i++) {
+        packet.inputs[i] = local_inputs[(first + i) % INPUT_RING];
+    }
+    packet.ack = remote_count;
+    packet.sync_tick = confirmed_tick();
+    if (packet.sync_tick != NO_ROLLBACK) {
+        packet.sync_hash = tick_hashes[packet.sync_tick % INPUT_RING];
+    }
+
+    net_send(&packet, sizeof(packet));
+    stats.packets_sent++;
+}
+
+// 处理一个数据包
+static void handle_packet(const NetPacket* packet) {
+    if (packet->magic != NETPLAY_MAGIC || packet->session != session ||
+        packet->player == local_player || packet->count > NETPLAY_INPUT_HISTORY) {
+        return;
+    }
+    stats.packets_received++;
+
+    if (packet->ack > remote_ack && packet->ack <= current_tick) {
+        remote_ack = packet->ack;
+    }
+
+    // 只接受紧接在已收到部分之后的按键（中间有缺口时等后续包补齐）
+    for (unsigned int i = 0; i < packet->count; i++) {
+        unsigned int tick = packet->first_tick + i;
+        if (tick < remote_count) continue;
+        if (tick > remote_count || tick >= current_tick + INPUT_RING / 2) break;
+
+        unsigned char input = packet->inputs[i];
+        remote_inputs[tick % INPUT_RING] = input;
+        remote_count++;
+
+        // 已经用预测值模拟过的帧，预测错误时需要回滚
+        if (tick < current_tick && predicted_inputs[tick % INPUT_RING] != input &&
+            (rollback_tick == NO_ROLLBACK || tick < rollback_tick)) {
+            rollback_tick = tick;
+        }
+    }
+
+    // 对方确认过的帧，本地也确认后比较状态哈希
+    unsigned int sync = packet->sync_tick;
+    unsigned int confirmed = confirmed_tick();
+    if (sync != NO_ROLLBACK && confirmed != NO_ROLLBACK && sync <= confirmed &&
+        current_tick - sync <= INPUT_RING && rollback_tick == NO_ROLLBACK &&
+        tick_hashes[sync % INPUT_RING] != packet->sync_hash) {
+        stats.desyncs++;
+        if (!desync_reported) {
+            LOG_ERROR("联机状态不同步：第%u帧哈希不一致", sync);
+            desync_reported = 1;
+        }
+    }
+}
+
+// 推进一个逻辑帧
+int netplay_advance(unsigned int local_mask) {
+    if (!active) return 0;
+
+    NetPacket packet;
+    while (net_receive(&packet, sizeof(packet)) == (int)sizeof(packet)) {
+        handle_packet(&packet);
+    }
+    if (rollback_tick != NO_ROLLBACK) {
+        resimulate();
+    }
+
+    // 领先太多时暂停，保证回滚深度不超过NETPLAY_MAX_ROLLBACK
+    stats.remote_lag = (int)(current_tick - remote_count);
+    if (current_tick >= remote_count + NETPLAY_MAX_ROLLBACK) {
+        stats.stalls++;
+        commit_confirmed_output();
+        send_inputs();
+        return 0;
+    }
+
+    local_inputs[current_tick % INPUT_RING] = (unsigned char)local_mask;
+    simulate_tick(current_tick);
+    current_tick++;
+    stats.ticks++;
+    commit_confirmed_output();
+    send_inputs();
+    return 1;
+}
+
+// 渲染帧结束时汇总本帧的回滚深度和重算耗时
+void netplay_frame_end() {
+    if (!active) return;
+    stats.frames++;
+    stats.depth_histogram[frame_depth]++;
+    if (frame_depth > 0) {
+        stats.rollback_frames++;
+        resim_total_us += frame_resim_us;
+        stats.average_resim_us = (float)(resim_total_us / stats.rollback_frames);
+        if (frame_depth > stats.max_depth) stats.max_depth = frame_depth;
+        if (frame_resim_us > stats.max_resim_us) stats.max_resim_us = (float)frame_resim_us;
+        if (frame_resim_us > NETPLAY_RESIM_BUDGET_US) stats.over_budget_frames++;
+        LOG_DEBUG("联机回滚：深度%d帧，重算%.1f微秒", frame_depth, frame_resim_us);
+    }
+    frame_depth = 0;
+    frame_resim_us = 0.0;
+}
+
+// 获取统计信息
+void netplay_get_stats(NetplayStats* out) {
+    *out = stats;
+}
+
+// 打印统计信息
+void netplay_report() {
+    if (stats.frames == 0) return;
+    printf("联机统计: 推进%u帧, 等待%u次, 发送%u包, 收到%u包, 不同步%u次\n",
+           stats.ticks, stats.stalls, stats.packets_sent, stats.packets_received, stats.desyncs);
+    printf("回滚: %u/%u帧发生回滚, 最大深度%d帧, 平均重算%.1f微秒, 最大%.1f微秒, 超出预算%u帧\n",
+           stats.rollback_frames, stats.frames, stats.max_depth,
+           stats.average_resim_us, stats.max_resim_us, stats.over_budget_frames);
+    printf("每帧回滚深度分布:");
+    for (int depth = 0; depth <= NETPLAY_MAX_ROLLBACK; depth++) {
+        printf(" %d:%u", depth, stats.depth_histogram[depth]);
+    }
+    printf("\n");
+}
@@ -0,0 +1,38 @@
+// netplay.h
+// 双人联机回滚同步头文件（UDP交换按键，预测对方输入，输入迟到时回滚重算）
+
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#define NETPLAY_MAX_ROLLBACK 8        // 最多回滚重算的逻辑帧数（本地最多领先对方已确认输入这么多帧）
+#define NETPLAY_INPUT_HISTORY 32      // 每个数据包最多携带的历史按键数（丢包时靠后续包补齐）
+#define NETPLAY_RESIM_BUDGET_US 8000  // 每个渲染帧用于重算的时间预算（约半帧）
+
+// 联机统计信息（回滚深度和重算耗时按渲染帧统计）
+typedef struct {
+    unsigned int ticks;              // 已推进的逻辑帧数
+    unsigned int stalls;             // 等待对方输入而没有推进的次数
+    unsigned int frames;             // 统计的渲染帧数
+    unsigned int rollback_frames;    // 发生过回滚的渲染帧数
+    unsigned int depth_histogram[NETPLAY_MAX_ROLLBACK + 1]; // 每帧最大回滚深度的分布
+    int max_depth;                   // 最大回滚深度
+    float average_resim_us;          // 发生回滚的帧平均重算耗时（微秒）
+    float max_resim_us;              // 单帧最大重算耗时（微秒）
+    unsigned int over_budget_frames; // 重算耗时超出预算的帧数
+    unsigned int packets_sent;       // 发送的数据包数
+    unsigned int packets_received;   // 收到的有效数据包数
+    unsigned int desyncs;            // 双方确认状态哈希不一致的次数
+    int remote_lag;                  // 本地逻辑帧领先对方已确认输入的帧数
+} NetplayStats;
+
+// remote为对方（或中继）的地址，格式为"主机:端口"
+int netplay_begin(int local_player, int local_port, const char* remote); // 打开连接，成功返回1
+void netplay_end();                       // 关闭连接
+int netplay_is_active();                  // 是否处于联机模式
+void netplay_start_session();             // 开始新的一局（在reset_game之后调用，双方都开始后才能推进）
+int netplay_advance(unsigned int local_mask); // 推进一个逻辑帧，需要等待对方输入时返回0
+void netplay_frame_end();                 // 渲染帧结束时调用，汇总本帧的回滚深度和重算耗时
+void netplay_get_stats(NetplayStats* stats); // 获取统计信息
+void netplay_report();                    // 打印统计信息
+
+#endif // NETPLAY_H
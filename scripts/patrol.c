@@ -0,0 +1,180 @@
+// patrol.c
+// 敌人巡逻路段索引实现
+
+#include "patrol.h"
+#include "tilepage.h"
+#include "knight.h"
+#include <stdint.h>
+#include <string.h>
+
+#define PATROL_TILE_SIZE 16
+#define PATROL_ENEMY_SIZE 16   // 索引按栗子小子的尺寸建立
+#define PATROL_SPEED 1.0f      // 与GOOMBA_SPEED相同
+
+// 路段的两个转向点（x在两者之间时每帧走一步，走过端点的一步改为转向）
+typedef struct {
+    float left, right;
+} PatrolSegment;
+
+static WORLD_LOCAL int index_ready = 0;
+static WORLD_LOCAL uint8_t solid[MAP_HEIGHT][MAP_WIDTH];           // 挡住敌人的格子（实心方块和屏障）
+static WORLD_LOCAL uint8_t surface_row[MAP_WIDTH];
+static WORLD_LOCAL PatrolSegment segments[PATROL_SEGMENT_MAX];  // 按行存放，同一行按x排序
+static WORLD_LOCAL int row_start[MAP_HEIGHT + 1];               // 第row行的路段为[row_start[row], row_start[row+1])
+
+// 像素位置是否挡住敌人，与check_enemy_collision相同（地图外算作碰撞）；没有索引时直接查地图
+static int solid_at(float x, float y) {
+    if (!index_ready) return check_enemy_collision(NULL, x, y);
+    int grid_x = (int)(x / PATROL_TILE_SIZE);
+    int grid_y = (int)(y / PATROL_TILE_SIZE);
+    if (grid_x < 0 || grid_x >= MAP_WIDTH || grid_y < 0 || grid_y >= MAP_HEIGHT) return 1;
+    return solid[grid_y][grid_x];
+}
+
+// 与check_enemy_ground_collision相同
+static int ground_at(float x, float y) {
+    float bottom_y = y + PATROL_ENEMY_SIZE;
+    return solid_at(x, bottom_y) || solid_at(x + PATROL_ENEMY_SIZE - 1, bottom_y);
+}
+
+// 高度为y、从x出发朝direction走一步是否会转向（与update_enemy_physics中的撞墙和悬崖判断相同）
+static int blocked(float x, float y, int direction) {
+    float new_x = x + direction * PATROL_SPEED;
+    if (direction > 0) {
+        return solid_at(new_x + PATROL_ENEMY_SIZE, y) ||
+               solid_at(new_x + PATROL_ENEMY_SIZE, y + PATROL_ENEMY_SIZE - 1) ||
+               !ground_at(new_x + PATROL_ENEMY_SIZE, y);
+    }
+    return solid_at(new_x, y) ||
+           solid_at(new_x, y + PATROL_ENEMY_SIZE - 1) ||
+           !ground_at(new_x - 1, y);
+}
+
+// 站在(x, y)时，下一帧的重力和落地处理是否仍把敌人放回当前高度
+static int supported(float x, float y) {
+    float new_y = y + GRAVITY;
+    if (!ground_at(x, new_y)) return 0;
+    int grid_y = (int)((new_y + PATROL_ENEMY_SIZE) / PATROL_TILE_SIZE);
+    return grid_y * PATROL_TILE_SIZE - PATROL_ENEMY_SIZE == y;
+}
+
+// 从right_start向右、从left_start向左逐像素走到转向点。途经的位置都要站得住，并且
+// 反方向走时不会提前转向，这样在两个转向点之间来回走才与完整更新一致。
+// [left_start, right_start]之间的位置由调用方保证满足这些条件。
+static int scan_turn_points(float y, float left_start, float right_start, float* left, float* right) {
+    float x = right_start;
+    while (!blocked(x, y, 1)) {
+        x += PATROL_SPEED;
+        if (x - right_start > PATROL_SCAN_MAX || !supported(x, y) || blocked(x, y, -1)) return 0;
+    }
+    *right = x;
+    x = left_start;
+    while (!blocked(x, y, -1)) {
+        x -= PATROL_SPEED;
+        if (left_start - x > PATROL_SCAN_MAX || !supported(x, y) || blocked(x, y, 1)) return 0;
+    }
+    *left = x;
+    return 1;
+}
+
+// 从地图读取[first, MAP_WIDTH)列的格子（读取期间停用索引，碰撞判断直接查地图）
+static void load_columns(int first) {
+    index_ready = 0;
+    for (int row = 0; row < MAP_HEIGHT; row++) {
+        for (int column = first; column < MAP_WIDTH; column++) {
+            solid[row][column] = (uint8_t)check_enemy_collision(NULL, (float)(column * PATROL_TILE_SIZE),
+                                                                (float)(row * PATROL_TILE_SIZE));
+        }
+    }
+}
+
+// 由格子重新计算每列的地表和所有路段
+static void build_from_solid() {
+    for (int column = 0; column < MAP_WIDTH; column++) {
+        int row = 0;
+        while (row < MAP_HEIGHT && !solid[row][column]) row++;
+        surface_row[column] = (uint8_t)row;
+    }
+    index_ready = 1;
+
+    // 每行的连续可站立格子[first, last]（身体所在格不挡路，脚下的格子挡路）：离两端两格以上
+    // 的位置四周都是同一段路，不会转向也不会掉下去，转向点只需从[first*16+2, last*16-17]
+    // 两端开始扫描；不到三格宽的路段从左端开始整段扫描
+    int count = 0;
+    for (int row = 0; row < MAP_HEIGHT; row++) {
+        row_start[row] = count;
+        const uint8_t* below = row + 1 < MAP_HEIGHT ? solid[row + 1] : NULL;
+        float y = (float)(row * PATROL_TILE_SIZE);
+        int column = 0;
+        while (column < MAP_WIDTH) {
+            if (solid[row][column] || (below && !below[column])) {
+                column++;
+                continue;
+            }
+            int first = column;
+            while (column + 1 < MAP_WIDTH && !solid[row][column + 1] && (!below || below[column + 1])) column++;
+            int last = column++;
+
+            float left_start = (float)(first * PATROL_TILE_SIZE + 2);
+            float right_start = (float)(last * PATROL_TILE_SIZE - 17);
+            if (left_start > right_start) {
+                left_start = right_start = (float)(first * PATROL_TILE_SIZE);
+            }
+            PatrolSegment* segment = &segments[count];
+            if (scan_turn_points(y, left_start, right_start, &segment->left, &segment->right)) {
+                count++;
+            }
+        }
+    }
+    row_start[MAP_HEIGHT] = count;
+}
+
+void patrol_build_index() {
+    index_ready = 0;
+    for (int row = 0; row <= MAP_HEIGHT; row++) row_start[row] = 0;
+    if (tilepage_is_open()) return;
+    load_columns(0);
+    build_from_solid();
+}
+
+void patrol_shift_left(int columns) {
+    if (tilepage_is_open()) return;
+    for (int row = 0; row < MAP_HEIGHT; row++) {
+        memmove(solid[row], solid[row] + columns, (size_t)(MAP_WIDTH - columns));
+    }
+    load_columns(MAP_WIDTH - columns);
+    build_from_solid();
+}
+
+int patrol_find(const Enemy* enemy, float* left, float* right) {
+    if (enemy->width != PATROL_ENEMY_SIZE || enemy->height != PATROL_ENEMY_SIZE) return 0;
+    if (!supported(enemy->x, enemy->y)) return 0;
+
+    if (!index_ready) {
+        return scan_turn_points(enemy->y, enemy->x, enemy->x, left, right);
+    }
+
+    int row = (int)(enemy->y / PATROL_TILE_SIZE);
+    if (row < 0 || row >= MAP_HEIGHT || row * PATROL_TILE_SIZE != enemy->y) return 0;
+
+    // 同一行中最后一个左端点不大于x的路段
+    int low = row_start[row], high = row_start[row + 1];
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (segments[mid].left <= enemy->x) low = mid + 1;
+        else high = mid;
+    }
+    if (low == row_start[row] || enemy->x > segments[low - 1].right) return 0;
+    *left = segments[low - 1].left;
+    *right = segments[low - 1].right;
+    return 1;
+}
+
+int patrol_surface_row(int column) {
+    if (!index_ready || column < 0 || column >= MAP_WIDTH) return -1;
+    return surface_row[column];
+}
+
+int patrol_get_segment_count() {
+    return index_ready ? row_start[MAP_HEIGHT] : 0;
+}
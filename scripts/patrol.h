@@ -0,0 +1,33 @@
+// patrol.h
+// 敌人巡逻路段索引头文件
+//
+// 地面敌人在平台上来回走，什么时候转向只取决于地形。关卡载入时按行找出敌人能站立的
+// 连续格子（身体所在格不是实心方块或屏障、脚下是实心方块），再用与update_enemy_physics
+// 完全相同的撞墙、悬崖和落地判断算出每段路的两个转向点（像素坐标）。路段中间的位置
+// 不需要逐像素检查，只在两端各扫描两三格。敌人落地后查一次所在路段，之后每帧只做
+// 一次比较。中途有单格的坑（敌人会掉下去）的路段不收录，这样的敌人照常完整更新。
+//
+// 另外为每列记录最上面的敌人实心格子所在行：查询这一行以上的格子时直接返回"不碰撞"，
+// 下落和空中的碰撞判断因此大多不用查地图。
+//
+// 索引按内存中的地图建立（内置关卡，以及无限模式的地图窗口）。建立时先把挡住敌人的格子
+// 读成一张表，路段和地表都由这张表算出；无限模式滚动时表随窗口平移，只读取新露出的列。
+// 分页关卡的宽度不受限制，索引会随关卡变大，所以不建索引，敌人落地后从当前位置逐像素
+// 扫描转向点。
+// 敌人相关的方块在游戏中不会改变，索引不需要保存在快照中。
+
+#ifndef PATROL_H
+#define PATROL_H
+
+#include "enemy.h"
+
+#define PATROL_SEGMENT_MAX (MAP_HEIGHT * (MAP_WIDTH / 2 + 1))   // 每行最多MAP_WIDTH/2+1段
+#define PATROL_SCAN_MAX (64 * 16)                                // 逐像素扫描时单侧最多扫描的距离
+
+void patrol_build_index();                       // 按当前地图重建索引（分页关卡时停用索引）
+void patrol_shift_left(int columns);             // 地图窗口左移后更新索引（只读取新露出的列，无限模式）
+int patrol_find(const Enemy* enemy, float* left, float* right); // 站在地面上的敌人所在路段的转向点，找不到返回0
+int patrol_surface_row(int column);              // 该列最上面的敌人实心格子所在行（没有实心格子为MAP_HEIGHT，没有索引时为-1）
+int patrol_get_segment_count();                  // 索引中的路段数
+
+#endif // PATROL_H
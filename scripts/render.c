@@ -11,11 +11,28 @@
 #include "enemy.h"
 #include "render.h"
 #include "ui.h"
+#include "coop.h"
+#include "anim.h"
+#include "timer.h"
+#include "drawlist.h"
 
 // 全局窗口和渲染器指针
 SDL_Window* gWindow = NULL;
 SDL_Renderer* gRenderer = NULL;
 
+// 场景目标纹理（逻辑分辨率大小，每帧放大一次到窗口）
+static SDL_Texture* scene_target = NULL;
+static int scale_linear = 0;   // 最终放大使用线性过滤和非整数倍数
+static int hud_native = 0;     // 界面在放大之后以窗口原生分辨率绘制
+
+// 菜单画面的定格背景：进入暂停或结束画面时画一次当时的游戏画面（主菜单为天空色），
+// 之后每帧直接使用；逻辑帧变化（回溯）或切换画面时重画
+static SDL_Texture* backdrop = NULL;
+static int backdrop_state = -1;          // 背景对应的游戏状态（-1表示需要重画）
+static unsigned int backdrop_tick = 0;   // 背景对应的逻辑帧
+static unsigned int backdrop_generation = 0;
+static unsigned int menu_key = 0;        // 场景纹理中已合成的菜单画面（0表示没有）
+
 // 全局纹理指针
 static SDL_Texture* grass_texture = NULL;
 static SDL_Texture* mud_texture = NULL;
@@ -23,15 +40,11 @@ static SDL_Texture* fruit1_texture = NULL;
 static SDL_Texture* fruit2_texture = NULL;
 static SDL_Texture* fruit3_texture = NULL;
 
-// 角色动画纹理数组
-static SDL_Texture* player_idle_textures[4];   // idle动画4帧
-static SDL_Texture* player_run_textures[16];   // run动画16帧
-static SDL_Texture* player_hit_textures[4];    // hit动画4帧
-static SDL_Texture* player_death_textures[4];  // death动画4帧
-
-// 敌人动画纹理数组
-static SDL_Texture* enemy_idle_textures[4];    // enemy idle动画4帧
-static SDL_Texture* enemy_hit_textures[4];     // enemy hit动画4帧
+// 动画状态对应的片段名称（按枚举顺序，片段在assets/animations.txt中定义）
+static const char* KNIGHT_CLIP_NAMES[] = {"player_idle", "player_run", "player_hit", "player_death"};
+static const char* ENEMY_CLIP_NAMES[] = {"enemy_idle", "enemy_hit"};
+static int knight_clips[4];   // KnightAnimationState -> 片段编号
+static int enemy_clips[2];    // EnemyAnimationState -> 片段编号
 
 // 每个格子的像素大小
 #define TILE_SIZE 16
@@ -152,38 +165,34 @@ SDL_Texture* get_mud_texture() {
     return mud_texture;
 }
 
-// 绘制彩色矩形的辅助函数
-void draw_colored_rect(SDL_Renderer* renderer, int x, int y, int w, int h, SDL_Color color) {
-    // 保存当前绘制颜色
-    Uint8 old_r, old_g, old_b, old_a;
-    SDL_GetRenderDrawColor(renderer, &old_r, &old_g, &old_b, &old_a);
-    
-    // 设置新颜色
-    SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-    
-    // 绘制填充矩形
-    SDL_Rect rect = {x, y, w, h};
-    SDL_RenderFillRect(renderer, &rect);
-    
-    // 恢复原来的颜色
-    SDL_SetRenderDrawColor(renderer, old_r, old_g, old_b, old_a);
+// 按名称找到各动画状态对应的片段
+static int resolve_clips(const char** names, int* clips, int count) {
+    for (int i = 0; i < count; i++) {
+        clips[i] = anim_find_clip(names[i]);
+        if (clips[i] < 0) {
+            printf("动画片段表中缺少片段: %s\n", names[i]);
+            return 0;
+        }
+    }
+    return 1;
 }
 
-// 绘制纹理的辅助函数
-void draw_texture(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y, int w, int h) {
-    if (!texture) return;
-    
-    SDL_Rect dest_rect = {x, y, w, h};
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+// 加载动画片段表和图集
+static int load_animation_clips() {
+    if (!anim_load(gRenderer, ANIM_TABLE_PATH)) return 0;
+    return resolve_clips(KNIGHT_CLIP_NAMES, knight_clips, 4) && resolve_clips(ENEMY_CLIP_NAMES, enemy_clips, 2);
 }
 
-// 绘制可翻转纹理的辅助函数
-void draw_texture_flip(SDL_Renderer* renderer, SDL_Texture* texture, int x, int y, int w, int h, int flip_horizontal) {
-    if (!texture) return;
-    
-    SDL_Rect dest_rect = {x, y, w, h};
-    SDL_RendererFlip flip = flip_horizontal ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE;
-    SDL_RenderCopyEx(renderer, texture, NULL, &dest_rect, 0.0, NULL, flip);
+// 填写一个待计算帧号的动画
+static void set_animator(Animator* animator, int clip, unsigned int start) {
+    animator->clip = clip;
+    animator->start = start;
+    animator->frame = 0;
+}
+
+void render_set_scaling(int linear, int native_hud) {
+    scale_linear = linear;
+    hud_native = native_hud;
 }
 
 // 初始化SDL2窗口和渲染器
@@ -208,13 +217,23 @@ int init_render() {
         SDL_Log("SDL_CreateRenderer Error: %s", SDL_GetError());
         return 0;
     }
-    // 设置逻辑分辨率，保持固定比例缩放
+    // 设置逻辑分辨率，保持固定比例缩放（默认只按整数倍放大，放不下的部分留黑边）
     int logical_width = CAMERA_VIEW_WIDTH * TILE_SIZE;  // 320
     int logical_height = CAMERA_VIEW_HEIGHT * TILE_SIZE; // 176
     SDL_RenderSetLogicalSize(gRenderer, logical_width, logical_height);
+    SDL_RenderSetIntegerScale(gRenderer, scale_linear ? SDL_FALSE : SDL_TRUE);
+    
+    // 场景目标纹理：只有平滑缩放时最终放大才使用线性过滤
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, scale_linear ? "1" : "0");
+    scene_target = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, logical_width, logical_height);
+    backdrop = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, logical_width, logical_height);
+    if (!scene_target || !backdrop) {
+        SDL_Log("SDL_CreateTexture Error: %s", SDL_GetError());
+        return 0;
+    }
     
-    // 设置缩放质量为最佳
-    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1");
+    // 像素素材和文字按原始像素复制，使用最近邻采样
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
     
     // 加载纹理
     if (!load_textures()) {
@@ -225,15 +244,9 @@ int init_render() {
     // 初始化摄像机（使用逻辑分辨率）
     init_camera(logical_width, logical_height);
     
-    // 加载角色动画纹理
-    if (!load_player_animations()) {
-        printf("角色动画纹理加载失败！\n");
-        return 0;
-    }
-    
-    // 加载敌人动画纹理
-    if (!load_enemy_animations()) {
-        printf("敌人动画纹理加载失败！\n");
+    // 加载动画片段表和图集
+    if (!load_animation_clips()) {
+        printf("动画加载失败！\n");
         return 0;
     }
     
@@ -241,27 +254,52 @@ int init_render() {
     return 1;
 }
 
-// 渲染游戏画面
-void render_game() {
-    // 清屏（天空蓝）
-    SDL_SetRenderDrawColor(gRenderer, COLOR_BG.r, COLOR_BG.g, COLOR_BG.b, COLOR_BG.a);
-    SDL_RenderClear(gRenderer);
+// 把全局骑士放入绘制队列（合作模式下先换入另一名玩家再调用一次，depth大的画在上面）
+static void render_knight(const Animator* animator, int depth, float render_offset_x, float render_offset_y) {
+    float knight_world_x, knight_world_y;
+    int knight_w, knight_h;
+    get_knight_position(&knight_world_x, &knight_world_y);
+    get_knight_size(&knight_w, &knight_h);
     
-    // 根据游戏状态渲染不同内容
-    GameState current_state = get_game_state();
+    // 计算屏幕坐标，使用平滑的浮点数计算
+    SDL_Rect knightRect = {
+        (int)(knight_world_x - render_offset_x), 
+        (int)(knight_world_y - render_offset_y), 
+        knight_w, 
+        knight_h
+    };
     
-    if (current_state == GAME_STATE_MAIN_MENU) {
-        // 渲染主菜单
-        render_main_menu();
-        SDL_RenderPresent(gRenderer);
-        return;
-    } else if (current_state == GAME_STATE_GAME_OVER) {
-        // 渲染游戏结束画面
-        render_game_over_screen();
-        SDL_RenderPresent(gRenderer);
-        return;
+    // 决定是否绘制骑士（受击时不闪烁，只有无敌且不在播放受击动画时才闪烁）
+    int should_draw = 1;
+    if (knight_is_invulnerable()) {
+        // 获取骑士动画状态
+        KnightAnimationState current_anim_state = get_knight_animation_state();
+        
+        // 只有在无敌状态下且不在播放受击或死亡动画时才闪烁
+        if (current_anim_state != KNIGHT_ANIM_HIT && current_anim_state != KNIGHT_ANIM_DEATH) {
+            // 使用简单的时间计算实现闪烁
+            static int flash_counter = 0;
+            flash_counter++;
+            should_draw = (flash_counter / 6) % 2; // 每6帧切换一次
+        }
+    }
+    
+    if (should_draw) {
+        // 使用动画图集渲染，支持水平翻转
+        // 注意：facing_right为0时翻转，为1时不翻转
+        SDL_Texture* texture;
+        SDL_Rect source;
+        if (anim_get_frame(animator, &texture, &source)) {
+            drawlist_texture(DRAW_LAYER_PLAYERS, depth, texture, &source, &knightRect, !is_knight_facing_right());
+        } else {
+            // 备用：如果纹理加载失败，使用纯色矩形
+            drawlist_rect(DRAW_LAYER_PLAYERS, depth, COLOR_KNIGHT, &knightRect);
+        }
     }
+}
 
+// 绘制地图、敌人和骑士（游戏进行中和暂停时）
+static void render_world() {
     // 获取摄像机浮点数位置
     float camera_x_float, camera_y_float;
     get_camera_offset(&camera_x_float, &camera_y_float);
@@ -270,11 +308,14 @@ void render_game() {
     float render_offset_x = camera_x_float;
     float render_offset_y = camera_y_float;
 
+    // 地图、敌人和骑士放入绘制队列，最后排序后成批提交
+    drawlist_begin(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+
     // 绘制地图（只渲染视野内的部分）
     int start_x = (int)(camera_x_float / TILE_SIZE);
     int end_x = start_x + (32 * TILE_SIZE) / TILE_SIZE + 2;
     if (start_x < 0) start_x = 0;
-    if (end_x > MAP_WIDTH) end_x = MAP_WIDTH;
+    if (end_x > map_get_width()) end_x = map_get_width();
     
     for (int y = 0; y < MAP_HEIGHT; y++) {
         for (int x = start_x; x < end_x; x++) {
@@ -290,25 +331,29 @@ void render_game() {
             BlockType block_type = get_block_type(x, y);
             
             if (block_type == BLOCK_DOUBLE_JUMP) {
-                draw_texture(gRenderer, fruit1_texture, rect.x, rect.y, rect.w, rect.h);
+                drawlist_texture(DRAW_LAYER_TILES, 0, fruit1_texture, NULL, &rect, 0);
             } else if (block_type == BLOCK_GOAL) {
-                draw_texture(gRenderer, fruit3_texture, rect.x, rect.y, rect.w, rect.h);
+                drawlist_texture(DRAW_LAYER_TILES, 0, fruit3_texture, NULL, &rect, 0);
             } else if (block_type == BLOCK_GRASS) {
                 // 草地方块：使用草地纹理
-                draw_texture(gRenderer, grass_texture, rect.x, rect.y, rect.w, rect.h);
+                drawlist_texture(DRAW_LAYER_TILES, 0, grass_texture, NULL, &rect, 0);
             } else if (block_type == BLOCK_MUD) {
                 // 泥土方块：使用泥土纹理
-                draw_texture(gRenderer, mud_texture, rect.x, rect.y, rect.w, rect.h);
-            } else if (block_type == BLOCK_NORMAL || game_map[y][x] == '#') {
+                drawlist_texture(DRAW_LAYER_TILES, 0, mud_texture, NULL, &rect, 0);
+            } else if (block_type == BLOCK_NORMAL) {
                 // 普通砖块（备用，不应该到达这里）
-                draw_colored_rect(gRenderer, rect.x, rect.y, rect.w, rect.h, COLOR_WALL);
+                drawlist_rect(DRAW_LAYER_TILES, 0, COLOR_WALL, &rect);
             } else if (block_type == BLOCK_DASH) {
-                draw_texture(gRenderer, fruit2_texture, rect.x, rect.y, rect.w, rect.h);
+                drawlist_texture(DRAW_LAYER_TILES, 0, fruit2_texture, NULL, &rect, 0);
             }
         }
     }
 
-    // 绘制敌人
+    // 视野内的敌人和骑士的动画放进一个数组（敌人在前，骑士在最后），一次算出所有帧号
+    Animator animators[MAX_ENEMIES + COOP_PLAYER_COUNT];
+    SDL_Rect enemy_rects[MAX_ENEMIES];
+    int animated_enemies[MAX_ENEMIES];   // 每个动画对应的敌人编号
+    int animator_count = 0;
     for (int i = 0; i < enemy_count; i++) {
         float enemy_x, enemy_y;
         int enemy_w, enemy_h;
@@ -326,290 +371,182 @@ void render_game() {
             enemy_w,
             enemy_h
         };
+        if (!drawlist_visible(&enemyRect)) continue; // 视野外的敌人不计算动画也不放入队列
         
-        // 根据敌人状态绘制
-        if (enemy_state == ENEMY_STATE_STOMPED) {
-            // 即使是被踩死状态，也要尝试使用动画纹理渲染
-            EnemyAnimationState anim_state = get_enemy_animation_state(i);
-            int anim_frame = get_enemy_animation_frame(i);
-            int direction = get_enemy_direction(i);
-            
-            // 获取当前帧的纹理
-            SDL_Texture* enemy_texture = get_enemy_animation_texture(anim_state, anim_frame);
-            
-            if (enemy_texture) {
-                // 使用动画纹理渲染，支持水平翻转
-                // direction为-1时翻转（面向左），为1时不翻转（面向右）
-                draw_texture_flip(gRenderer, enemy_texture, 
-                                 enemyRect.x, enemyRect.y, enemyRect.w, enemyRect.h, 
-                                 direction == -1);
-            } else {
-                // 备用：如果纹理加载失败，使用灰色矩形表示死亡状态
-                draw_colored_rect(gRenderer, enemyRect.x, enemyRect.y, enemyRect.w, enemyRect.h, COLOR_ENEMY_DEAD);
-            }
-        } else {
-            // 获取敌人动画信息
-            EnemyAnimationState anim_state = get_enemy_animation_state(i);
-            int anim_frame = get_enemy_animation_frame(i);
-            int direction = get_enemy_direction(i);
-            
-            // 获取当前帧的纹理
-            SDL_Texture* enemy_texture = get_enemy_animation_texture(anim_state, anim_frame);
-            
-            if (enemy_texture) {
-                // 使用动画纹理渲染，支持水平翻转
-                // direction为-1时翻转（面向左），为1时不翻转（面向右）
-                draw_texture_flip(gRenderer, enemy_texture, 
-                                 enemyRect.x, enemyRect.y, enemyRect.w, enemyRect.h, 
-                                 direction == -1);
-            } else {
-                // 备用：如果纹理加载失败，使用纯色矩形
-                draw_colored_rect(gRenderer, enemyRect.x, enemyRect.y, enemyRect.w, enemyRect.h, COLOR_ENEMY);
-            }
-        }
-    }
+        enemy_rects[animator_count] = enemyRect;
+        animated_enemies[animator_count] = i;
+        set_animator(&animators[animator_count++], enemy_clips[get_enemy_animation_state(i)], get_enemy_animation_start(i));
+    }
+    int enemy_animator_count = animator_count;
+    if (coop_is_active()) {
+        coop_swap_partner();
+        set_animator(&animators[animator_count++], knight_clips[get_knight_animation_state()], get_knight_animation_start());
+        coop_swap_partner();
+    }
+    set_animator(&animators[animator_count++], knight_clips[get_knight_animation_state()], get_knight_animation_start());
+    anim_advance(animators, animator_count, timer_now());
 
-    // 绘制骑士（最后绘制，确保在前景）
-    float knight_world_x, knight_world_y;
-    int knight_w, knight_h;
-    get_knight_position(&knight_world_x, &knight_world_y);
-    get_knight_size(&knight_w, &knight_h);
-    
-    // 计算屏幕坐标，使用平滑的浮点数计算
-    SDL_Rect knightRect = {
-        (int)(knight_world_x - render_offset_x), 
-        (int)(knight_world_y - render_offset_y), 
-        knight_w, 
-        knight_h
-    };
-    
-    // 决定是否绘制骑士（受击时不闪烁，只有无敌且不在播放受击动画时才闪烁）
-    int should_draw = 1;
-    if (knight_is_invulnerable()) {
-        // 获取骑士动画状态
-        KnightAnimationState current_anim_state = get_knight_animation_state();
-        
-        // 只有在无敌状态下且不在播放受击或死亡动画时才闪烁
-        if (current_anim_state != KNIGHT_ANIM_HIT && current_anim_state != KNIGHT_ANIM_DEATH) {
-            // 使用简单的时间计算实现闪烁
-            static int flash_counter = 0;
-            flash_counter++;
-            should_draw = (flash_counter / 6) % 2; // 每6帧切换一次
-        }
-    }
-    
-    if (should_draw) {
-        // 获取当前动画状态和帧
-        KnightAnimationState anim_state = get_knight_animation_state();
-        int anim_frame = get_knight_animation_frame();
-        int facing_right = is_knight_facing_right();
-        
-        // 获取当前帧的纹理
-        SDL_Texture* knight_texture = get_player_animation_texture(anim_state, anim_frame);
+    // 绘制敌人
+    for (int a = 0; a < enemy_animator_count; a++) {
+        int i = animated_enemies[a];
         
-        if (knight_texture) {
-            // 使用动画纹理渲染，支持水平翻转
-            // 注意：facing_right为0时翻转，为1时不翻转
-            draw_texture_flip(gRenderer, knight_texture, 
-                             knightRect.x, knightRect.y, knightRect.w, knightRect.h, 
-                             !facing_right);
+        // 使用动画图集渲染，支持水平翻转
+        // direction为-1时翻转（面向左），为1时不翻转（面向右）
+        SDL_Texture* texture;
+        SDL_Rect source;
+        if (anim_get_frame(&animators[a], &texture, &source)) {
+            drawlist_texture(DRAW_LAYER_ENEMIES, 0, texture, &source, &enemy_rects[a], get_enemy_direction(i) == -1);
         } else {
-            // 备用：如果纹理加载失败，使用纯色矩形
-            draw_colored_rect(gRenderer, knightRect.x, knightRect.y, knightRect.w, knightRect.h, COLOR_KNIGHT);
+            // 备用：如果没有图集，使用纯色矩形（被踩死的敌人用灰色）
+            SDL_Color color = enemies[i].state == ENEMY_STATE_STOMPED ? COLOR_ENEMY_DEAD : COLOR_ENEMY;
+            drawlist_rect(DRAW_LAYER_ENEMIES, 0, color, &enemy_rects[a]);
         }
     }
 
-    // 渲染游戏内UI（生命值、提示等）
-    render_game_ui();
-    
-    // 渲染游戏提示（操作提示、技能获得提示等）
-    render_game_hints();
-    
-    // 如果游戏暂停，渲染暂停菜单
-    if (current_state == GAME_STATE_PAUSED) {
-        render_pause_menu();
+    // 绘制骑士（最后绘制，确保在前景；合作模式下另一名玩家在下，本地玩家在最上层）
+    if (coop_is_active()) {
+        coop_swap_partner();
+        render_knight(&animators[enemy_animator_count], 0, render_offset_x, render_offset_y);
+        coop_swap_partner();
     }
+    render_knight(&animators[animator_count - 1], 1, render_offset_x, render_offset_y);
 
-    SDL_RenderPresent(gRenderer);
+    // 排序并提交地图、敌人和骑士
+    drawlist_submit(gRenderer);
 }
 
-// 释放SDL2资源
-void cleanup_render() {
-    cleanup_textures();  // 清理纹理
-    cleanup_player_animations();  // 清理角色动画纹理
-    cleanup_enemy_animations();   // 清理敌人动画纹理
-    if (gRenderer) SDL_DestroyRenderer(gRenderer);
-    if (gWindow) SDL_DestroyWindow(gWindow);
-    SDL_Quit();
-    printf("渲染系统已清理！\n");
+// 绘制菜单（主菜单、暂停菜单或游戏结束画面）
+static void render_menu(GameState current_state) {
+    if (current_state == GAME_STATE_MAIN_MENU) {
+        render_main_menu();
+    } else if (current_state == GAME_STATE_PAUSED) {
+        render_pause_menu();
+    } else if (current_state == GAME_STATE_GAME_OVER) {
+        render_game_over_screen();
+    }
 }
 
-// 加载角色动画纹理
-int load_player_animations() {
-    char filename[256];
-    
-    // 加载idle动画帧
-    for (int i = 0; i < 4; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/player/player_idle%d.png", i + 1);
-        player_idle_textures[i] = load_texture_from_file(filename);
-        if (!player_idle_textures[i]) {
-            printf("无法加载idle动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
-    }
-    
-    // 加载run动画帧
-    for (int i = 0; i < 16; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/player/player_run%d.png", i + 1);
-        player_run_textures[i] = load_texture_from_file(filename);
-        if (!player_run_textures[i]) {
-            printf("无法加载run动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
-    }
-    
-    // 加载hit动画帧
-    for (int i = 0; i < 4; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/player/player_hit%d.png", i + 1);
-        player_hit_textures[i] = load_texture_from_file(filename);
-        if (!player_hit_textures[i]) {
-            printf("无法加载hit动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
-    }
-    
-    // 加载death动画帧
-    for (int i = 0; i < 4; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/player/player_death%d.png", i + 1);
-        player_death_textures[i] = load_texture_from_file(filename);
-        if (!player_death_textures[i]) {
-            printf("无法加载death动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
+// 绘制界面：游戏内UI和提示，菜单画面再加上菜单
+static void render_hud(GameState current_state) {
+    if (current_state == GAME_STATE_PLAYING || current_state == GAME_STATE_PAUSED) {
+        // 渲染游戏内UI（生命值、提示等）
+        render_game_ui();
+        
+        // 渲染游戏提示（操作提示、技能获得提示等）
+        render_game_hints();
     }
-    
-    printf("角色动画纹理加载成功！(idle: 4帧, run: 16帧, hit: 4帧, death: 4帧)\n");
-    return 1;
+    render_menu(current_state);
 }
 
-// 清理角色动画纹理
-void cleanup_player_animations() {
-    // 清理idle动画纹理
-    for (int i = 0; i < 4; i++) {
-        if (player_idle_textures[i]) {
-            SDL_DestroyTexture(player_idle_textures[i]);
-            player_idle_textures[i] = NULL;
-        }
-    }
-    
-    // 清理run动画纹理
-    for (int i = 0; i < 16; i++) {
-        if (player_run_textures[i]) {
-            SDL_DestroyTexture(player_run_textures[i]);
-            player_run_textures[i] = NULL;
-        }
-    }
-    
-    // 清理hit动画纹理
-    for (int i = 0; i < 4; i++) {
-        if (player_hit_textures[i]) {
-            SDL_DestroyTexture(player_hit_textures[i]);
-            player_hit_textures[i] = NULL;
-        }
-    }
-    
-    // 清理death动画纹理
-    for (int i = 0; i < 4; i++) {
-        if (player_death_textures[i]) {
-            SDL_DestroyTexture(player_death_textures[i]);
-            player_death_textures[i] = NULL;
+// 清屏（天空蓝）
+static void clear_to_sky() {
+    SDL_SetRenderDrawColor(gRenderer, COLOR_BG.r, COLOR_BG.g, COLOR_BG.b, COLOR_BG.a);
+    SDL_RenderClear(gRenderer);
+}
+
+// 把当前游戏画面（不含菜单）画到定格背景上
+static void capture_backdrop(GameState current_state) {
+    SDL_SetRenderTarget(gRenderer, backdrop);
+    clear_to_sky();
+    if (current_state != GAME_STATE_MAIN_MENU) {
+        render_world();
+        if (!hud_native) {
+            render_game_ui();
+            render_game_hints();
         }
     }
+    backdrop_state = current_state;
+    backdrop_tick = timer_now();
+    backdrop_generation++;
 }
 
-// 获取指定动画状态和帧的纹理
-SDL_Texture* get_player_animation_texture(KnightAnimationState state, int frame) {
-    if (state == KNIGHT_ANIM_IDLE) {
-        if (frame >= 0 && frame < 4) {
-            return player_idle_textures[frame];
-        }
-    } else if (state == KNIGHT_ANIM_RUN) {
-        if (frame >= 0 && frame < 16) {
-            return player_run_textures[frame];
+// 菜单画面的内容标识：背景、画面类型、语言、通关还是死亡、选中的选项
+static unsigned int current_menu_key(GameState current_state) {
+    return (backdrop_generation << 8) | ((unsigned int)current_state << 5) |
+           ((unsigned int)get_current_language() << 4) | ((knight_get_lives() > 0) << 3) |
+           (unsigned int)(get_selected_menu_option() & 7);
+}
+
+// 逻辑分辨率到窗口的放大倍数（与SDL_RenderSetLogicalSize的计算一致：取宽高中较小的比例，
+// 整数倍放大时向下取整）
+static float output_scale() {
+    int output_width, output_height;
+    if (SDL_GetRendererOutputSize(gRenderer, &output_width, &output_height) != 0) return 1.0f;
+    float scale_x = (float)output_width / (CAMERA_VIEW_WIDTH * TILE_SIZE);
+    float scale_y = (float)output_height / (CAMERA_VIEW_HEIGHT * TILE_SIZE);
+    float scale = scale_x < scale_y ? scale_x : scale_y;
+    if (!scale_linear) scale = scale < 1.0f ? 1.0f : (float)(int)scale;
+    return scale;
+}
+
+// 渲染游戏画面
+void render_game() {
+    GameState current_state = get_game_state();
+    SDL_Texture* frame = scene_target;
+    
+    if (current_state == GAME_STATE_PLAYING) {
+        // 场景画到320x176的目标纹理上，每个方块和精灵都按原始像素大小复制
+        backdrop_state = -1;
+        menu_key = 0;
+        SDL_SetRenderTarget(gRenderer, scene_target);
+        clear_to_sky();
+        render_world();
+        if (!hud_native) {
+            render_hud(current_state);
         }
-    } else if (state == KNIGHT_ANIM_HIT) {
-        if (frame >= 0 && frame < 4) {
-            return player_hit_textures[frame];
+    } else {
+        // 菜单画面：游戏画面只在进入时画一次，菜单只在选项、语言或背景变化时重新合成
+        if (backdrop_state != (int)current_state || backdrop_tick != timer_now()) {
+            capture_backdrop(current_state);
         }
-    } else if (state == KNIGHT_ANIM_DEATH) {
-        if (frame >= 0 && frame < 4) {
-            return player_death_textures[frame];
+        if (hud_native) {
+            frame = backdrop;
+        } else {
+            unsigned int key = current_menu_key(current_state);
+            if (key != menu_key) {
+                SDL_SetRenderTarget(gRenderer, scene_target);
+                SDL_RenderCopy(gRenderer, backdrop, NULL, NULL);
+                render_menu(current_state);
+                menu_key = key;
+            }
         }
     }
-    
-    // 默认返回第一帧idle纹理
-    return player_idle_textures[0];
-}
 
-// 加载敌人动画纹理
-int load_enemy_animations() {
-    char filename[256];
+    // 整个画面放大一次到窗口（逻辑分辨率负责缩放倍数和四周的黑边）
+    SDL_SetRenderTarget(gRenderer, NULL);
+    SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+    SDL_RenderClear(gRenderer);
+    SDL_RenderCopy(gRenderer, frame, NULL, NULL);
     
-    // 加载enemy idle动画帧
-    for (int i = 0; i < 4; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/enemy/enemy_idle%d.png", i + 1);
-        enemy_idle_textures[i] = load_texture_from_file(filename);
-        if (!enemy_idle_textures[i]) {
-            printf("无法加载enemy idle动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
+    // 界面不经过目标纹理，直接画到窗口上：坐标仍是逻辑坐标，文字按放大倍数换大字号
+    // 栅格化，以窗口的原生分辨率绘制（笔画是1个输出像素，而不是放大后的方块）
+    if (hud_native) {
+        set_text_scale(output_scale());
+        render_hud(current_state);
     }
-    
-    // 加载enemy hit动画帧
-    for (int i = 0; i < 4; i++) {
-        snprintf(filename, sizeof(filename), "assets/sprites/enemy/enemy_hit%d.png", i + 1);
-        enemy_hit_textures[i] = load_texture_from_file(filename);
-        if (!enemy_hit_textures[i]) {
-            printf("无法加载enemy hit动画帧 %d: %s\n", i + 1, filename);
-            return 0;
-        }
-    }
-    
-    printf("敌人动画纹理加载成功！(idle: 4帧, hit: 4帧)\n");
-    return 1;
+
+    SDL_RenderPresent(gRenderer);
 }
 
-// 清理敌人动画纹理
-void cleanup_enemy_animations() {
-    // 清理enemy idle动画纹理
-    for (int i = 0; i < 4; i++) {
-        if (enemy_idle_textures[i]) {
-            SDL_DestroyTexture(enemy_idle_textures[i]);
-            enemy_idle_textures[i] = NULL;
-        }
-    }
-    
-    // 清理enemy hit动画纹理
-    for (int i = 0; i < 4; i++) {
-        if (enemy_hit_textures[i]) {
-            SDL_DestroyTexture(enemy_hit_textures[i]);
-            enemy_hit_textures[i] = NULL;
-        }
-    }
+void render_invalidate_cache() {
+    backdrop_state = -1;
+    menu_key = 0;
 }
 
-// 获取指定敌人动画状态和帧的纹理
-SDL_Texture* get_enemy_animation_texture(EnemyAnimationState state, int frame) {
-    if (state == ENEMY_ANIM_IDLE) {
-        if (frame >= 0 && frame < 4) {
-            return enemy_idle_textures[frame];
-        }
-    } else if (state == ENEMY_ANIM_HIT) {
-        if (frame >= 0 && frame < 4) {
-            return enemy_hit_textures[frame];
-        }
+// 释放SDL2资源
+void cleanup_render() {
+    cleanup_textures();  // 清理纹理
+    anim_unload();       // 清理动画图集
+    if (scene_target) {
+        SDL_DestroyTexture(scene_target);
+        scene_target = NULL;
     }
-    
-    // 默认返回第一帧idle纹理
-    return enemy_idle_textures[0];
-} 
\ No newline at end of file
+    if (backdrop) {
+        SDL_DestroyTexture(backdrop);
+        backdrop = NULL;
+    }
+    if (gRenderer) SDL_DestroyRenderer(gRenderer);
+    if (gWindow) SDL_DestroyWindow(gWindow);
+    SDL_Quit();
+    printf("渲染系统已清理！\n");
+}
@@ -9,10 +9,16 @@
 #include "knight.h"
 #include "enemy.h"
 
+// 设置画面放大方式（在init_render之前调用）：linear为1时平滑缩放到窗口，否则整数倍放大；
+// native_hud为1时界面在放大之后直接画到窗口上，文字按窗口原生分辨率栅格化，
+// 否则与场景一起画进目标纹理
+void render_set_scaling(int linear, int native_hud);
 // 初始化SDL2窗口和渲染器
 int init_render();
 // 渲染游戏画面
 void render_game();
+// 丢弃缓存的菜单背景和菜单画面（渲染目标内容丢失时调用）
+void render_invalidate_cache();
 // 释放SDL2资源
 void cleanup_render();
 
@@ -22,16 +28,6 @@ void cleanup_textures();      // 清理纹理资源
 SDL_Texture* get_grass_texture();   // 获取草地纹理
 SDL_Texture* get_mud_texture();     // 获取泥土纹理
 
-// 角色动画纹理管理函数
-int load_player_animations();                              // 加载玩家动画纹理
-void cleanup_player_animations();                          // 清理玩家动画纹理
-SDL_Texture* get_player_animation_texture(KnightAnimationState state, int frame); // 获取指定动画帧纹理
-
-// 敌人动画纹理管理函数
-int load_enemy_animations();                               // 加载敌人动画纹理
-void cleanup_enemy_animations();                           // 清理敌人动画纹理
-SDL_Texture* get_enemy_animation_texture(EnemyAnimationState state, int frame); // 获取指定敌人动画帧纹理
-
 // 提供全局访问的窗口和渲染器指针（可选）
 extern SDL_Window* gWindow;
 extern SDL_Renderer* gRenderer;
@@ -0,0 +1,198 @@
+// replay.c
+// 输入录像系统实现
+
+#include "replay.h"
+#include "input.h"
+#include <stdio.h>
+#include <string.h>
+
+// 按键字母表（下标与InputAction一致）
+static const char key_letters[INPUT_COUNT] = {
+    [INPUT_LEFT]  = 'L',
+    [INPUT_RIGHT] = 'R',
+    [INPUT_JUMP]  = 'J',
+    [INPUT_PAUSE] = 'P',
+    [INPUT_QUIT]  = 'Q',
+    [INPUT_DASH]  = 'D'
+};
+
+// 录制状态
+static FILE* record_file = NULL;
+static unsigned int record_mask = 0;   // 当前行程的按键
+static int record_run = 0;             // 当前行程的帧数
+
+// 播放状态
+static FILE* play_file = NULL;
+static unsigned int play_mask = 0;
+static int play_run = 0;
+
+// 将按键位掩码写成字母串
+static void mask_to_keys(unsigned int mask, char* keys) {
+    int n = 0;
+    for (int i = 0; i < INPUT_COUNT; i++) {
+        if (mask & INPUT_BIT(i)) keys[n++] = key_letters[i];
+    }
+    if (n == 0) keys[n++] = '-';
+    keys[n] = '\0';
+}
+
+// 将字母串解析为按键位掩码（无法识别的字母返回0）
+static int keys_to_mask(const char* keys, unsigned int* mask) {
+    *mask = 0;
+    if (strcmp(keys, "-") == 0) return 1;
+    for (const char* p = keys; *p; p++) {
+        int found = 0;
+        for (int i = 0; i < INPUT_COUNT; i++) {
+            if (key_letters[i] == *p) {
+                *mask |= INPUT_BIT(i);
+                found = 1;
+                break;
+            }
+        }
+        if (!found) return 0;
+    }
+    return 1;
+}
+
+// 从文件读取下一个行程（文件结束返回0）
+static int read_run(FILE* file, unsigned int* mask, int* run) {
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        char keys[16];
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        if (sscanf(line, "%15s %d", keys, run) != 2 || *run <= 0 || !keys_to_mask(keys, mask)) {
+            printf("录像文件格式错误: %s", line);
+            return 0;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+// 写入一个行程
+static void write_run(FILE* file, unsigned int mask, int run) {
+    char keys[INPUT_COUNT + 1];
+    mask_to_keys(mask, keys);
+    fprintf(file, "%s %d\n", keys, run);
+}
+
+// 读取整段录像
+int replay_load(const char* path, unsigned char* masks, int max_ticks) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("无法打开录像文件: %s\n", path);
+        return -1;
+    }
+    
+    int count = 0;
+    unsigned int mask;
+    int run;
+    while (read_run(file, &mask, &run)) {
+        for (int i = 0; i < run && count < max_ticks; i++) {
+            masks[count++] = (unsigned char)mask;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+// 保存整段录像
+int replay_save(const char* path, const unsigned char* masks, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("无法写入录像文件: %s\n", path);
+        return 0;
+    }
+    
+    fprintf(file, "# knight replay v1\n");
+    int i = 0;
+    while (i < count) {
+        int run = 1;
+        while (i + run < count && masks[i + run] == masks[i]) run++;
+        write_run(file, masks[i], run);
+        i += run;
+    }
+    fclose(file);
+    return 1;
+}
+
+// 开始录制
+int replay_record_begin(const char* path) {
+    replay_record_end();
+    record_file = fopen(path, "w");
+    if (!record_file) {
+        printf("无法写入录像文件: %s\n", path);
+        return 0;
+    }
+    fprintf(record_file, "# knight replay v1\n");
+    record_run = 0;
+    return 1;
+}
+
+// 记录一帧
+void replay_record_tick(unsigned int mask) {
+    if (!record_file) return;
+    
+    if (record_run > 0 && mask != record_mask) {
+        write_run(record_file, record_mask, record_run);
+        record_run = 0;
+    }
+    record_mask = mask;
+    record_run++;
+}
+
+// 结束录制
+void replay_record_end() {
+    if (!record_file) return;
+    
+    if (record_run > 0) {
+        write_run(record_file, record_mask, record_run);
+    }
+    fclose(record_file);
+    record_file = NULL;
+    record_run = 0;
+}
+
+// 是否正在录制
+int replay_is_recording() {
+    return record_file != NULL;
+}
+
+// 开始播放
+int replay_play_begin(const char* path) {
+    replay_play_end();
+    play_file = fopen(path, "r");
+    if (!play_file) {
+        printf("无法打开录像文件: %s\n", path);
+        return 0;
+    }
+    play_run = 0;
+    return 1;
+}
+
+// 读取下一帧按键
+int replay_play_next(unsigned int* mask) {
+    if (!play_file) return 0;
+    
+    if (play_run == 0 && !read_run(play_file, &play_mask, &play_run)) {
+        replay_play_end();
+        return 0;
+    }
+    play_run--;
+    *mask = play_mask;
+    return 1;
+}
+
+// 结束播放
+void replay_play_end() {
+    if (play_file) {
+        fclose(play_file);
+        play_file = NULL;
+    }
+    play_run = 0;
+}
+
+// 是否正在播放
+int replay_is_playing() {
+    return play_file != NULL;
+}
@@ -0,0 +1,29 @@
+// replay.h
+// 输入录像系统头文件（逐帧记录按键位掩码，用于回放和物理行为回归检查）
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// 录像文件为文本格式，每行 "<按键> <帧数>"（行程编码）
+// 按键用字母表示：L=左 R=右 J=跳跃 P=暂停 Q=退出 D=冲刺，'-'表示无按键
+// 以'#'开头的行为注释
+
+#define REPLAY_MAX_TICKS (60 * 60 * 30) // 最长30分钟
+
+// 整段读写（供离线工具使用）
+int replay_load(const char* path, unsigned char* masks, int max_ticks); // 读取录像，返回帧数（失败返回-1）
+int replay_save(const char* path, const unsigned char* masks, int count); // 保存录像，成功返回1
+
+// 流式录制（游戏运行时使用，不占用额外内存）
+int replay_record_begin(const char* path);   // 开始录制（覆盖已有文件）
+void replay_record_tick(unsigned int mask);  // 记录一帧的按键状态
+void replay_record_end();                    // 结束录制并写入文件
+int replay_is_recording();                   // 是否正在录制
+
+// 流式播放
+int replay_play_begin(const char* path);     // 开始播放
+int replay_play_next(unsigned int* mask);    // 读取下一帧按键（播放结束返回0）
+void replay_play_end();                      // 结束播放
+int replay_is_playing();                     // 是否正在播放
+
+#endif // REPLAY_H
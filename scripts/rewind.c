@@ -0,0 +1,225 @@
+// rewind.c
+// 时间回溯实现
+//
+// 每帧先用snapshot_save得到完整快照。关键帧直接保存快照本身，
+// 其余帧保存与所属关键帧的异或结果——相邻帧之间大部分字节不变，异或后几乎全是0，
+// 再用零行程编码压缩，一帧通常只有几十字节。
+// 压缩数据依次写入一个环形字节缓冲区，空间不足时从最旧的关键帧组开始丢弃。
+
+#include "rewind.h"
+#include "snapshot.h"
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+// 单帧索引
+typedef struct {
+    unsigned int offset;     // 压缩数据在环形缓冲区中的位置
+    unsigned int length;     // 压缩后长度
+    unsigned int raw_size;   // 快照原始长度
+    int keyframe;            // 所属关键帧的帧序号（关键帧为自身）
+} RewindFrame;
+
+static unsigned char data[REWIND_BUFFER_BYTES];
+static RewindFrame frames[REWIND_MAX_FRAMES];
+static int first_frame = 0;  // 最旧一帧的帧序号（帧序号单调递增，下标为序号对容量取模）
+static int frame_end = 0;    // 最新一帧的帧序号+1
+
+// 编码/解码用的临时缓冲区
+static unsigned char current[SNAPSHOT_MAX_SIZE];
+static unsigned char keyframe_raw[SNAPSHOT_MAX_SIZE];
+static int keyframe_raw_index = -1;        // keyframe_raw中缓存的是哪个关键帧
+static unsigned char encoded[SNAPSHOT_MAX_SIZE * 2];
+static unsigned char decoded[SNAPSHOT_MAX_SIZE];
+
+// 恢复耗时统计
+static double restore_total_us = 0.0;
+static double restore_max_us = 0.0;
+static unsigned int restore_count = 0;
+
+#define FRAME(index) (&frames[(index) % REWIND_MAX_FRAMES])
+
+// 零行程编码：重复 [0的个数(2字节)] [非零段长度(2字节)] [非零段数据]
+static unsigned int encode_zero_rle(const unsigned char* in, unsigned int size, unsigned char* out) {
+    unsigned int pos = 0, written = 0;
+    while (pos < size) {
+        unsigned int zeros = 0;
+        while (pos + zeros < size && in[pos + zeros] == 0) zeros++;
+        pos += zeros;
+        
+        unsigned int literal = 0;
+        while (pos + literal < size && in[pos + literal] != 0) literal++;
+        
+        out[written++] = (unsigned char)(zeros & 0xFF);
+        out[written++] = (unsigned char)(zeros >> 8);
+        out[written++] = (unsigned char)(literal & 0xFF);
+        out[written++] = (unsigned char)(literal >> 8);
+        memcpy(out + written, in + pos, literal);
+        written += literal;
+        pos += literal;
+    }
+    return written;
+}
+
+static void decode_zero_rle(const unsigned char* in, unsigned int length, unsigned char* out) {
+    unsigned int pos = 0, written = 0;
+    while (pos < length) {
+        unsigned int zeros = in[pos] | (in[pos + 1] << 8);
+        unsigned int literal = in[pos + 2] | (in[pos + 3] << 8);
+        pos += 4;
+        memset(out + written, 0, zeros);
+        written += zeros;
+        memcpy(out + written, in + pos, literal);
+        written += literal;
+        pos += literal;
+    }
+}
+
+// 丢弃最旧的一整组（关键帧及其后的差分帧）
+static void drop_oldest_group() {
+    first_frame++;
+    while (first_frame < frame_end && FRAME(first_frame)->keyframe != first_frame) {
+        first_frame++;
+    }
+}
+
+// 在环形缓冲区中为新数据找位置（必要时丢弃旧帧），返回写入位置
+static unsigned int reserve_space(unsigned int length) {
+    unsigned int offset = 0;
+    if (frame_end > first_frame) {
+        const RewindFrame* newest = FRAME(frame_end - 1);
+        offset = newest->offset + newest->length;
+        if (offset + length > REWIND_BUFFER_BYTES) {
+            // 剩余空间不足，回到缓冲区开头；末尾剩下的都是最旧的帧，一并丢弃
+            unsigned int newest_end = offset;
+            offset = 0;
+            while (first_frame < frame_end && FRAME(first_frame)->offset >= newest_end) {
+                drop_oldest_group();
+            }
+        }
+    }
+    
+    // 丢弃与新数据区域重叠的旧帧（旧帧按写入顺序排列，只需检查最旧的一帧）
+    while (first_frame < frame_end) {
+        const RewindFrame* oldest = FRAME(first_frame);
+        int overlaps = oldest->offset < offset + length && offset < oldest->offset + oldest->length;
+        if (!overlaps && frame_end - first_frame < REWIND_MAX_FRAMES) break;
+        drop_oldest_group();
+    }
+    return offset;
+}
+
+// 解码指定帧的完整快照到decoded
+static void decode_frame(int index) {
+    const RewindFrame* frame = FRAME(index);
+    if (frame->keyframe == index) {
+        decode_zero_rle(data + frame->offset, frame->length, decoded);
+        return;
+    }
+    
+    // 差分帧：先取得关键帧原文（连续回溯时关键帧通常已缓存）
+    if (keyframe_raw_index != frame->keyframe) {
+        const RewindFrame* key = FRAME(frame->keyframe);
+        decode_zero_rle(data + key->offset, key->length, keyframe_raw);
+        keyframe_raw_index = frame->keyframe;
+    }
+    decode_zero_rle(data + frame->offset, frame->length, decoded);
+    for (unsigned int i = 0; i < frame->raw_size; i++) {
+        decoded[i] ^= keyframe_raw[i];
+    }
+}
+
+// 清空历史
+void rewind_reset() {
+    first_frame = 0;
+    frame_end = 0;
+    keyframe_raw_index = -1;
+}
+
+// 保存当前世界状态
+void rewind_push() {
+    unsigned int size = (unsigned int)snapshot_save(current, sizeof(current));
+    if (size == 0) return;
+    
+    // 决定是关键帧还是差分帧：间隔到了、所属关键帧已被丢弃或快照长度变化时保存关键帧
+    int index = frame_end;
+    int keyframe = index;
+    if (frame_end > first_frame) {
+        const RewindFrame* previous = FRAME(frame_end - 1);
+        int key = previous->keyframe;
+        if (key >= first_frame && index - key < REWIND_KEYFRAME_INTERVAL && FRAME(key)->raw_size == size) {
+            keyframe = key;
+        }
+    }
+    
+    unsigned int length;
+    if (keyframe == index) {
+        length = encode_zero_rle(current, size, encoded);
+        memcpy(keyframe_raw, current, size);
+    } else {
+        if (keyframe_raw_index != keyframe) {
+            const RewindFrame* key = FRAME(keyframe);
+            decode_zero_rle(data + key->offset, key->length, keyframe_raw);
+        }
+        for (unsigned int i = 0; i < size; i++) {
+            current[i] ^= keyframe_raw[i];
+        }
+        length = encode_zero_rle(current, size, encoded);
+    }
+    keyframe_raw_index = keyframe;
+    
+    unsigned int offset = reserve_space(length);
+    if (keyframe != index && first_frame > keyframe) {
+        // 所属关键帧刚被挤出缓冲区（只在缓冲区极小时发生），这一帧无法保存
+        rewind_reset();
+        return;
+    }
+    memcpy(data + offset, encoded, length);
+    
+    RewindFrame* frame = FRAME(index);
+    frame->offset = offset;
+    frame->length = length;
+    frame->raw_size = size;
+    frame->keyframe = keyframe;
+    frame_end++;
+}
+
+// 丢弃最新一帧并恢复到前一帧
+int rewind_step_back() {
+    if (frame_end - first_frame < 2) return 0;
+    
+    Uint64 start = SDL_GetPerformanceCounter();
+    frame_end--;
+    decode_frame(frame_end - 1);
+    snapshot_load(decoded, FRAME(frame_end - 1)->raw_size);
+    Uint64 end = SDL_GetPerformanceCounter();
+    
+    double us = (double)(end - start) * 1e6 / (double)SDL_GetPerformanceFrequency();
+    restore_total_us += us;
+    if (us > restore_max_us) restore_max_us = us;
+    restore_count++;
+    return 1;
+}
+
+// 获取统计信息
+void rewind_get_stats(RewindStats* stats) {
+    stats->frames = frame_end - first_frame;
+    stats->seconds = stats->frames / 60.0f;
+    stats->bytes_used = 0;
+    for (int i = first_frame; i < frame_end; i++) {
+        stats->bytes_used += FRAME(i)->length;
+    }
+    stats->bytes_per_second = stats->frames > 0 ? stats->bytes_used * 60.0f / stats->frames : 0.0f;
+    stats->average_restore_us = restore_count > 0 ? (float)(restore_total_us / restore_count) : 0.0f;
+    stats->max_restore_us = (float)restore_max_us;
+}
+
+// 打印统计信息
+void rewind_report() {
+    RewindStats stats;
+    rewind_get_stats(&stats);
+    printf("时间回溯：保存 %d 帧（%.1f 秒），占用 %u 字节，平均 %.0f 字节/秒；恢复 %u 次，平均 %.2f us，最长 %.2f us\n",
+           stats.frames, stats.seconds, stats.bytes_used, stats.bytes_per_second,
+           restore_count, stats.average_restore_us, stats.max_restore_us);
+}
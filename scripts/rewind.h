@@ -0,0 +1,28 @@
+// rewind.h
+// 时间回溯头文件（逐帧保存世界状态，按住按键倒放最近一段游戏过程）
+
+#ifndef REWIND_H
+#define REWIND_H
+
+#define REWIND_MAX_SECONDS 30                   // 最多保留的历史时长
+#define REWIND_MAX_FRAMES (60 * REWIND_MAX_SECONDS)
+#define REWIND_BUFFER_BYTES (2 * 1024 * 1024)   // 压缩后历史数据的内存上限
+#define REWIND_KEYFRAME_INTERVAL 60             // 每隔多少帧保存一个完整关键帧
+
+// 历史统计信息
+typedef struct {
+    int frames;                  // 当前保存的帧数
+    float seconds;               // 当前可回溯的时长
+    unsigned int bytes_used;     // 当前占用的压缩数据字节数
+    float bytes_per_second;      // 每秒历史平均占用字节数
+    float average_restore_us;    // 平均恢复耗时（微秒）
+    float max_restore_us;        // 最大恢复耗时（微秒）
+} RewindStats;
+
+void rewind_reset();             // 清空历史（每局开始时调用）
+void rewind_push();              // 保存当前世界状态（每个逻辑帧结束后调用）
+int rewind_step_back();          // 丢弃最新一帧并恢复到前一帧，没有更早的历史时返回0
+void rewind_get_stats(RewindStats* stats); // 获取统计信息
+void rewind_report();            // 打印统计信息
+
+#endif // REWIND_H
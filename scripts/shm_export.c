@@ -0,0 +1,149 @@
+// shm_export.c
+// 共享内存状态导出实现（POSIX共享内存，Windows上暂不支持）
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "shm_export.h"
+#include "game.h"
+#include "knight.h"
+#include "enemy.h"
+#include "camera.h"
+#include "ui.h"
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 编译期检查：导出的敌人数组能容纳所有敌人
+typedef char shm_enemy_check[(SHM_EXPORT_MAX_ENEMIES >= MAX_ENEMIES) ? 1 : -1];
+
+static ShmRegion* region = NULL;
+static char region_name[64];
+
+// 按键接管通道最近一次读到的一致数据（读到正在写入的数据时沿用）
+static uint32_t override_active = 0;
+static uint32_t override_mask = 0;
+
+#ifndef _WIN32
+// 创建共享内存
+int shm_export_begin(const char* name) {
+    snprintf(region_name, sizeof(region_name), "/%s", name[0] == '/' ? name + 1 : name);
+
+    int fd = shm_open(region_name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        printf("无法创建共享内存: %s\n", region_name);
+        return 0;
+    }
+    if (ftruncate(fd, sizeof(ShmRegion)) != 0) {
+        printf("无法设置共享内存大小: %s\n", region_name);
+        close(fd);
+        shm_unlink(region_name);
+        return 0;
+    }
+    void* memory = mmap(NULL, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        printf("无法映射共享内存: %s\n", region_name);
+        shm_unlink(region_name);
+        return 0;
+    }
+
+    region = (ShmRegion*)memory;
+    memset(region, 0, sizeof(ShmRegion));
+    region->version = SHM_EXPORT_VERSION;
+    region->header_size = sizeof(ShmRegion);
+    region->ring_size = SHM_EXPORT_RING;
+    region->writer_pid = (uint32_t)getpid();
+    __atomic_store_n(&region->magic, SHM_EXPORT_MAGIC, __ATOMIC_RELEASE); // 最后写入，读取方据此判断已初始化
+    override_active = 0;
+    printf("状态导出到共享内存: /dev/shm%s\n", region_name);
+    return 1;
+}
+
+// 解除映射并删除共享内存
+void shm_export_end() {
+    if (!region) return;
+    munmap(region, sizeof(ShmRegion));
+    shm_unlink(region_name);
+    region = NULL;
+}
+#else
+int shm_export_begin(const char* name) {
+    (void)name;
+    printf("共享内存状态导出目前只支持Linux和macOS\n");
+    return 0;
+}
+
+void shm_export_end() {}
+#endif
+
+// 发布当前世界状态
+void shm_export_publish(unsigned int input_mask) {
+    if (!region) return;
+
+    // 先在本地组装一帧，写入槽位时只做一次复制，缩短读取方看到奇数序号的时间
+    ShmFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.tick = game_get_tick();
+    frame.game_state = (uint32_t)get_game_state();
+    frame.input_mask = input_mask;
+    frame.lives = knight.lives;
+    frame.knight_x = knight.x;
+    frame.knight_y = knight.y;
+    frame.knight_vx = knight.vx;
+    frame.knight_vy = knight.vy;
+    frame.on_ground = knight.on_ground;
+    frame.facing_right = knight.facing_right;
+    frame.is_dashing = knight.is_dashing;
+    frame.anim_state = (int32_t)knight.anim_state;
+    frame.camera_x = camera.x;
+    frame.camera_y = camera.y;
+    frame.enemy_count = (uint32_t)enemy_count;
+    for (int i = 0; i < enemy_count; i++) {
+        ShmEnemy* out = &frame.enemies[i];
+        out->x = enemies[i].x;
+        out->y = enemies[i].y;
+        out->vx = enemies[i].vx;
+        out->vy = enemies[i].vy;
+        out->alive = enemies[i].alive;
+        out->state = (int32_t)enemies[i].state;
+    }
+
+    // 只有游戏一个写入方，published和seq不需要原子读改写
+    uint64_t index = region->published;
+    ShmSlot* slot = &region->slots[index % SHM_EXPORT_RING];
+    uint32_t seq = slot->seq;
+    __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&slot->frame, &frame, sizeof(frame));
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&region->published, index + 1, __ATOMIC_RELEASE);
+}
+
+// 读取按键接管通道（只尝试一次，不等待外部程序写完）
+int shm_export_read_override(unsigned int* mask) {
+    if (!region) return 0;
+
+    ShmOverride* channel = &region->input_override;
+    uint32_t before = __atomic_load_n(&channel->seq, __ATOMIC_ACQUIRE);
+    uint32_t active = __atomic_load_n(&channel->active, __ATOMIC_RELAXED);
+    uint32_t value = __atomic_load_n(&channel->mask, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t after = __atomic_load_n(&channel->seq, __ATOMIC_RELAXED);
+    if (before == after && (before & 1) == 0) {
+        override_active = active;
+        override_mask = value;
+    }
+
+    if (override_active) {
+        *mask = override_mask;
+    }
+    return override_active != 0;
+}
@@ -0,0 +1,82 @@
+// shm_export.h
+// 共享内存状态导出头文件（外部可视化工具和机器人读取每帧状态、接管按键）
+//
+// 游戏把每个逻辑帧的骑士、敌人和摄像机状态写入/dev/shm下的环形缓冲区（POSIX共享内存），
+// 每个槽位用顺序锁（seqlock）保护：写入前序号加1变为奇数，写完再加1变为偶数。
+// 读取方先读序号（奇数表示正在写入），复制数据后再读一次序号，两次相同且为偶数才有效，
+// 否则丢弃重读。写入方从不等待读取方，读取方再慢也不会拖慢游戏。
+//
+// 按键接管通道使用同样的协议，方向相反：外部程序写入，游戏每帧尝试读取一次，
+// 读到不一致的数据时沿用上一次的结果。
+//
+// 本头文件只依赖<stdint.h>，外部工具可以直接包含。所有字段按本机字节序。
+
+#ifndef SHM_EXPORT_H
+#define SHM_EXPORT_H
+
+#include <stdint.h>
+
+#define SHM_EXPORT_MAGIC 0x4D48534Bu  // "KSHM"
+#define SHM_EXPORT_VERSION 1
+#define SHM_EXPORT_RING 64            // 环形缓冲区保存的帧数
+#define SHM_EXPORT_MAX_ENEMIES 20     // 与MAX_ENEMIES相同
+
+typedef struct {
+    float x, y;
+    float vx, vy;
+    int32_t alive;
+    int32_t state;           // EnemyState
+} ShmEnemy;
+
+// 一个逻辑帧结束时的状态
+typedef struct {
+    uint32_t tick;           // 逻辑帧计数
+    uint32_t game_state;     // GameState
+    uint32_t input_mask;     // 这一帧使用的按键（INPUT_BIT位掩码）
+    int32_t lives;
+    float knight_x, knight_y;
+    float knight_vx, knight_vy;
+    int32_t on_ground;
+    int32_t facing_right;
+    int32_t is_dashing;
+    int32_t anim_state;      // KnightAnimationState
+    float camera_x, camera_y;
+    uint32_t enemy_count;
+    uint32_t reserved;
+    ShmEnemy enemies[SHM_EXPORT_MAX_ENEMIES];
+} ShmFrame;
+
+typedef struct {
+    uint32_t seq;            // 顺序锁序号（奇数表示正在写入）
+    uint32_t reserved;
+    ShmFrame frame;
+} ShmSlot;
+
+// 按键接管通道（由外部程序写入）
+typedef struct {
+    uint32_t seq;            // 顺序锁序号
+    uint32_t active;         // 非0时用mask代替键盘按键
+    uint32_t mask;           // INPUT_BIT位掩码
+    uint32_t reserved;
+} ShmOverride;
+
+// 共享内存整体布局
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;    // sizeof(ShmRegion)，读取方用来检查布局是否一致
+    uint32_t ring_size;      // SHM_EXPORT_RING
+    uint64_t published;      // 已发布的帧数，最新一帧在slots[(published-1) % ring_size]
+    uint32_t writer_pid;
+    uint32_t reserved;
+    ShmOverride input_override;
+    ShmSlot slots[SHM_EXPORT_RING];
+} ShmRegion;
+
+// 游戏端接口（name为共享内存名称，例如"knight"对应/dev/shm/knight）
+int shm_export_begin(const char* name);   // 创建共享内存，成功返回1
+void shm_export_end();                    // 解除映射并删除共享内存
+void shm_export_publish(unsigned int input_mask); // 发布当前世界状态（每个逻辑帧结束后调用）
+int shm_export_read_override(unsigned int* mask); // 外部程序接管按键时返回1并写入mask
+
+#endif // SHM_EXPORT_H
@@ -0,0 +1,174 @@
+// snapshot.c
+// 完整游戏状态快照实现
+//
+// 布局：文件头 | 固定部分（SnapshotFixed） | 敌人数组（enemy_count项） | 地图改动记录
+// 所有结构体都只包含定长数值字段，整块按字节复制即可保存和恢复。
+
+#include "snapshot.h"
+#include "knight.h"
+#include "enemy.h"
+#include "spawn.h"
+#include "map.h"
+#include "camera.h"
+#include "input.h"
+#include "game.h"
+#include "ui.h"
+#include "replay.h"
+#include "statehash.h"
+#include "netplay.h"
+#include "endless.h"
+#include "tilepage.h"
+#include <stdint.h>
+#include <string.h>
+
+#define SNAPSHOT_MAGIC 0x4B534E50u  // "PNSK"
+#define SNAPSHOT_VERSION 4
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t total_size;          // 快照总字节数
+    uint16_t enemy_count;
+    uint16_t mutation_count;
+    uint16_t spawn_count;         // 出生点数量（"已消灭"标记位数）
+} SnapshotHeader;
+
+// 定长部分
+typedef struct {
+    Knight knight;
+    KnightProgress progress;
+    Camera camera;
+    float camera_offset_x;
+    UiState ui;
+    GameCounters counters;
+    unsigned int previous_input;
+} SnapshotFixed;
+
+// 编译期检查：最坏情况下的快照大小不超过SNAPSHOT_MAX_SIZE
+typedef char snapshot_size_check[(sizeof(SnapshotHeader) + sizeof(SnapshotFixed) +
+                                  sizeof(Enemy) * MAX_ENEMIES +
+                                  sizeof(MapMutation) * MAP_MUTATION_MAX +
+                                  (SPAWN_SNAPSHOT_MAX + 7) / 8 <= SNAPSHOT_MAX_SIZE) ? 1 : -1];
+
+// 快速存档槽
+static unsigned char slots[QUICKSAVE_SLOT_COUNT][SNAPSHOT_MAX_SIZE];
+static size_t slot_sizes[QUICKSAVE_SLOT_COUNT];
+
+// 保存当前状态
+size_t snapshot_save(void* buffer, size_t capacity) {
+    const MapMutation* mutations;
+    int mutation_count = map_get_mutations(&mutations);
+    unsigned char killed_bits[(SPAWN_SNAPSHOT_MAX + 7) / 8];
+    int spawn_count = spawn_save_killed(killed_bits);
+    if (spawn_count < 0) {
+        return 0;
+    }
+    
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.header_size = sizeof(SnapshotHeader);
+    header.enemy_count = (uint16_t)enemy_count;
+    header.mutation_count = (uint16_t)mutation_count;
+    header.spawn_count = (uint16_t)spawn_count;
+    header.total_size = (uint32_t)(sizeof(SnapshotHeader) + sizeof(SnapshotFixed) +
+                                   sizeof(Enemy) * enemy_count +
+                                   sizeof(MapMutation) * mutation_count +
+                                   (spawn_count + 7) / 8);
+    if (header.total_size > capacity) {
+        return 0;
+    }
+    
+    unsigned char* out = (unsigned char*)buffer;
+    memcpy(out, &header, sizeof(header));
+    
+    // 定长部分先在局部变量中组装，再整体复制（不要求缓冲区对齐）
+    SnapshotFixed fixed;
+    memset(&fixed, 0, sizeof(fixed));
+    fixed.knight = knight;
+    knight_get_progress(&fixed.progress);
+    fixed.camera = camera;
+    fixed.camera_offset_x = camera_offset_x;
+    get_ui_state(&fixed.ui);
+    game_get_counters(&fixed.counters);
+    fixed.previous_input = get_previous_input_mask();
+    memcpy(out + sizeof(SnapshotHeader), &fixed, sizeof(fixed));
+    
+    unsigned char* cursor = out + sizeof(SnapshotHeader) + sizeof(SnapshotFixed);
+    memcpy(cursor, enemies, sizeof(Enemy) * enemy_count);
+    cursor += sizeof(Enemy) * enemy_count;
+    memcpy(cursor, mutations, sizeof(MapMutation) * mutation_count);
+    cursor += sizeof(MapMutation) * mutation_count;
+    memcpy(cursor, killed_bits, (size_t)(spawn_count + 7) / 8);
+    
+    return header.total_size;
+}
+
+// 恢复状态
+int snapshot_load(const void* buffer, size_t size) {
+    const unsigned char* in = (const unsigned char*)buffer;
+    SnapshotHeader header;
+    if (size < sizeof(SnapshotHeader)) return 0;
+    memcpy(&header, in, sizeof(header));
+    
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        header.header_size != sizeof(SnapshotHeader) || header.total_size > size ||
+        header.enemy_count > MAX_ENEMIES || header.mutation_count > MAP_MUTATION_MAX ||
+        header.spawn_count != spawn_get_count() ||
+        header.total_size != sizeof(SnapshotHeader) + sizeof(SnapshotFixed) +
+                             sizeof(Enemy) * header.enemy_count +
+                             sizeof(MapMutation) * header.mutation_count +
+                             (header.spawn_count + 7) / 8) {
+        return 0;
+    }
+    
+    SnapshotFixed fixed;
+    memcpy(&fixed, in + sizeof(SnapshotHeader), sizeof(fixed));
+    const unsigned char* cursor = in + sizeof(SnapshotHeader) + sizeof(SnapshotFixed);
+    
+    enemy_count = header.enemy_count;
+    memcpy(enemies, cursor, sizeof(Enemy) * header.enemy_count);
+    cursor += sizeof(Enemy) * header.enemy_count;
+    
+    MapMutation mutations[MAP_MUTATION_MAX];
+    memcpy(mutations, cursor, sizeof(MapMutation) * header.mutation_count);
+    map_restore_mutations(mutations, header.mutation_count);
+    cursor += sizeof(MapMutation) * header.mutation_count;
+    spawn_load_killed(cursor, header.spawn_count);
+    
+    knight = fixed.knight;
+    knight_set_progress(&fixed.progress);
+    camera = fixed.camera;
+    camera_offset_x = fixed.camera_offset_x;
+    spawn_resync(); // 出生点是否已有敌人由spawn_id推导，只需按摄像机位置重新定位游标
+    set_ui_state(&fixed.ui);
+    set_previous_input_mask(fixed.previous_input);
+    game_set_counters(&fixed.counters); // 最后恢复，会重新计算世界状态哈希
+    return 1;
+}
+
+// 保存到快速存档槽
+int quicksave_save(int slot) {
+    if (slot < 0 || slot >= QUICKSAVE_SLOT_COUNT) return 0;
+    slot_sizes[slot] = snapshot_save(slots[slot], SNAPSHOT_MAX_SIZE);
+    return slot_sizes[slot] > 0;
+}
+
+// 从快速存档槽恢复
+int quicksave_load(int slot) {
+    if (!quicksave_is_used(slot)) return 0;
+    return snapshot_load(slots[slot], slot_sizes[slot]);
+}
+
+// 槽位是否有存档
+int quicksave_is_used(int slot) {
+    return slot >= 0 && slot < QUICKSAVE_SLOT_COUNT && slot_sizes[slot] > 0;
+}
+
+// 是否可以恢复较早的快照
+int snapshot_can_restore() {
+    return !replay_is_recording() && !replay_is_playing() && !statehash_log_is_open() &&
+           !netplay_is_active() && !endless_is_active() && !tilepage_is_open();
+}
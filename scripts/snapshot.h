@@ -0,0 +1,28 @@
+// snapshot.h
+// 完整游戏状态快照头文件（快速存档/读档）
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+
+// 快照是一块连续的、不含指针的内存（可以直接复制、写入文件或通过网络发送），
+// 包括骑士、关卡进度、敌人、出生点的消灭标记、地图改动、摄像机、UI状态和逻辑帧计数。
+// 按键的当前状态属于输入而不是状态，不包含在快照中；上一帧按键（"刚按下"判断）包含在内。
+#define SNAPSHOT_MAX_SIZE 4096
+
+size_t snapshot_save(void* buffer, size_t capacity); // 保存当前状态，返回写入字节数（空间不足返回0）
+int snapshot_load(const void* buffer, size_t size);  // 恢复状态，成功返回1（数据无效时不修改任何状态）
+
+// 是否可以把世界恢复到较早的快照（时间回溯和读档）。恢复会把逻辑帧计数倒回去，
+// 录像、回放和哈希日志都按逻辑帧顺序读写，会与模拟错开；联机、无限模式和分页关卡的
+// 状态不在快照中。这些情况下返回0
+int snapshot_can_restore();
+
+// 快速存档槽
+#define QUICKSAVE_SLOT_COUNT 4
+int quicksave_save(int slot);    // 保存到槽位，成功返回1
+int quicksave_load(int slot);    // 从槽位恢复，槽位为空返回0
+int quicksave_is_used(int slot); // 槽位是否有存档
+
+#endif // SNAPSHOT_H
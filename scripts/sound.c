@@ -2,6 +2,8 @@
 // 音效系统实现
 
 #include "sound.h"
+#include "log.h"
+#include "game.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -98,11 +100,12 @@ void cleanup_sound_system() {
 // 播放指定音效
 void play_sound(SoundEffect sound) {
     if (!sound_system_initialized) return;
+    if (game_is_resimulating()) return; // 回滚重算时音效已经播放过
     
     if (sound >= 0 && sound < SOUND_COUNT && sound_effects[sound]) {
         // 在任意可用通道播放音效
         if (Mix_PlayChannel(-1, sound_effects[sound], 0) == -1) {
-            printf("播放音效失败: %s\n", Mix_GetError());
+            LOG_WARN("播放音效失败: %s", Mix_GetError());
         }
     }
 }
@@ -114,9 +117,9 @@ void play_background_music() {
     if (!Mix_PlayingMusic()) {
         // 循环播放背景音乐 (-1 表示无限循环)
         if (Mix_PlayMusic(background_music, -1) == -1) {
-            printf("播放背景音乐失败: %s\n", Mix_GetError());
+            LOG_WARN("播放背景音乐失败: %s", Mix_GetError());
         } else {
-            printf("开始播放背景音乐\n");
+            LOG_DEBUG("开始播放背景音乐");
         }
     }
 }
@@ -126,7 +129,7 @@ void stop_background_music() {
     if (!sound_system_initialized) return;
     
     Mix_HaltMusic();
-    printf("背景音乐已停止\n");
+    LOG_DEBUG("背景音乐已停止");
 }
 
 // 暂停背景音乐
@@ -135,7 +138,7 @@ void pause_background_music() {
     
     if (Mix_PlayingMusic() && !Mix_PausedMusic()) {
         Mix_PauseMusic();
-        printf("背景音乐已暂停\n");
+        LOG_DEBUG("背景音乐已暂停");
     }
 }
 
@@ -145,7 +148,7 @@ void resume_background_music() {
     
     if (Mix_PausedMusic()) {
         Mix_ResumeMusic();
-        printf("背景音乐已恢复\n");
+        LOG_DEBUG("背景音乐已恢复");
     }
 }
 
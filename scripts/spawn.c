@@ -0,0 +1,196 @@
+// spawn.c
+// 敌人出生点索引实现
+
+#include "spawn.h"
+#include "camera.h"
+#include "tilepage.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SPAWN_TILE_SIZE 16
+
+// 出生点数组（按x坐标从小到大排列，容量只增不减，重置时不重新分配）
+static WORLD_LOCAL SpawnPoint* points = NULL;
+static WORLD_LOCAL int point_count = 0;
+static WORLD_LOCAL int point_capacity = 0;
+
+// 激活范围在数组中的位置：[first_inside, end_inside)中的出生点在范围内
+static WORLD_LOCAL int first_inside = 0;   // 第一个x不小于左边界的出生点
+static WORLD_LOCAL int end_inside = 0;     // 第一个x大于右边界的出生点
+
+static void push_point(EnemyType type, float x, float y) {
+    if (point_count == point_capacity) {
+        int capacity = point_capacity ? point_capacity * 2 : 64;
+        SpawnPoint* grown = (SpawnPoint*)realloc(points, sizeof(SpawnPoint) * (size_t)capacity);
+        if (!grown) {
+            LOG_ERROR("无法扩展敌人出生点索引");
+            return;
+        }
+        points = grown;
+        point_capacity = capacity;
+    }
+    SpawnPoint* point = &points[point_count++];
+    point->x = x;
+    point->y = y;
+    point->type = type;
+    point->killed = 0;
+}
+
+// 扫描当前关卡，按列收集敌人标记（同一列从上到下），得到的数组天然按x排序
+void spawn_build_index() {
+    point_count = 0;
+    first_inside = 0;
+    end_inside = 0;
+    enemy_count = 0;
+
+    if (tilepage_is_open()) {
+        // 分页关卡：敌人标记不会被渲染也不参与碰撞，不改动关卡
+        int width = tilepage_width();
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < MAP_HEIGHT; y++) {
+                if (tilepage_get(x, y) == TILE_CODE_ENEMY) {
+                    push_point(ENEMY_GOOMBA, (float)(x * SPAWN_TILE_SIZE), (float)(y * SPAWN_TILE_SIZE));
+                }
+            }
+        }
+        return;
+    }
+
+    for (int x = 0; x < MAP_WIDTH; x++) {
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            if (game_map[y][x] == 'E') {
+                push_point(ENEMY_GOOMBA, (float)(x * SPAWN_TILE_SIZE), (float)(y * SPAWN_TILE_SIZE));
+                // 将地图中的敌人标记替换为空地，避免渲染时显示
+                map_set_tile(x, y, ' ');
+            }
+        }
+    }
+}
+
+void spawn_append(EnemyType type, float x, float y) {
+    push_point(type, x, y);
+}
+
+// 出生点平移；移出地图左侧的出生点在数组开头，整体删除后修正敌人记录的编号
+void spawn_shift_x(float dx) {
+    int removed = 0;
+    for (int i = 0; i < point_count; i++) {
+        points[i].x += dx;
+        if (points[i].x < 0) removed = i + 1;
+    }
+    if (removed == 0) return;
+    memmove(points, points + removed, sizeof(SpawnPoint) * (size_t)(point_count - removed));
+    point_count -= removed;
+    first_inside = first_inside > removed ? first_inside - removed : 0;
+    end_inside = end_inside > removed ? end_inside - removed : 0;
+    for (int i = 0; i < enemy_count; i++) {
+        if (enemies[i].spawn_id >= 0) {
+            enemies[i].spawn_id = enemies[i].spawn_id >= removed ? enemies[i].spawn_id - removed : -1;
+        }
+    }
+}
+
+// 当前激活范围
+static void activate_range(float* left, float* right) {
+    *left = camera.x - SPAWN_ACTIVATE_MARGIN;
+    *right = camera.x + CAMERA_LOGICAL_WIDTH + SPAWN_ACTIVATE_MARGIN;
+}
+
+// 出生点进入激活范围：还没有对应的敌人时创建
+static void activate(int index) {
+    if (points[index].killed) return;
+    for (int i = 0; i < enemy_count; i++) {
+        if (enemies[i].spawn_id == index) return;
+    }
+    if (enemy_count >= MAX_ENEMIES) {
+        LOG_WARN("敌人数量已达到最大值，出生点%d暂不激活", index);
+        return;
+    }
+    add_enemy(points[index].type, points[index].x, points[index].y);
+    enemies[enemy_count - 1].spawn_id = index;
+}
+
+// 移除离开回收范围的敌人（保持其余敌人的顺序）
+static void despawn_far_enemies() {
+    float left = camera.x - SPAWN_DESPAWN_MARGIN;
+    float right = camera.x + CAMERA_LOGICAL_WIDTH + SPAWN_DESPAWN_MARGIN;
+    int write_index = 0;
+    for (int read_index = 0; read_index < enemy_count; read_index++) {
+        const Enemy* enemy = &enemies[read_index];
+        if (enemy->state == ENEMY_STATE_ALIVE && (enemy->x + enemy->width < left || enemy->x > right)) {
+            continue;
+        }
+        if (write_index != read_index) {
+            enemies[write_index] = enemies[read_index];
+        }
+        write_index++;
+    }
+    enemy_count = write_index;
+}
+
+void spawn_update() {
+    despawn_far_enemies();
+
+    float left, right;
+    activate_range(&left, &right);
+
+    // 范围右移：右边界跨过的出生点进入范围，左边界跨过的离开范围
+    while (end_inside < point_count && points[end_inside].x <= right) {
+        if (points[end_inside].x >= left) activate(end_inside);
+        end_inside++;
+    }
+    while (first_inside < end_inside && points[first_inside].x < left) {
+        first_inside++;
+    }
+
+    // 范围左移：左边界跨过的出生点进入范围，右边界跨过的离开范围
+    while (first_inside > 0 && points[first_inside - 1].x >= left) {
+        first_inside--;
+        if (points[first_inside].x <= right) activate(first_inside);
+    }
+    while (end_inside > first_inside && points[end_inside - 1].x > right) {
+        end_inside--;
+    }
+}
+
+// 第一个x不小于value（strict为1时为大于value）的出生点
+static int lower_bound(float value, int strict) {
+    int low = 0, high = point_count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (points[mid].x < value || (strict && points[mid].x == value)) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+void spawn_resync() {
+    float left, right;
+    activate_range(&left, &right);
+    first_inside = lower_bound(left, 0);
+    end_inside = lower_bound(right, 1);
+}
+
+int spawn_get_count() {
+    return point_count;
+}
+
+void spawn_mark_killed(int spawn_id) {
+    if (spawn_id >= 0 && spawn_id < point_count) points[spawn_id].killed = 1;
+}
+
+int spawn_save_killed(unsigned char* bits) {
+    if (point_count > SPAWN_SNAPSHOT_MAX) return -1;
+    memset(bits, 0, (size_t)(point_count + 7) / 8);
+    for (int i = 0; i < point_count; i++) {
+        if (points[i].killed) bits[i >> 3] |= (unsigned char)(1 << (i & 7));
+    }
+    return point_count;
+}
+
+void spawn_load_killed(const unsigned char* bits, int count) {
+    for (int i = 0; i < point_count; i++) {
+        points[i].killed = i < count && (bits[i >> 3] >> (i & 7)) & 1;
+    }
+}
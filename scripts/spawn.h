@@ -0,0 +1,42 @@
+// spawn.h
+// 敌人出生点索引头文件（按距离激活和回收敌人）
+//
+// 关卡载入时把所有敌人标记收集成按x坐标排序的出生点数组。每个逻辑帧根据摄像机位置
+// 计算激活范围（视野左右各SPAWN_ACTIVATE_MARGIN像素），出生点进入激活范围时创建敌人；
+// 敌人离开回收范围（视野左右各SPAWN_DESPAWN_MARGIN像素）时直接移除，它的出生点重新
+// 等待下一次进入激活范围。激活范围的左右边界在排序数组中各用一个游标跟踪，每帧只
+// 检查跨过边界的出生点，因此每帧的开销只取决于摄像机附近的敌人，与关卡长度无关。
+//
+// 被消灭的敌人不会从出生点重新出现；离开回收范围而被移除的敌人会。出生点是否已有
+// 对应的敌人由Enemy.spawn_id推导，游标可以随时按摄像机位置重新计算，所以快照中只需要
+// 保存每个出生点的"已消灭"标记。
+
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include "enemy.h"
+
+#define SPAWN_ACTIVATE_MARGIN (20 * 16)   // 激活范围超出视野的距离（一屏）
+#define SPAWN_DESPAWN_MARGIN (40 * 16)    // 回收范围超出视野的距离（两屏，避免来回激活）
+
+// 出生点
+typedef struct {
+    float x, y;          // 敌人的初始位置
+    EnemyType type;
+    int killed;          // 敌人已被消灭，不再出现
+} SpawnPoint;
+
+void spawn_build_index();                       // 扫描当前关卡，重建出生点索引（清空所有敌人）
+void spawn_append(EnemyType type, float x, float y); // 追加出生点（x不能小于已有出生点，无限模式使用）
+void spawn_shift_x(float dx);                   // 所有出生点平移，移出地图左侧的删除（无限模式）
+void spawn_update();                            // 按摄像机位置激活和回收敌人（每个逻辑帧调用）
+void spawn_resync();                            // 按摄像机位置重新计算游标（恢复快照后调用，不创建敌人）
+int spawn_get_count();                          // 出生点数量
+void spawn_mark_killed(int spawn_id);           // 标记出生点的敌人已被消灭（spawn_id为-1时忽略）
+
+// 快照中保存"已消灭"标记（每个出生点1位），出生点超过SPAWN_SNAPSHOT_MAX个时不支持快照
+#define SPAWN_SNAPSHOT_MAX 1024
+int spawn_save_killed(unsigned char* bits);     // 写入标记位，返回出生点数量（超过上限返回-1）
+void spawn_load_killed(const unsigned char* bits, int count); // 恢复标记位
+
+#endif // SPAWN_H
@@ -0,0 +1,65 @@
+// statehash.c
+// 世界状态哈希实现
+//
+// 骑士、敌人和摄像机结构体只包含4字节的float/int/enum字段，没有填充字节，
+// 可以直接对内存整体做哈希；地图只记录改动，由map.c增量维护。
+// 整帧的计算量约1.5KB数据的XXH64，可以一直开着。
+
+#include "statehash.h"
+#include "hash.h"
+#include "knight.h"
+#include "enemy.h"
+#include "map.h"
+#include "camera.h"
+#include <stdio.h>
+
+// 哈希日志文件（NULL表示未开启）
+static FILE* log_file = NULL;
+
+// 计算当前世界状态的哈希
+void compute_world_hash(WorldHash* out) {
+    out->knight = hash64(&knight, sizeof(knight), 0);
+    out->enemies = hash64(enemies, sizeof(Enemy) * enemy_count, (uint64_t)enemy_count);
+    out->map = map_get_mutation_hash();
+    out->camera = hash64(&camera_offset_x, sizeof(camera_offset_x), hash64(&camera, sizeof(camera), 0));
+    
+    uint64_t parts[4] = { out->knight, out->enemies, out->map, out->camera };
+    out->total = hash64(parts, sizeof(parts), 0);
+}
+
+// 开始写哈希日志
+int statehash_log_begin(const char* path) {
+    statehash_log_end();
+    
+    log_file = fopen(path, "w");
+    if (!log_file) {
+        printf("无法创建哈希日志: %s\n", path);
+        return 0;
+    }
+    fprintf(log_file, "# knight statehash v1\n");
+    fprintf(log_file, "# tick total knight enemies map camera\n");
+    printf("开始记录状态哈希: %s\n", path);
+    return 1;
+}
+
+// 写入一帧的哈希
+void statehash_log_tick(unsigned int tick, const WorldHash* hash) {
+    if (!log_file) return;
+    fprintf(log_file, "%u %016llx %016llx %016llx %016llx %016llx\n", tick,
+            (unsigned long long)hash->total, (unsigned long long)hash->knight,
+            (unsigned long long)hash->enemies, (unsigned long long)hash->map,
+            (unsigned long long)hash->camera);
+}
+
+// 结束并关闭哈希日志
+void statehash_log_end() {
+    if (log_file) {
+        fclose(log_file);
+        log_file = NULL;
+    }
+}
+
+// 是否正在写哈希日志
+int statehash_log_is_open() {
+    return log_file != NULL;
+}
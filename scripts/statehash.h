@@ -0,0 +1,26 @@
+// statehash.h
+// 世界状态哈希头文件（逐帧计算，用于确定性校验）
+
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <stdint.h>
+
+// 一帧的世界状态哈希（总哈希和各部分哈希，便于定位分歧来源）
+typedef struct {
+    uint64_t total;    // 各部分合并后的总哈希
+    uint64_t knight;   // 骑士完整状态
+    uint64_t enemies;  // 敌人数组（按当前数量）
+    uint64_t map;      // 地图改动（见map_get_mutation_hash）
+    uint64_t camera;   // 摄像机状态
+} WorldHash;
+
+void compute_world_hash(WorldHash* out);   // 计算当前世界状态的哈希
+
+// 哈希日志：每个逻辑帧写一行，配合tools/hashdiff找出两次运行第一处分歧
+int statehash_log_begin(const char* path); // 开始写哈希日志，成功返回1
+void statehash_log_tick(unsigned int tick, const WorldHash* hash); // 写入一帧（未开启时什么都不做）
+void statehash_log_end();                  // 结束并关闭哈希日志
+int statehash_log_is_open();               // 是否正在写哈希日志
+
+#endif // STATEHASH_H
@@ -0,0 +1,116 @@
+// telemetry.c
+// 游戏事件统计实现
+//
+// 事件先写入内存缓冲区，缓冲区满或结束记录时才一次性写入文件，
+// 单条事件的开销只是填一个16字节的结构体。
+// 联机时待确认帧的事件先挂起，输入确认后才进入缓冲区，被回滚的预测不会留在文件里。
+
+#include "telemetry.h"
+#include "game.h"
+#include "knight.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TELEMETRY_BUFFER_SIZE 512  // 缓冲区能容纳的事件数
+#define TELEMETRY_PENDING_SIZE 64  // 能挂起的待确认事件数
+
+const char* telemetry_event_names[TELEMETRY_EVENT_COUNT] = {
+    "session", "damage", "death", "stomp", "goal", "trap", "save", "pickup"
+};
+
+static FILE* telemetry_file = NULL;
+static TelemetryEvent buffer[TELEMETRY_BUFFER_SIZE];
+static int buffered = 0;
+
+// 挂起的待确认事件（按待确认帧号递增排列）
+static TelemetryEvent pending[TELEMETRY_PENDING_SIZE];
+static unsigned int pending_ticks[TELEMETRY_PENDING_SIZE];
+static int pending_count = 0;
+
+static void flush_buffer() {
+    if (buffered > 0) {
+        fwrite(buffer, sizeof(TelemetryEvent), buffered, telemetry_file);
+        buffered = 0;
+    }
+}
+
+// 开始记录
+int telemetry_begin(const char* path) {
+    telemetry_end();
+    
+    telemetry_file = fopen(path, "wb");
+    if (!telemetry_file) {
+        printf("无法创建事件统计文件: %s\n", path);
+        return 0;
+    }
+    
+    unsigned char header[8] = { 'K', 'T', 'E', 'L', TELEMETRY_VERSION, 0, sizeof(TelemetryEvent), 0 };
+    fwrite(header, 1, sizeof(header), telemetry_file);
+    printf("开始记录游戏事件: %s\n", path);
+    return 1;
+}
+
+// 写出缓冲区并关闭文件（仍在挂起的事件没有确认，不再写出）
+void telemetry_end() {
+    if (telemetry_file) {
+        flush_buffer();
+        fclose(telemetry_file);
+        telemetry_file = NULL;
+    }
+    pending_count = 0;
+}
+
+// 把一条事件放进缓冲区
+static void append_event(const TelemetryEvent* event) {
+    buffer[buffered++] = *event;
+    if (buffered == TELEMETRY_BUFFER_SIZE) {
+        flush_buffer();
+    }
+}
+
+// 记录一条事件
+void telemetry_event(TelemetryEventType type, float x, float y, int payload) {
+    if (!telemetry_file) return;
+    
+    TelemetryEvent event;
+    event.tick = game_get_tick();
+    event.type = (uint8_t)type;
+    event.reserved = 0;
+    event.payload = (int16_t)payload;
+    event.x = x;
+    event.y = y;
+    
+    unsigned int pending_tick = game_get_pending_tick();
+    if (pending_tick == GAME_TICK_CONFIRMED) {
+        append_event(&event);
+        return;
+    }
+    if (pending_count == TELEMETRY_PENDING_SIZE) telemetry_commit(pending_ticks[0] + 1); // 满了时最早一帧直接写出
+    pending[pending_count] = event;
+    pending_ticks[pending_count] = pending_tick;
+    pending_count++;
+}
+
+// 以骑士中心为位置记录事件
+void telemetry_knight_event(TelemetryEventType type, int payload) {
+    telemetry_event(type, knight.x + knight.width / 2.0f, knight.y + knight.height / 2.0f, payload);
+}
+
+// 丢弃该待确认帧及之后挂起的事件
+void telemetry_discard(unsigned int pending_tick) {
+    while (pending_count > 0 && pending_ticks[pending_count - 1] >= pending_tick) {
+        pending_count--;
+    }
+}
+
+// 写出该待确认帧之前挂起的事件
+void telemetry_commit(unsigned int pending_tick) {
+    int committed = 0;
+    while (committed < pending_count && pending_ticks[committed] < pending_tick) {
+        if (telemetry_file) append_event(&pending[committed]);
+        committed++;
+    }
+    pending_count -= committed;
+    memmove(pending, pending + committed, sizeof(TelemetryEvent) * pending_count);
+    memmove(pending_ticks, pending_ticks + committed, sizeof(unsigned int) * pending_count);
+}
@@ -0,0 +1,44 @@
+// telemetry.h
+// 游戏事件统计头文件（二进制事件流，用于离线分析玩家死亡、踩敌人、拾取等位置）
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// 文件格式：8字节文件头（"KTEL" + 版本号 + 记录大小），之后是定长16字节记录，小端序
+#define TELEMETRY_MAGIC "KTEL"
+#define TELEMETRY_VERSION 1
+
+// 事件类型
+typedef enum {
+    TELEMETRY_SESSION = 0,   // 开始新的一局
+    TELEMETRY_DAMAGE,        // 骑士受伤（附加数据：剩余生命）
+    TELEMETRY_DEATH,         // 骑士死亡
+    TELEMETRY_STOMP,         // 踩死敌人（位置为敌人中心，附加数据：敌人下标）
+    TELEMETRY_GOAL,          // 到达终点
+    TELEMETRY_TRAP,          // 踩到陷阱（附加数据：1=回到存档点，0=死亡）
+    TELEMETRY_SAVE,          // 记录存档点
+    TELEMETRY_PICKUP,        // 拾取奖励方块（附加数据：BlockType）
+    TELEMETRY_EVENT_COUNT
+} TelemetryEventType;
+
+// 单条事件记录（16字节，无填充）
+typedef struct {
+    uint32_t tick;           // 逻辑帧号
+    uint8_t type;            // 事件类型（TelemetryEventType）
+    uint8_t reserved;
+    int16_t payload;         // 附加数据（含义见事件类型）
+    float x, y;              // 事件发生的世界坐标（骑士或敌人的中心点）
+} TelemetryEvent;
+
+extern const char* telemetry_event_names[TELEMETRY_EVENT_COUNT];
+
+int telemetry_begin(const char* path);  // 开始记录（覆盖已有文件），成功返回1
+void telemetry_end();                   // 写出缓冲区并关闭文件
+void telemetry_event(TelemetryEventType type, float x, float y, int payload); // 记录一条事件（未开启时什么都不做）
+void telemetry_knight_event(TelemetryEventType type, int payload);          // 以骑士中心为位置记录事件
+void telemetry_discard(unsigned int pending_tick); // 丢弃该待确认帧及之后挂起的事件（game_discard_output调用）
+void telemetry_commit(unsigned int pending_tick);  // 写出该待确认帧之前挂起的事件（game_commit_output调用）
+
+#endif // TELEMETRY_H
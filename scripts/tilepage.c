@@ -0,0 +1,339 @@
+// tilepage.c
+// 分页关卡存储实现（POSIX上内存映射关卡文件，Windows上整个读入内存）
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "tilepage.h"
+#include "blocks.h"
+#include "map.h"
+#include "log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 编译期检查：一列放得下整张地图，方块类型放得进4位且不与敌人标记冲突
+typedef char tilepage_rows_check[(TILEPAGE_ROWS >= MAP_HEIGHT) ? 1 : -1];
+typedef char tilepage_code_check[(BLOCK_CAMERA_MOVE < TILE_CODE_ENEMY && TILE_CODE_ENEMY < 16) ? 1 : -1];
+
+// 常驻槽位
+typedef struct {
+    int page;                 // 驻留的页号（-1表示空闲）
+    unsigned int last_used;   // 最近使用时间（用于LRU淘汰）
+    uint8_t data[TILEPAGE_BYTES];
+} TileSlot;
+
+// 改动表中的一条（同一格子只保留一条）
+typedef struct {
+    int32_t x;
+    int16_t y;
+    int16_t code;
+} TileEdit;
+
+static const uint8_t* file_data = NULL;  // 映射的整个文件
+static size_t file_size = 0;
+static const uint8_t* page_data = NULL;  // 第一页的起始位置
+static int level_width = 0;
+static int page_count = 0;
+
+static TileSlot slots[TILEPAGE_RESIDENT];
+static int16_t* page_slot = NULL;        // 页号 -> 槽位（-1表示不在内存）
+static unsigned int use_clock = 0;
+
+// 最近访问的页（连续查询同一页时跳过查表）
+static int last_page = -1;
+static uint8_t* last_data = NULL;
+
+static TileEdit* edits = NULL;           // 改动表（打开关卡时分配，满了时加倍）
+static int edit_count = 0;
+static int edit_capacity = 0;
+
+static unsigned int page_loads = 0;
+static unsigned int evictions = 0;
+
+// 地图字符与格子编码的对应关系（编码即BlockType）
+int tilepage_code_from_char(char tile) {
+    switch (tile) {
+    case '#': return BLOCK_NORMAL;
+    case 't': return BLOCK_GOAL;
+    case 'G': return BLOCK_GRASS;
+    case 'M': return BLOCK_MUD;
+    case 'B': return BLOCK_ENEMY_BARRIER;
+    case 'F': return BLOCK_DOUBLE_JUMP;
+    case 'D': return BLOCK_DASH;
+    case 'T': return BLOCK_TRAP;
+    case 'S': return BLOCK_SAVE;
+    case 'C': return BLOCK_CAMERA_MOVE;
+    case 'E': return TILE_CODE_ENEMY;
+    }
+    return BLOCK_NONE;
+}
+
+char tilepage_char_from_code(int code) {
+    static const char chars[16] = " #tGMBFDTSCE    ";
+    return chars[code & 15];
+}
+
+// 读取页数据中的一格
+static int nibble_get(const uint8_t* data, int column, int y) {
+    int index = column * TILEPAGE_ROWS + y;
+    return (data[index >> 1] >> ((index & 1) * 4)) & 15;
+}
+
+static void nibble_set(uint8_t* data, int column, int y, int code) {
+    int index = column * TILEPAGE_ROWS + y;
+    int shift = (index & 1) * 4;
+    data[index >> 1] = (uint8_t)((data[index >> 1] & ~(15 << shift)) | ((code & 15) << shift));
+}
+
+// 把一页载入最久未使用的槽位，并重新应用这一页上的改动
+static int load_page(int page) {
+    int victim = 0;
+    for (int i = 0; i < TILEPAGE_RESIDENT; i++) {
+        if (slots[i].page < 0) {
+            victim = i;
+            break;
+        }
+        if (slots[i].last_used < slots[victim].last_used) victim = i;
+    }
+    TileSlot* slot = &slots[victim];
+    if (slot->page >= 0) {
+        page_slot[slot->page] = -1;
+        evictions++;
+    }
+    memcpy(slot->data, page_data + (size_t)page * TILEPAGE_BYTES, TILEPAGE_BYTES);
+    for (int i = 0; i < edit_count; i++) {
+        if (edits[i].x / TILEPAGE_COLUMNS == page) {
+            nibble_set(slot->data, edits[i].x % TILEPAGE_COLUMNS, edits[i].y, edits[i].code);
+        }
+    }
+    slot->page = page;
+    page_slot[page] = (int16_t)victim;
+    page_loads++;
+    return victim;
+}
+
+// 获取一页的常驻数据（不在内存时载入），并更新最近使用时间
+static uint8_t* resident_page(int page) {
+    int slot = page_slot[page];
+    if (slot < 0) slot = load_page(page);
+    slots[slot].last_used = ++use_clock;
+    last_page = page;
+    last_data = slots[slot].data;
+    return last_data;
+}
+
+int tilepage_get(int x, int y) {
+    int page = x / TILEPAGE_COLUMNS;
+    const uint8_t* data = (page == last_page) ? last_data : resident_page(page);
+    return nibble_get(data, x % TILEPAGE_COLUMNS, y);
+}
+
+int tilepage_lookup(int x, int y) {
+    if (!file_data) return -1;
+    if (x < 0 || x >= level_width || y < 0 || y >= MAP_HEIGHT) return BLOCK_NONE;
+    int page = x / TILEPAGE_COLUMNS;
+    const uint8_t* data = (page == last_page) ? last_data : resident_page(page);
+    return nibble_get(data, x % TILEPAGE_COLUMNS, y);
+}
+
+int tilepage_get_original(int x, int y) {
+    return nibble_get(page_data + (size_t)(x / TILEPAGE_COLUMNS) * TILEPAGE_BYTES, x % TILEPAGE_COLUMNS, y);
+}
+
+void tilepage_set(int x, int y, int code) {
+    int page = x / TILEPAGE_COLUMNS;
+    uint8_t* data = (page == last_page) ? last_data : resident_page(page);
+    nibble_set(data, x % TILEPAGE_COLUMNS, y, code);
+
+    for (int i = 0; i < edit_count; i++) {
+        if (edits[i].x == x && edits[i].y == y) {
+            if (code == tilepage_get_original(x, y)) {
+                edits[i] = edits[--edit_count]; // 改回原样，不再需要记录
+            } else {
+                edits[i].code = (int16_t)code;
+            }
+            return;
+        }
+    }
+    if (code == tilepage_get_original(x, y)) return;
+    if (edit_count == edit_capacity) {
+        int capacity = edit_capacity * 2;
+        TileEdit* grown = (TileEdit*)realloc(edits, sizeof(TileEdit) * capacity);
+        if (!grown) {
+            LOG_ERROR("关卡改动表无法扩容到%d条，(%d, %d)的改动在页淘汰后会丢失", capacity, x, y);
+            return;
+        }
+        edits = grown;
+        edit_capacity = capacity;
+    }
+    edits[edit_count].x = x;
+    edits[edit_count].y = (int16_t)y;
+    edits[edit_count].code = (int16_t)code;
+    edit_count++;
+}
+
+// 丢弃所有改动并清空常驻槽位
+void tilepage_reset() {
+    for (int i = 0; i < TILEPAGE_RESIDENT; i++) {
+        if (slots[i].page >= 0) page_slot[slots[i].page] = -1;
+        slots[i].page = -1;
+        slots[i].last_used = 0;
+    }
+    edit_count = 0;
+    last_page = -1;
+    last_data = NULL;
+}
+
+void tilepage_touch(int first_column, int last_column) {
+    if (!file_data) return;
+    if (first_column < 0) first_column = 0;
+    if (last_column >= level_width) last_column = level_width - 1;
+    for (int page = first_column / TILEPAGE_COLUMNS; page <= last_column / TILEPAGE_COLUMNS; page++) {
+        resident_page(page);
+    }
+}
+
+#ifndef _WIN32
+// 映射整个文件（只读，页面由系统按需调入）
+static const uint8_t* map_file(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* memory = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) return NULL;
+    *size = (size_t)st.st_size;
+    return (const uint8_t*)memory;
+}
+
+static void unmap_file(const uint8_t* data, size_t size) {
+    munmap((void*)data, size);
+}
+#else
+// Windows上整个读入内存
+static const uint8_t* map_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* data = length > 0 ? (uint8_t*)malloc((size_t)length) : NULL;
+    if (!data || fread(data, 1, (size_t)length, file) != (size_t)length) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+static void unmap_file(const uint8_t* data, size_t size) {
+    (void)size;
+    free((void*)data);
+}
+#endif
+
+// 映射关卡文件并检查文件头
+int tilepage_open(const char* path) {
+    tilepage_close();
+    size_t size = 0;
+    const uint8_t* data = map_file(path, &size);
+    if (!data) {
+        printf("无法打开关卡文件: %s\n", path);
+        return 0;
+    }
+    TilePageHeader header;
+    if (size < sizeof(header)) {
+        printf("关卡文件太小: %s\n", path);
+        unmap_file(data, size);
+        return 0;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TILEPAGE_MAGIC || header.version != TILEPAGE_VERSION ||
+        header.height != MAP_HEIGHT || header.page_columns != TILEPAGE_COLUMNS ||
+        header.width == 0 || header.width > TILEPAGE_MAX_WIDTH || header.page_count != (header.width + TILEPAGE_COLUMNS - 1) / TILEPAGE_COLUMNS ||
+        size < sizeof(header) + (size_t)header.page_count * TILEPAGE_BYTES) {
+        printf("关卡文件格式不匹配: %s\n", path);
+        unmap_file(data, size);
+        return 0;
+    }
+    page_slot = (int16_t*)malloc(header.page_count * sizeof(int16_t));
+    edits = (TileEdit*)malloc(sizeof(TileEdit) * TILEPAGE_EDIT_INITIAL);
+    if (!page_slot || !edits) {
+        printf("无法分配关卡页表\n");
+        free(page_slot);
+        free(edits);
+        page_slot = NULL;
+        edits = NULL;
+        unmap_file(data, size);
+        return 0;
+    }
+    edit_capacity = TILEPAGE_EDIT_INITIAL;
+    memset(page_slot, 0xFF, header.page_count * sizeof(int16_t)); // 全部为-1
+
+    file_data = data;
+    file_size = size;
+    page_data = data + sizeof(header);
+    level_width = (int)header.width;
+    page_count = (int)header.page_count;
+    page_loads = 0;
+    evictions = 0;
+    for (int i = 0; i < TILEPAGE_RESIDENT; i++) slots[i].page = -1;
+    tilepage_reset();
+    printf("载入分页关卡 %s：%d 列，%d 页\n", path, level_width, page_count);
+    return 1;
+}
+
+void tilepage_close() {
+    if (!file_data) return;
+    unmap_file(file_data, file_size);
+    free(page_slot);
+    free(edits);
+    file_data = NULL;
+    page_data = NULL;
+    page_slot = NULL;
+    edits = NULL;
+    edit_count = 0;
+    edit_capacity = 0;
+    level_width = 0;
+    page_count = 0;
+    last_page = -1;
+    last_data = NULL;
+}
+
+int tilepage_is_open() {
+    return file_data != NULL;
+}
+
+int tilepage_width() {
+    return level_width;
+}
+
+void tilepage_get_stats(TilePageStats* stats) {
+    stats->width = level_width;
+    stats->page_count = page_count;
+    stats->page_loads = page_loads;
+    stats->evictions = evictions;
+    stats->edit_count = edit_count;
+}
+
+void tilepage_report() {
+    if (!file_data) return;
+    printf("分页关卡: %d 列 %d 页，常驻 %d 页（%d 字节），载入 %u 次，淘汰 %u 次，改动 %d 格\n",
+           level_width, page_count, TILEPAGE_RESIDENT, TILEPAGE_RESIDENT * TILEPAGE_BYTES,
+           page_loads, evictions, edit_count);
+}
@@ -0,0 +1,71 @@
+// tilepage.h
+// 分页关卡存储头文件（每格4位，按页从内存映射的关卡文件中按需载入）
+//
+// 关卡文件由tools/level_pack生成：文件头之后是按列切分的页，每页TILEPAGE_COLUMNS列、
+// TILEPAGE_ROWS行，每格一个4位编码（编码与BlockType相同，另加敌人标记），一列正好
+// 8字节。游戏把整个文件映射到内存，只把用到的页复制到TILEPAGE_RESIDENT个常驻槽位中，
+// 槽位按最近使用时间淘汰。每个逻辑帧把摄像机附近和活动敌人所在的页标记为最近使用，
+// 查询格子时先看上一次访问的页，再查页号到槽位的表，因此关卡宽度只影响映射大小和
+// 这张表（每页2字节），不影响常驻内存。
+//
+// 游戏中对格子的改动（拾取奖励）记录在改动表里，页被淘汰后重新载入时再次应用。
+// 改动表按需加倍扩容，不会丢弃改动。
+
+#ifndef TILEPAGE_H
+#define TILEPAGE_H
+
+#include <stdint.h>
+
+#define TILEPAGE_COLUMNS 64                                      // 每页列数
+#define TILEPAGE_ROWS 16                                         // 每页行数（不小于MAP_HEIGHT）
+#define TILEPAGE_BYTES (TILEPAGE_COLUMNS * TILEPAGE_ROWS / 2)    // 每页字节数
+#define TILEPAGE_RESIDENT 16                                     // 常驻页数
+#define TILEPAGE_EDIT_INITIAL 256                                // 改动表初始容量（满了时加倍）
+
+// 关卡最大列数。骑士、敌人和摄像机的坐标是float像素，65536列（16像素一格）时x约为2^20，
+// float的精度是0.0625像素，每帧的位移误差不超过0.03像素；再宽的话精度每翻倍一次就变粗一倍，
+// 几百万像素处加速度和速度会被明显取整，物理表现与关卡起点附近不同
+#define TILEPAGE_MAX_WIDTH 65536
+
+#define TILEPAGE_MAGIC 0x4C564C4Bu   // "KLVL"
+#define TILEPAGE_VERSION 1
+
+#define TILE_CODE_ENEMY 11           // 敌人标记（0~10与BlockType相同）
+
+// 关卡文件头（小端序）
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;           // 关卡列数
+    uint32_t height;          // 关卡行数（必须等于MAP_HEIGHT）
+    uint32_t page_columns;    // 每页列数（必须等于TILEPAGE_COLUMNS）
+    uint32_t page_count;      // 页数
+    uint32_t reserved[2];
+} TilePageHeader;
+
+// 分页存储统计信息
+typedef struct {
+    int width;                // 关卡列数
+    int page_count;           // 页数
+    unsigned int page_loads;  // 页载入次数（包括淘汰后重新载入）
+    unsigned int evictions;   // 页淘汰次数
+    int edit_count;           // 改动表条数
+} TilePageStats;
+
+int tilepage_open(const char* path);        // 映射关卡文件，成功返回1
+void tilepage_close();                      // 解除映射
+int tilepage_is_open();                     // 是否正在使用分页关卡
+int tilepage_width();                       // 关卡列数
+int tilepage_get(int x, int y);             // 读取格子编码（调用方保证坐标在关卡内）
+int tilepage_lookup(int x, int y);          // 读取格子编码，关卡外返回0；没有分页关卡时返回-1
+int tilepage_get_original(int x, int y);    // 读取关卡文件中的原始编码
+void tilepage_set(int x, int y, int code);  // 修改格子（记入改动表）
+void tilepage_reset();                      // 丢弃所有改动，恢复原始关卡
+void tilepage_touch(int first_column, int last_column); // 把覆盖这些列的页标记为最近使用（不在内存时载入）
+void tilepage_get_stats(TilePageStats* stats);
+void tilepage_report();                     // 打印统计信息
+
+int tilepage_code_from_char(char tile);     // 地图字符转格子编码
+char tilepage_char_from_code(int code);     // 格子编码转地图字符
+
+#endif // TILEPAGE_H
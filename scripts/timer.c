@@ -0,0 +1,35 @@
+// timer.c
+// 逻辑帧计时器实现
+
+#include "timer.h"
+#include "game.h"
+
+unsigned int timer_now() {
+    return game_get_tick();
+}
+
+void timer_start(TickTimer* timer, unsigned int ticks) {
+    // 到期帧为0表示没有在计时，所以至少计时到第1帧
+    unsigned int deadline = timer_now() + ticks;
+    *timer = deadline ? deadline : 1;
+}
+
+void timer_stop(TickTimer* timer) {
+    *timer = 0;
+}
+
+int timer_running(TickTimer timer) {
+    return timer != 0 && timer_now() < timer;
+}
+
+int timer_expired(TickTimer* timer) {
+    if (*timer == 0 || timer_now() < *timer) return 0;
+    *timer = 0;
+    return 1;
+}
+
+float timer_remaining_seconds(TickTimer timer) {
+    unsigned int now = timer_now();
+    if (timer == 0 || now >= timer) return 0.0f;
+    return (float)(timer - now) / TIMER_TICKS_PER_SECOND;
+}
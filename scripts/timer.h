@@ -0,0 +1,27 @@
+// timer.h
+// 逻辑帧计时器头文件（受伤无敌、受击/死亡动画、冲刺和界面提示共用一个时钟）
+//
+// 计时器只记录到期的逻辑帧（启动时的帧号加上时长），时钟就是game.c的逻辑帧计数。
+// 没有到期的计时器每帧不用做任何减法，需要时与当前帧号比较一次；到期后由所属实体在
+// 自己的更新中处理（结束受击、开始冷却等）。判断的是"当前帧不小于到期帧"而不是"正好
+// 等于"，所以某一帧没有检查（实体没有更新、或者帧号被跳过）时，下一次检查仍会触发，
+// 并且只触发一次。时长按每秒60帧换算成整数帧，不再有逐帧累加浮点数带来的误差。
+// 计时器保存在骑士、敌人和界面状态中，与帧号一起随快照保存和恢复：回溯、读档和联机
+// 回滚时到期帧和时钟同时回到过去，重新模拟时照常到期，不会丢失；重置游戏时时钟从0开始。
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#define TIMER_TICKS_PER_SECOND 60
+#define TIMER_TICKS(seconds) ((unsigned int)((seconds) * TIMER_TICKS_PER_SECOND + 0.5f)) // 秒换算成逻辑帧数
+
+typedef unsigned int TickTimer;   // 到期的逻辑帧（0表示没有在计时）
+
+unsigned int timer_now();                              // 当前逻辑帧（自上次重置以来）
+void timer_start(TickTimer* timer, unsigned int ticks); // 从当前帧开始计时ticks帧
+void timer_stop(TickTimer* timer);                     // 停止计时
+int timer_running(TickTimer timer);                    // 正在计时且还没到期
+int timer_expired(TickTimer* timer);                   // 到期时返回1并停止计时（每次计时只返回一次）
+float timer_remaining_seconds(TickTimer timer);        // 剩余时间（秒，没有在计时时为0）
+
+#endif // TIMER_H
@@ -0,0 +1,197 @@
+// trigger.c
+// 触发区域索引实现
+
+#include "trigger.h"
+#include "map.h"
+#include "log.h"
+#include "world_local.h"
+#include <stdlib.h>
+#include <string.h>
+
+// 区域数组（按左边界排序，容量只增不减）
+static WORLD_LOCAL TriggerRegion* regions = NULL;
+static WORLD_LOCAL int region_count = 0;
+static WORLD_LOCAL int region_capacity = 0;
+
+// 每行的区域表：第row行的区域编号为row_entries[row_start[row]..row_start[row+1])，按x排序
+static WORLD_LOCAL int* row_entries = NULL;
+static WORLD_LOCAL int row_entry_capacity = 0;
+static WORLD_LOCAL int row_start[MAP_HEIGHT + 1];
+
+// 会触发事件的方块类型
+static int is_trigger_block(BlockType type) {
+    switch (type) {
+    case BLOCK_GOAL:
+    case BLOCK_DOUBLE_JUMP:
+    case BLOCK_DASH:
+    case BLOCK_TRAP:
+    case BLOCK_SAVE:
+    case BLOCK_CAMERA_MOVE:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int push_region(int x, int y0, int y1, BlockType type) {
+    if (region_count == region_capacity) {
+        int capacity = region_capacity ? region_capacity * 2 : 64;
+        TriggerRegion* grown = (TriggerRegion*)realloc(regions, sizeof(TriggerRegion) * (size_t)capacity);
+        if (!grown) {
+            LOG_ERROR("无法扩展触发区域索引");
+            return -1;
+        }
+        regions = grown;
+        region_capacity = capacity;
+    }
+    TriggerRegion* region = &regions[region_count];
+    region->x0 = x;
+    region->x1 = x;
+    region->y0 = y0;
+    region->y1 = y1;
+    region->type = type;
+    return region_count++;
+}
+
+// 按列扫描[first, last)列：每列的同类型竖条与前一列完全相同的竖条合并
+static void scan_columns(int first, int last) {
+    int open[MAP_HEIGHT];   // 右边界在前一列的区域
+    int open_count = 0;
+    for (int x = first; x < last; x++) {
+        int next_open[MAP_HEIGHT];
+        int next_count = 0;
+        int y = 0;
+        while (y < MAP_HEIGHT) {
+            BlockType type = get_block_type(x, y);
+            if (!is_trigger_block(type)) {
+                y++;
+                continue;
+            }
+            int y0 = y;
+            while (y + 1 < MAP_HEIGHT && get_block_type(x, y + 1) == type) y++;
+            int y1 = y++;
+
+            int index = -1;
+            for (int i = 0; i < open_count; i++) {
+                TriggerRegion* region = &regions[open[i]];
+                if (region->y0 == y0 && region->y1 == y1 && region->type == type) {
+                    region->x1 = x;
+                    index = open[i];
+                    break;
+                }
+            }
+            if (index < 0) index = push_region(x, y0, y1, type);
+            if (index >= 0) next_open[next_count++] = index;
+        }
+        memcpy(open, next_open, sizeof(int) * (size_t)next_count);
+        open_count = next_count;
+    }
+}
+
+// 由区域数组重建每行的区域表（区域已按左边界排序，同一行内自然按x排序）
+static void build_rows() {
+    int counts[MAP_HEIGHT] = { 0 };
+    int total = 0;
+    for (int i = 0; i < region_count; i++) {
+        for (int y = regions[i].y0; y <= regions[i].y1; y++) counts[y]++;
+        total += regions[i].y1 - regions[i].y0 + 1;
+    }
+    if (total > row_entry_capacity) {
+        int* grown = (int*)realloc(row_entries, sizeof(int) * (size_t)total);
+        if (!grown) {
+            LOG_ERROR("无法扩展触发区域行表");
+            region_count = 0;
+            memset(row_start, 0, sizeof(row_start));
+            return;
+        }
+        row_entries = grown;
+        row_entry_capacity = total;
+    }
+    int fill[MAP_HEIGHT];
+    row_start[0] = 0;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        row_start[y + 1] = row_start[y] + counts[y];
+        fill[y] = row_start[y];
+    }
+    for (int i = 0; i < region_count; i++) {
+        for (int y = regions[i].y0; y <= regions[i].y1; y++) row_entries[fill[y]++] = i;
+    }
+}
+
+void trigger_build_index() {
+    region_count = 0;
+    scan_columns(0, map_get_width());
+    build_rows();
+    LOG_DEBUG("触发区域索引：%d 个区域", region_count);
+}
+
+// 区域左移，完全移出地图的删除，跨过左边缘的截断
+void trigger_shift_left(int columns) {
+    int write_index = 0;
+    for (int i = 0; i < region_count; i++) {
+        TriggerRegion region = regions[i];
+        region.x0 -= columns;
+        region.x1 -= columns;
+        if (region.x1 < 0) continue;
+        if (region.x0 < 0) region.x0 = 0;
+        regions[write_index++] = region;
+    }
+    region_count = write_index;
+    scan_columns(MAP_WIDTH - columns, MAP_WIDTH);
+    build_rows();
+}
+
+int trigger_query(int cell_x, int cell_y) {
+    if (cell_y < 0 || cell_y >= MAP_HEIGHT) return -1;
+    // 这一行中最后一个左边界不大于cell_x的区域
+    int low = row_start[cell_y], high = row_start[cell_y + 1];
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (regions[row_entries[mid]].x0 <= cell_x) low = mid + 1;
+        else high = mid;
+    }
+    if (low == row_start[cell_y]) return -1;
+    int index = row_entries[low - 1];
+    return cell_x <= regions[index].x1 ? index : -1;
+}
+
+static int region_contains(int index, int cell_x, int cell_y) {
+    const TriggerRegion* region = &regions[index];
+    return cell_x >= region->x0 && cell_x <= region->x1 && cell_y >= region->y0 && cell_y <= region->y1;
+}
+
+int trigger_update(int* region, int cell_x, int cell_y, TriggerEvent events[2]) {
+    int previous = (*region >= 0 && *region < region_count) ? *region : -1;
+    int current = (previous >= 0 && region_contains(previous, cell_x, cell_y)) ? previous
+                                                                              : trigger_query(cell_x, cell_y);
+    int count = 0;
+    if (current >= 0 && current == previous) {
+        events[count].type = TRIGGER_EVENT_STAY;
+        events[count].block = regions[current].type;
+        events[count].region = current;
+        count++;
+    } else {
+        if (previous >= 0) {
+            events[count].type = TRIGGER_EVENT_EXIT;
+            events[count].block = regions[previous].type;
+            events[count].region = previous;
+            count++;
+        }
+        if (current >= 0) {
+            events[count].type = TRIGGER_EVENT_ENTER;
+            events[count].block = regions[current].type;
+            events[count].region = current;
+            count++;
+        }
+    }
+    *region = current;
+    return count;
+}
+
+BlockType trigger_get_type(int region) {
+    return (region >= 0 && region < region_count) ? regions[region].type : BLOCK_NONE;
+}
+
+int trigger_get_count() {
+    return region_count;
+}
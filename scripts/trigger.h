@@ -0,0 +1,43 @@
+// trigger.h
+// 触发区域索引头文件（通关、奖励、存档点、陷阱、镜头移动方块）
+//
+// 关卡载入时把所有触发方块合并成矩形区域：每列先把同类型的连续格子合成竖条，再与前一列
+// 完全相同的竖条合并，得到的区域按左边界排序。每一行另存一张按x排序的区域表（同一行的
+// 区域互不重叠），查询某个格子属于哪个区域只需在这一行的表里二分查找一次。
+//
+// 骑士每帧先检查是否还在上一帧的区域里，不在时才查询一次，并由两次结果得到离开、进入
+// 或停留事件。新增触发方块类型只需在is_trigger_block中登记，不会增加每帧的查询次数。
+// 区域按关卡的初始状态建立，被拾取的奖励方块仍在区域中，由拾取函数检查方块是否还在。
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include "blocks.h"
+
+// 触发区域（格子坐标，包含两端）
+typedef struct {
+    int x0, y0, x1, y1;
+    BlockType type;
+} TriggerRegion;
+
+// 触发事件类型
+typedef enum {
+    TRIGGER_EVENT_ENTER,    // 进入区域
+    TRIGGER_EVENT_STAY,     // 停留在区域内
+    TRIGGER_EVENT_EXIT      // 离开区域
+} TriggerEventType;
+
+typedef struct {
+    TriggerEventType type;
+    BlockType block;        // 区域的方块类型
+    int region;             // 区域编号
+} TriggerEvent;
+
+void trigger_build_index();                      // 扫描当前关卡，重建触发区域索引
+void trigger_shift_left(int columns);            // 地图窗口左移后平移区域，并加入新露出的列（无限模式）
+int trigger_query(int cell_x, int cell_y);       // 格子所在的区域编号（不在任何区域返回-1）
+int trigger_update(int* region, int cell_x, int cell_y, TriggerEvent events[2]); // 更新所在区域，返回事件数
+BlockType trigger_get_type(int region);          // 区域的方块类型（-1返回BLOCK_NONE）
+int trigger_get_count();                         // 区域数量
+
+#endif // TRIGGER_H
@@ -5,20 +5,27 @@
 #include "render.h"
 #include "knight.h"
 #include "sound.h"
+#include "log.h"
 #include <stdio.h>
 #include <string.h>
 
 // 全局变量
 static TTF_Font* game_font = NULL;       // 游戏字体
-static GameState current_game_state = GAME_STATE_MAIN_MENU;
-static int selected_menu_option = 0;     // 当前选中的菜单选项
-static float damage_indicator_timer = 0.0f;  // 受伤效果计时器
+static TTF_Font* native_font = NULL;     // 按输出分辨率放大字号的字体（界面直接画到窗口时使用）
+static int native_font_size = 0;
+static float text_scale = 1.0f;          // 一个逻辑像素对应的输出像素数（1表示按逻辑分辨率栅格化）
+static WORLD_LOCAL GameState current_game_state = GAME_STATE_MAIN_MENU;
+static WORLD_LOCAL int selected_menu_option = 0;     // 当前选中的菜单选项
+static WORLD_LOCAL TickTimer damage_indicator_timer = 0; // 受伤效果结束的逻辑帧
 static Language current_language = LANG_CHINESE;  // 当前语言，默认中文
 
 // 游戏提示系统变量
-static float game_start_hint_timer = 0.0f;    // 游戏开始提示计时器
-static float skill_hint_timer = 0.0f;         // 技能提示计时器
-static char skill_hint_text[128] = "";        // 技能提示文本
+static WORLD_LOCAL TickTimer game_start_hint_timer = 0;   // 游戏开始提示结束的逻辑帧
+static WORLD_LOCAL TickTimer skill_hint_timer = 0;        // 技能提示结束的逻辑帧
+static WORLD_LOCAL char skill_hint_text[128] = "";        // 技能提示文本
+
+#define FONT_PATH "assets/fonts/BoutiqueBitmap9x9_1.9.ttf"
+#define FONT_SIZE 13       // 逻辑分辨率下的字号
 
 // 窗口尺寸（与render.c保持一致）
 #define WINDOW_WIDTH 320   // 逻辑宽度
@@ -66,6 +73,11 @@ static const TextEntry text_table[] = {
     {"double_jump_hint", "已获得二连跳技能", "Double Jump skill acquired"},
     {"dash_hint", "已获得冲刺技能，按D键冲刺", "Dash skill acquired, press D to dash"},
     {"save_hint", "游戏进度已保存！", "Game progress saved!"},
+    {"quicksave_hint", "已快速存档到槽位%d", "Quick saved to slot %d"},
+    {"quickload_hint", "已读取槽位%d", "Loaded slot %d"},
+    {"quickload_empty", "槽位%d没有存档", "Slot %d is empty"},
+    {"quickload_blocked", "录制、回放或记录哈希时不能读档", "Cannot load while recording, replaying or logging hashes"},
+    {"quickslot_hint", "当前存档槽位：%d", "Quick save slot: %d"},
     
     // 语言切换
     {"lang_switched_cn", "切换为中文", "Switched to Chinese"},
@@ -74,6 +86,100 @@ static const TextEntry text_table[] = {
     {NULL, NULL, NULL} // 表结束标记
 };
 
+// 文本纹理缓存：菜单和HUD每帧绘制的字符串基本不变，缓存渲染结果避免每帧
+// 重新生成surface和纹理。颜色不含透明度，淡入淡出通过SDL_SetTextureAlphaMod实现
+#define TEXT_CACHE_SIZE 48
+#define TEXT_CACHE_MAX_LENGTH 128
+
+typedef struct {
+    char text[TEXT_CACHE_MAX_LENGTH];
+    Language language;
+    Uint8 r, g, b;
+    int font_size;           // 栅格化时的字号
+    SDL_Texture* texture;
+    int w, h;
+    unsigned int last_used;  // 最近使用序号（缓存满时替换最久未用的条目）
+} TextCacheEntry;
+
+static TextCacheEntry text_cache[TEXT_CACHE_SIZE];
+static unsigned int text_cache_clock = 0;
+static unsigned int text_cache_misses = 0;
+
+// 清空文本纹理缓存
+static void clear_text_cache() {
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        if (text_cache[i].texture) {
+            SDL_DestroyTexture(text_cache[i].texture);
+        }
+    }
+    memset(text_cache, 0, sizeof(text_cache));
+}
+
+// 查找或生成文本纹理，失败返回NULL
+static TextCacheEntry* get_text_entry(const char* text, SDL_Color color) {
+    text_cache_clock++;
+    TTF_Font* font = text_scale > 1.0f ? native_font : game_font;
+    int font_size = text_scale > 1.0f ? native_font_size : FONT_SIZE;
+    
+    TextCacheEntry* slot = &text_cache[0];
+    for (int i = 0; i < TEXT_CACHE_SIZE; i++) {
+        TextCacheEntry* entry = &text_cache[i];
+        if (entry->texture && entry->language == current_language && entry->font_size == font_size &&
+            entry->r == color.r && entry->g == color.g && entry->b == color.b &&
+            strcmp(entry->text, text) == 0) {
+            entry->last_used = text_cache_clock;
+            return entry;
+        }
+        // 记录空位或最久未用的条目
+        if (!entry->texture) {
+            if (slot->texture) slot = entry;
+        } else if (slot->texture && entry->last_used < slot->last_used) {
+            slot = entry;
+        }
+    }
+    
+    text_cache_misses++;
+    SDL_Color opaque = {color.r, color.g, color.b, 255};
+    SDL_Surface* text_surface = NULL;
+    
+    // 根据当前语言选择合适的渲染方式
+    if (current_language == LANG_CHINESE) {
+        // 中文使用UTF8渲染
+        text_surface = TTF_RenderUTF8_Solid(font, text, opaque);
+    } else {
+        // 英文使用ASCII渲染（更兼容）
+        text_surface = TTF_RenderText_Solid(font, text, opaque);
+    }
+    
+    if (!text_surface) {
+        printf("文本渲染失败: %s, 错误: %s\n", text, TTF_GetError());
+        return NULL;
+    }
+    
+    SDL_Texture* text_texture = SDL_CreateTextureFromSurface(gRenderer, text_surface);
+    if (!text_texture) {
+        SDL_FreeSurface(text_surface);
+        return NULL;
+    }
+    
+    if (slot->texture) {
+        SDL_DestroyTexture(slot->texture);
+    }
+    strncpy(slot->text, text, TEXT_CACHE_MAX_LENGTH - 1);
+    slot->text[TEXT_CACHE_MAX_LENGTH - 1] = '\0';
+    slot->language = current_language;
+    slot->r = color.r;
+    slot->g = color.g;
+    slot->b = color.b;
+    slot->font_size = font_size;
+    slot->texture = text_texture;
+    slot->w = text_surface->w;
+    slot->h = text_surface->h;
+    slot->last_used = text_cache_clock;
+    SDL_FreeSurface(text_surface);
+    return slot;
+}
+
 // 初始化UI系统
 int init_ui() {
     // 初始化SDL_ttf
@@ -83,7 +189,7 @@ int init_ui() {
     }
     
     // 加载字体
-    game_font = TTF_OpenFont("assets/fonts/BoutiqueBitmap9x9_1.9.ttf", 13); // 使用9号字体大小（适合像素风格）
+    game_font = TTF_OpenFont(FONT_PATH, FONT_SIZE); // 使用9号字体大小（适合像素风格）
     if (!game_font) {
         printf("字体加载失败: %s\n", TTF_GetError());
         return 0;
@@ -95,6 +201,12 @@ int init_ui() {
 
 // 清理UI资源
 void cleanup_ui() {
+    clear_text_cache();
+    if (native_font) {
+        TTF_CloseFont(native_font);
+        native_font = NULL;
+        native_font_size = 0;
+    }
     if (game_font) {
         TTF_CloseFont(game_font);
         game_font = NULL;
@@ -115,6 +227,27 @@ void set_game_state(GameState state) {
     }
 }
 
+// 读取对局相关的UI状态
+void get_ui_state(UiState* state) {
+    state->game_state = current_game_state;
+    state->selected_menu_option = selected_menu_option;
+    state->damage_indicator_timer = damage_indicator_timer;
+    state->game_start_hint_timer = game_start_hint_timer;
+    state->skill_hint_timer = skill_hint_timer;
+    memcpy(state->skill_hint_text, skill_hint_text, sizeof(skill_hint_text));
+}
+
+// 恢复对局相关的UI状态
+void set_ui_state(const UiState* state) {
+    current_game_state = state->game_state;
+    selected_menu_option = state->selected_menu_option;
+    damage_indicator_timer = state->damage_indicator_timer;
+    game_start_hint_timer = state->game_start_hint_timer;
+    skill_hint_timer = state->skill_hint_timer;
+    memcpy(skill_hint_text, state->skill_hint_text, sizeof(skill_hint_text));
+    skill_hint_text[sizeof(skill_hint_text) - 1] = '\0';
+}
+
 // 获取当前选中的菜单选项
 int get_selected_menu_option() {
     return selected_menu_option;
@@ -171,35 +304,52 @@ void update_menu(SDL_Event* e) {
     }
 }
 
+// 获取文本缓存未命中次数（未命中的帧会生成新纹理，不算稳态帧）
+unsigned int get_text_cache_misses() {
+    return text_cache_misses;
+}
+
+// 设置文字栅格化的倍数：大于1时用放大字号的字体生成文字纹理，按输出像素1:1绘制，
+// 坐标仍是逻辑坐标（窗口大小改变时才重新打开字体，缓存按字号区分）
+void set_text_scale(float scale) {
+    if (scale <= 1.0f) {
+        text_scale = 1.0f;
+        return;
+    }
+    int size = (int)(FONT_SIZE * scale + 0.5f);
+    if (size != native_font_size) {
+        if (native_font) TTF_CloseFont(native_font);
+        native_font = TTF_OpenFont(FONT_PATH, size);
+        native_font_size = native_font ? size : 0;
+        if (!native_font) {
+            printf("放大字号的字体加载失败: %s\n", TTF_GetError());
+        }
+    }
+    text_scale = native_font ? scale : 1.0f;
+}
+
 // 渲染文本
 void render_text(const char* text, int x, int y, SDL_Color color, int center) {
     if (!game_font || !gRenderer) return;
     
-    SDL_Surface* text_surface = NULL;
+    TextCacheEntry* entry = get_text_entry(text, color);
+    if (!entry) return;
     
-    // 根据当前语言选择合适的渲染方式
-    if (current_language == LANG_CHINESE) {
-        // 中文使用UTF8渲染
-        text_surface = TTF_RenderUTF8_Solid(game_font, text, color);
-    } else {
-        // 英文使用ASCII渲染（更兼容）
-        text_surface = TTF_RenderText_Solid(game_font, text, color);
-    }
-    
-    if (!text_surface) {
-        printf("文本渲染失败: %s, 错误: %s\n", text, TTF_GetError());
-        return;
-    }
-    
-    SDL_Texture* text_texture = SDL_CreateTextureFromSurface(gRenderer, text_surface);
-    if (!text_texture) {
-        SDL_FreeSurface(text_surface);
+    if (text_scale > 1.0f) {
+        // 放大字号生成的纹理按输出像素1:1绘制，换算成逻辑坐标下的小数大小
+        SDL_FRect dest = { (float)x, (float)y, entry->w / text_scale, entry->h / text_scale };
+        if (center) {
+            dest.x -= dest.w / 2.0f;
+            dest.y -= dest.h / 2.0f;
+        }
+        SDL_SetTextureAlphaMod(entry->texture, color.a);
+        SDL_RenderCopyF(gRenderer, entry->texture, NULL, &dest);
         return;
     }
     
     SDL_Rect dest_rect;
-    dest_rect.w = text_surface->w;
-    dest_rect.h = text_surface->h;
+    dest_rect.w = entry->w;
+    dest_rect.h = entry->h;
     
     if (center) {
         dest_rect.x = x - dest_rect.w / 2;
@@ -209,10 +359,8 @@ void render_text(const char* text, int x, int y, SDL_Color color, int center) {
         dest_rect.y = y;
     }
     
-    SDL_RenderCopy(gRenderer, text_texture, NULL, &dest_rect);
-    
-    SDL_DestroyTexture(text_texture);
-    SDL_FreeSurface(text_surface);
+    SDL_SetTextureAlphaMod(entry->texture, color.a);
+    SDL_RenderCopy(gRenderer, entry->texture, NULL, &dest_rect);
 }
 
 // 渲染主菜单
@@ -309,10 +457,11 @@ void render_game_ui() {
     }
     
     // 渲染受伤效果
-    if (damage_indicator_timer > 0) {
+    float damage_remaining = timer_remaining_seconds(damage_indicator_timer);
+    if (damage_remaining > 0) {
         // 红色半透明覆盖层
         SDL_SetRenderDrawBlendMode(gRenderer, SDL_BLENDMODE_BLEND);
-        Uint8 alpha = (Uint8)(damage_indicator_timer / 0.5f * 64); // 最大64透明度
+        Uint8 alpha = (Uint8)(damage_remaining / 0.5f * 64); // 最大64透明度
         SDL_SetRenderDrawColor(gRenderer, 255, 0, 0, alpha);
         SDL_Rect screen_rect = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
         SDL_RenderFillRect(gRenderer, &screen_rect);
@@ -324,34 +473,14 @@ void render_game_ui() {
 
 // 显示受伤效果
 void show_damage_indicator() {
-    damage_indicator_timer = 0.5f; // 0.5秒的受伤效果
+    timer_start(&damage_indicator_timer, TIMER_TICKS(0.5f)); // 0.5秒的受伤效果
 }
 
-// 更新UI效果
-void update_ui_effects(float delta_time) {
-    // 更新受伤效果计时器
-    if (damage_indicator_timer > 0) {
-        damage_indicator_timer -= delta_time;
-        if (damage_indicator_timer < 0) {
-            damage_indicator_timer = 0;
-        }
-    }
-    
-    // 更新游戏开始提示计时器
-    if (game_start_hint_timer > 0) {
-        game_start_hint_timer -= delta_time;
-        if (game_start_hint_timer < 0) {
-            game_start_hint_timer = 0;
-        }
-    }
-    
-    // 更新技能提示计时器
-    if (skill_hint_timer > 0) {
-        skill_hint_timer -= delta_time;
-        if (skill_hint_timer < 0) {
-            skill_hint_timer = 0;
-        }
-    }
+// 清除受伤效果和提示（计时器以逻辑帧计数为时钟，重置游戏时时钟归零，上一局的计时不再有效）
+void reset_ui_effects() {
+    timer_stop(&damage_indicator_timer);
+    timer_stop(&game_start_hint_timer);
+    timer_stop(&skill_hint_timer);
 }
 
 // 语言管理函数
@@ -361,12 +490,12 @@ Language get_current_language() {
 
 void set_language(Language lang) {
     current_language = lang;
-    printf("语言已切换为: %s\n", (lang == LANG_CHINESE) ? "中文" : "English");
+    LOG_INFO("语言已切换为: %s", (lang == LANG_CHINESE) ? "中文" : "English");
 }
 
 void toggle_language() {
     current_language = (current_language == LANG_CHINESE) ? LANG_ENGLISH : LANG_CHINESE;
-    printf("语言已切换为: %s\n", (current_language == LANG_CHINESE) ? "中文" : "English");
+    LOG_INFO("语言已切换为: %s", (current_language == LANG_CHINESE) ? "中文" : "English");
 }
 
 // 根据key获取当前语言的文本
@@ -388,7 +517,7 @@ const char* get_text(const char* key) {
 
 // 显示游戏开始提示
 void show_game_start_hint() {
-    game_start_hint_timer = 3.0f; // 显示3秒
+    timer_start(&game_start_hint_timer, TIMER_TICKS(3.0f)); // 显示3秒
 }
 
 // 显示技能获得提示
@@ -403,21 +532,22 @@ void show_skill_hint(const char* skill_name) {
         strncpy(skill_hint_text, skill_name, sizeof(skill_hint_text) - 1);
     }
     skill_hint_text[sizeof(skill_hint_text) - 1] = '\0'; // 确保字符串结束
-    skill_hint_timer = 2.5f; // 显示2.5秒
+    timer_start(&skill_hint_timer, TIMER_TICKS(2.5f)); // 显示2.5秒
 }
 
 // 渲染游戏提示
 void render_game_hints() {
     // 渲染游戏开始提示
-    if (game_start_hint_timer > 0) {
+    float start_remaining = timer_remaining_seconds(game_start_hint_timer);
+    if (start_remaining > 0) {
         // 计算透明度（淡入淡出效果）
         float alpha_factor = 1.0f;
-        if (game_start_hint_timer > 2.5f) {
+        if (start_remaining > 2.5f) {
             // 前0.5秒淡入
-            alpha_factor = (3.0f - game_start_hint_timer) / 0.5f;
-        } else if (game_start_hint_timer < 0.5f) {
+            alpha_factor = (3.0f - start_remaining) / 0.5f;
+        } else if (start_remaining < 0.5f) {
             // 后0.5秒淡出
-            alpha_factor = game_start_hint_timer / 0.5f;
+            alpha_factor = start_remaining / 0.5f;
         }
         
         // 创建半透明背景
@@ -433,15 +563,16 @@ void render_game_hints() {
     }
     
     // 渲染技能获得提示
-    if (skill_hint_timer > 0) {
+    float skill_remaining = timer_remaining_seconds(skill_hint_timer);
+    if (skill_remaining > 0) {
         // 计算透明度（淡入淡出效果）
         float alpha_factor = 1.0f;
-        if (skill_hint_timer > 2.0f) {
+        if (skill_remaining > 2.0f) {
             // 前0.5秒淡入
-            alpha_factor = (2.5f - skill_hint_timer) / 0.5f;
-        } else if (skill_hint_timer < 0.5f) {
+            alpha_factor = (2.5f - skill_remaining) / 0.5f;
+        } else if (skill_remaining < 0.5f) {
             // 后0.5秒淡出
-            alpha_factor = skill_hint_timer / 0.5f;
+            alpha_factor = skill_remaining / 0.5f;
         }
         
         // 创建半透明背景
@@ -7,6 +7,7 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdbool.h>
+#include "timer.h"
 
 // 游戏状态枚举
 typedef enum {
@@ -25,6 +26,17 @@ typedef enum {
     MENU_OPTION_COUNT        // 选项总数
 } MenuOption;
 
+// 与对局相关的UI状态（游戏状态、菜单选择、提示计时器），快照时整体读写
+// 语言设置和文字纹理缓存不属于对局状态，不包含在内
+typedef struct {
+    GameState game_state;
+    int selected_menu_option;
+    TickTimer damage_indicator_timer;  // 效果和提示结束的逻辑帧（暂停时不走）
+    TickTimer game_start_hint_timer;
+    TickTimer skill_hint_timer;
+    char skill_hint_text[128];
+} UiState;
+
 // UI系统初始化和清理
 int init_ui();              // 初始化UI系统（加载字体等）
 void cleanup_ui();          // 清理UI资源
@@ -32,6 +44,8 @@ void cleanup_ui();          // 清理UI资源
 // 游戏状态管理
 GameState get_game_state();
 void set_game_state(GameState state);
+void get_ui_state(UiState* state);          // 读取对局相关的UI状态
+void set_ui_state(const UiState* state);    // 恢复对局相关的UI状态
 
 // 菜单相关函数
 void update_menu(SDL_Event* e);           // 更新菜单输入
@@ -44,6 +58,8 @@ void reset_menu_selection();               // 重置菜单选择
 // 游戏内UI渲染
 void render_game_ui();                     // 渲染游戏内UI（生命值、分数等）
 void render_text(const char* text, int x, int y, SDL_Color color, int center); // 渲染文本
+void set_text_scale(float scale);          // 设置文字栅格化倍数（输出像素/逻辑像素，1为按逻辑分辨率）
+unsigned int get_text_cache_misses();      // 获取文本纹理缓存未命中次数
 
 // 语言设置
 typedef enum {
@@ -59,7 +75,7 @@ const char* get_text(const char* key);     // 根据key获取当前语言的文
 
 // UI效果
 void show_damage_indicator();              // 显示受伤效果
-void update_ui_effects(float delta_time);  // 更新UI效果
+void reset_ui_effects();                   // 清除受伤效果和提示（重置游戏时调用）
 
 // 游戏提示系统
 void show_game_start_hint();               // 显示游戏开始提示
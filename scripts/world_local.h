@@ -0,0 +1,17 @@
+// world_local.h
+// 世界状态的存储类别
+//
+// 游戏逻辑使用全局变量保存世界状态（骑士、敌人、地图、摄像机等）。
+// 编译批量训练环境（env.c）时定义WORLD_THREAD_LOCAL，这些全局变量变为线程局部变量，
+// 每个工作线程拥有一份独立的世界，可以并行模拟；普通游戏编译时不受影响。
+
+#ifndef WORLD_LOCAL_H
+#define WORLD_LOCAL_H
+
+#ifdef WORLD_THREAD_LOCAL
+#define WORLD_LOCAL __thread
+#else
+#define WORLD_LOCAL
+#endif
+
+#endif // WORLD_LOCAL_H
@@ -0,0 +1,239 @@
+// golden.c
+// 物理行为回归检查工具：回放录像并逐帧比对骑士、敌人和地图状态
+//
+// 用法：
+//   golden check [目录]   回放目录下corpus.txt列出的所有场景，报告第一处不一致
+//   golden bless [目录]   用当前代码重新生成所有场景的期望状态（.golden文件）
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <SDL.h>
+#include "game.h"
+#include "input.h"
+#include "knight.h"
+#include "enemy.h"
+#include "map.h"
+#include "ui.h"
+#include "replay.h"
+#include "camera.h"
+
+// 单帧状态记录
+typedef struct {
+    unsigned int tick;       // 帧号
+    unsigned int mask;       // 本帧按键
+    uint32_t knight_x;       // 骑士位置和速度（浮点数位模式，保证逐位比较）
+    uint32_t knight_y;
+    uint32_t knight_vx;
+    uint32_t knight_vy;
+    uint64_t enemies;        // 所有敌人位置和状态的哈希
+    uint64_t map;            // 地图内容哈希（反映被收集的方块等修改）
+} GoldenRow;
+
+#define FIELD_COUNT 6
+static const char* field_names[FIELD_COUNT] = {
+    "knight.x", "knight.y", "knight.vx", "knight.vy", "enemies", "map"
+};
+
+static unsigned char masks[REPLAY_MAX_TICKS];
+static GoldenRow expected[REPLAY_MAX_TICKS];
+static GoldenRow actual[REPLAY_MAX_TICKS];
+
+// FNV-1a 64位哈希
+static uint64_t hash_bytes(uint64_t h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+// 采集当前帧状态
+static void capture_row(GoldenRow* row, unsigned int tick, unsigned int mask) {
+    row->tick = tick;
+    row->mask = mask;
+    row->knight_x = float_bits(knight.x);
+    row->knight_y = float_bits(knight.y);
+    row->knight_vx = float_bits(knight.vx);
+    row->knight_vy = float_bits(knight.vy);
+    
+    uint64_t h = 14695981039346656037ull;
+    for (int i = 0; i < enemy_count; i++) {
+        uint32_t fields[3] = { float_bits(enemies[i].x), float_bits(enemies[i].y), (uint32_t)enemies[i].state };
+        h = hash_bytes(h, fields, sizeof(fields));
+    }
+    row->enemies = h;
+    row->map = hash_bytes(14695981039346656037ull, game_map, sizeof(game_map));
+}
+
+// 回放一段录像，返回实际模拟的帧数
+static int simulate(const unsigned char* input, int count, GoldenRow* rows) {
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    
+    int ticks = 0;
+    for (int i = 0; i < count; i++) {
+        // 与主循环一致：离开游戏状态（通关或死亡）后不再推进逻辑
+        if (get_game_state() != GAME_STATE_PLAYING) break;
+        set_input_mask(input[i]);
+        game_tick();
+        capture_row(&rows[ticks], game_get_tick(), input[i]);
+        ticks++;
+    }
+    return ticks;
+}
+
+static int load_golden(const char* path, GoldenRow* rows, int max_rows) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    
+    char line[256];
+    int count = 0;
+    while (count < max_rows && fgets(line, sizeof(line), file)) {
+        if (line[0] == '#') continue;
+        GoldenRow* row = &rows[count];
+        unsigned long long enemies_hash, map_hash;
+        if (sscanf(line, "%u %x %x %x %x %x %llx %llx", &row->tick, &row->mask,
+                   &row->knight_x, &row->knight_y, &row->knight_vx, &row->knight_vy,
+                   &enemies_hash, &map_hash) != 8) {
+            break;
+        }
+        row->enemies = enemies_hash;
+        row->map = map_hash;
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+static int save_golden(const char* path, const GoldenRow* rows, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) return 0;
+    
+    fprintf(file, "# tick mask x y vx vy enemies map\n");
+    for (int i = 0; i < count; i++) {
+        const GoldenRow* row = &rows[i];
+        fprintf(file, "%u %x %08x %08x %08x %08x %016llx %016llx\n", row->tick, row->mask,
+                row->knight_x, row->knight_y, row->knight_vx, row->knight_vy,
+                (unsigned long long)row->enemies, (unsigned long long)row->map);
+    }
+    fclose(file);
+    return 1;
+}
+
+// 找出两帧中第一个不一致的字段（一致返回-1）
+static int diff_row(const GoldenRow* a, const GoldenRow* b) {
+    if (a->knight_x != b->knight_x) return 0;
+    if (a->knight_y != b->knight_y) return 1;
+    if (a->knight_vx != b->knight_vx) return 2;
+    if (a->knight_vy != b->knight_vy) return 3;
+    if (a->enemies != b->enemies) return 4;
+    if (a->map != b->map) return 5;
+    return -1;
+}
+
+static void print_field(const GoldenRow* row, int field, char* out, size_t size) {
+    const uint32_t* floats[4] = { &row->knight_x, &row->knight_y, &row->knight_vx, &row->knight_vy };
+    if (field < 4) {
+        snprintf(out, size, "%.4f (%08x)", bits_float(*floats[field]), *floats[field]);
+    } else {
+        snprintf(out, size, "%016llx", (unsigned long long)(field == 4 ? row->enemies : row->map));
+    }
+}
+
+// 检查或重新生成单个场景，成功返回1
+static int run_scenario(const char* dir, const char* name, int bless) {
+    char input_path[512], golden_path[512];
+    snprintf(input_path, sizeof(input_path), "%s/%s.input", dir, name);
+    snprintf(golden_path, sizeof(golden_path), "%s/%s.golden", dir, name);
+    
+    int count = replay_load(input_path, masks, REPLAY_MAX_TICKS);
+    if (count < 0) return 0;
+    int ticks = simulate(masks, count, actual);
+    
+    if (bless) {
+        if (!save_golden(golden_path, actual, ticks)) {
+            printf("无法写入 %s\n", golden_path);
+            return 0;
+        }
+        printf("[生成] %-20s %5d 帧\n", name, ticks);
+        return 1;
+    }
+    
+    int expected_count = load_golden(golden_path, expected, REPLAY_MAX_TICKS);
+    if (expected_count < 0) {
+        printf("[失败] %-20s 缺少期望文件 %s\n", name, golden_path);
+        return 0;
+    }
+    
+    int common = ticks < expected_count ? ticks : expected_count;
+    for (int i = 0; i < common; i++) {
+        int field = diff_row(&expected[i], &actual[i]);
+        if (field >= 0) {
+            char want[64], got[64];
+            print_field(&expected[i], field, want, sizeof(want));
+            print_field(&actual[i], field, got, sizeof(got));
+            printf("[失败] %-20s 第 %u 帧 %s 不一致：期望 %s，实际 %s\n",
+                   name, actual[i].tick, field_names[field], want, got);
+            return 0;
+        }
+    }
+    if (ticks != expected_count) {
+        printf("[失败] %-20s 帧数不一致：期望 %d 帧，实际 %d 帧\n", name, expected_count, ticks);
+        return 0;
+    }
+    
+    printf("[通过] %-20s %5d 帧\n", name, ticks);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || (strcmp(argv[1], "check") != 0 && strcmp(argv[1], "bless") != 0)) {
+        printf("用法: %s check|bless [目录]\n", argv[0]);
+        return 2;
+    }
+    int bless = strcmp(argv[1], "bless") == 0;
+    const char* dir = argc > 2 ? argv[2] : "golden";
+    
+    char list_path[512];
+    snprintf(list_path, sizeof(list_path), "%s/corpus.txt", dir);
+    FILE* list = fopen(list_path, "r");
+    if (!list) {
+        printf("无法打开场景列表 %s\n", list_path);
+        return 2;
+    }
+    
+    init_input();
+    init_camera(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+    
+    Uint32 start_time = SDL_GetTicks();
+    int total = 0, failed = 0;
+    char name[256];
+    while (fscanf(list, "%255s", name) == 1) {
+        if (name[0] == '#') {
+            // 跳过注释行
+            int c;
+            while ((c = fgetc(list)) != '\n' && c != EOF) {}
+            continue;
+        }
+        total++;
+        if (!run_scenario(dir, name, bless)) failed++;
+    }
+    fclose(list);
+    
+    printf("共 %d 个场景，失败 %d 个，用时 %u ms\n", total, failed, SDL_GetTicks() - start_time);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,127 @@
+// hashdiff.c
+// 状态哈希比对工具：找出两次运行第一处出现分歧的逻辑帧
+//
+// 用法：
+//   hashdiff A.log B.log           比较两份哈希日志（游戏用 --hash-log 生成）
+//   hashdiff --run 录像 输出.log   无窗口回放录像并写出哈希日志
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <SDL.h>
+#include "game.h"
+#include "input.h"
+#include "camera.h"
+#include "ui.h"
+#include "replay.h"
+#include "statehash.h"
+
+#define PART_COUNT 5
+static const char* part_names[PART_COUNT] = { "total", "knight", "enemies", "map", "camera" };
+
+// 日志中的一行
+typedef struct {
+    unsigned int tick;
+    unsigned long long parts[PART_COUNT];
+} HashLine;
+
+static unsigned char masks[REPLAY_MAX_TICKS];
+
+// 读取下一条记录（跳过注释），读到文件末尾返回0
+static int read_line(FILE* file, HashLine* line) {
+    char buffer[256];
+    while (fgets(buffer, sizeof(buffer), file)) {
+        if (buffer[0] == '#' || buffer[0] == '\n') continue;
+        if (sscanf(buffer, "%u %llx %llx %llx %llx %llx", &line->tick,
+                   &line->parts[0], &line->parts[1], &line->parts[2],
+                   &line->parts[3], &line->parts[4]) == 6) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 比较两份哈希日志，一致返回0
+static int diff_logs(const char* path_a, const char* path_b) {
+    FILE* a = fopen(path_a, "r");
+    FILE* b = fopen(path_b, "r");
+    if (!a || !b) {
+        printf("无法打开哈希日志: %s\n", !a ? path_a : path_b);
+        if (a) fclose(a);
+        if (b) fclose(b);
+        return 2;
+    }
+    
+    HashLine la, lb;
+    int count = 0, result = 0;
+    while (1) {
+        int has_a = read_line(a, &la);
+        int has_b = read_line(b, &lb);
+        if (!has_a && !has_b) break;
+        if (has_a != has_b) {
+            printf("日志长度不同：%s 在第 %d 条记录后结束\n", has_a ? path_b : path_a, count);
+            result = 1;
+            break;
+        }
+        if (la.tick != lb.tick) {
+            printf("第 %d 条记录的帧号不同：%u / %u\n", count + 1, la.tick, lb.tick);
+            result = 1;
+            break;
+        }
+        if (la.parts[0] != lb.parts[0]) {
+            printf("第一处分歧：第 %u 帧\n", la.tick);
+            for (int i = 1; i < PART_COUNT; i++) {
+                if (la.parts[i] != lb.parts[i]) {
+                    printf("  %-8s %016llx / %016llx\n", part_names[i], la.parts[i], lb.parts[i]);
+                }
+            }
+            result = 1;
+            break;
+        }
+        count++;
+    }
+    
+    if (result == 0) {
+        printf("完全一致，共 %d 帧\n", count);
+    }
+    fclose(a);
+    fclose(b);
+    return result;
+}
+
+// 无窗口回放录像并写出哈希日志
+static int run_replay(const char* input_path, const char* log_path) {
+    int count = replay_load(input_path, masks, REPLAY_MAX_TICKS);
+    if (count < 0) return 2;
+    
+    init_input();
+    init_camera(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    if (!statehash_log_begin(log_path)) return 2;
+    
+    int ticks = 0;
+    for (int i = 0; i < count; i++) {
+        // 与主循环一致：离开游戏状态（通关或死亡）后不再推进逻辑
+        if (get_game_state() != GAME_STATE_PLAYING) break;
+        set_input_mask(masks[i]);
+        game_tick();
+        ticks++;
+    }
+    statehash_log_end();
+    
+    printf("回放 %d 帧，最终哈希 %016llx\n", ticks, (unsigned long long)game_get_world_hash()->total);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc == 4 && strcmp(argv[1], "--run") == 0) {
+        return run_replay(argv[2], argv[3]);
+    }
+    if (argc == 3) {
+        return diff_logs(argv[1], argv[2]);
+    }
+    printf("用法: %s A.log B.log\n", argv[0]);
+    printf("      %s --run 录像文件 输出.log\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,142 @@
+// heatmap.c
+// 事件热力图工具：汇总多个事件统计文件，按地图格子统计各类事件的次数
+//
+// 用法：
+//   heatmap [-e 事件名] [-c 输出.csv] 事件文件...
+//   -e  只显示某一类事件（session damage death stomp goal trap save pickup）
+//   -c  把所有事件的逐格统计写入CSV（type,tile_x,tile_y,count）
+
+#include <stdio.h>
+#include <string.h>
+#include "map.h"
+#include "knight.h"
+#include "telemetry.h"
+
+static int counts[TELEMETRY_EVENT_COUNT][MAP_HEIGHT][MAP_WIDTH];
+static int totals[TELEMETRY_EVENT_COUNT];
+
+// 读取一个事件文件并累加到统计中，返回事件数（失败返回-1）
+static int load_file(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("无法打开事件文件: %s\n", path);
+        return -1;
+    }
+    
+    unsigned char header[8];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        memcmp(header, TELEMETRY_MAGIC, 4) != 0 ||
+        header[4] != TELEMETRY_VERSION || header[6] != sizeof(TelemetryEvent)) {
+        printf("不是有效的事件文件: %s\n", path);
+        fclose(file);
+        return -1;
+    }
+    
+    TelemetryEvent events[256];
+    int total = 0;
+    size_t n;
+    while ((n = fread(events, sizeof(TelemetryEvent), 256, file)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            const TelemetryEvent* event = &events[i];
+            if (event->type >= TELEMETRY_EVENT_COUNT) continue;
+            int tile_x = (int)(event->x / TILE_SIZE);
+            int tile_y = (int)(event->y / TILE_SIZE);
+            if (tile_x < 0 || tile_x >= MAP_WIDTH || tile_y < 0 || tile_y >= MAP_HEIGHT) continue;
+            counts[event->type][tile_y][tile_x]++;
+            totals[event->type]++;
+            total++;
+        }
+    }
+    fclose(file);
+    return total;
+}
+
+// 在地图上叠加显示一类事件的热力图（1-9表示相对次数，其余显示原地图）
+static void print_heatmap(int type) {
+    int max = 0, width = 0;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int length = (int)strlen(game_map[y]);
+        if (length > width) width = length;
+        for (int x = 0; x < MAP_WIDTH; x++) {
+            if (counts[type][y][x] > max) max = counts[type][y][x];
+        }
+    }
+    
+    printf("\n== %s（共 %d 次，单格最多 %d 次）==\n", telemetry_event_names[type], totals[type], max);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        for (int x = 0; x < width; x++) {
+            int count = counts[type][y][x];
+            if (count > 0) {
+                int level = (count * 9 + max - 1) / max;
+                putchar('0' + (level < 1 ? 1 : level));
+            } else {
+                char tile = game_map[y][x];
+                putchar(tile ? tile : ' ');
+            }
+        }
+        putchar('\n');
+    }
+}
+
+static int write_csv(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("无法创建CSV文件: %s\n", path);
+        return 0;
+    }
+    fprintf(file, "type,tile_x,tile_y,count\n");
+    for (int type = 0; type < TELEMETRY_EVENT_COUNT; type++) {
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                if (counts[type][y][x] > 0) {
+                    fprintf(file, "%s,%d,%d,%d\n", telemetry_event_names[type], x, y, counts[type][y][x]);
+                }
+            }
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    int only_type = -1;
+    const char* csv_path = NULL;
+    int files = 0, events = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            for (int t = 0; t < TELEMETRY_EVENT_COUNT; t++) {
+                if (strcmp(telemetry_event_names[t], name) == 0) only_type = t;
+            }
+            if (only_type < 0) {
+                printf("未知事件类型: %s\n", name);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            csv_path = argv[++i];
+        } else {
+            int n = load_file(argv[i]);
+            if (n < 0) return 1;
+            events += n;
+            files++;
+        }
+    }
+    
+    if (files == 0) {
+        printf("用法: %s [-e 事件名] [-c 输出.csv] 事件文件...\n", argv[0]);
+        return 1;
+    }
+    
+    reset_map(); // 用原始地图作为热力图底图
+    printf("共读取 %d 个文件，%d 条事件\n", files, events);
+    for (int type = 0; type < TELEMETRY_EVENT_COUNT; type++) {
+        if (only_type >= 0 && type != only_type) continue;
+        // 不指定类型时跳过没有发生过的事件和每局开始事件
+        if (only_type < 0 && (totals[type] == 0 || type == TELEMETRY_SESSION)) continue;
+        print_heatmap(type);
+    }
+    
+    if (csv_path && !write_csv(csv_path)) return 1;
+    return 0;
+}
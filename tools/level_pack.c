@@ -0,0 +1,145 @@
+// level_pack.c
+// 关卡打包工具：把文本关卡转换为分页关卡文件（每格4位，供 --level 使用）
+//
+// 用法：
+//   level_pack -o 输出文件 [-f 关卡文件] [-r 重复次数]
+//   不指定 -f 时打包内置关卡。关卡文件每行一行地图（字符与map.c相同），行数为MAP_HEIGHT。
+//   -r  把关卡横向重复多次（中间的终点方块去掉，只保留最后一份），用于生成超长关卡
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "map.h"
+#include "tilepage.h"
+#include "blocks.h"
+
+static char* rows[MAP_HEIGHT];  // 每行的字符（不含换行）
+static int row_length[MAP_HEIGHT];
+static int level_width = 0;
+
+// 读取文本关卡文件，行的长度不限
+static int load_level_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("无法打开关卡文件: %s\n", path);
+        return 0;
+    }
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        size_t length = 0, capacity = 0;
+        char* line = NULL;
+        int c;
+        while ((c = fgetc(file)) != EOF && c != '\n') {
+            if (c == '\r') continue;
+            if (length + 1 >= capacity) {
+                capacity = capacity ? capacity * 2 : 1024;
+                line = (char*)realloc(line, capacity);
+            }
+            line[length++] = (char)c;
+        }
+        rows[y] = line;
+        row_length[y] = (int)length;
+        if ((int)length > level_width) level_width = (int)length;
+        if (c == EOF) break;
+    }
+    fclose(file);
+    return level_width > 0;
+}
+
+// 使用内置关卡（去掉右侧空白）
+static void load_builtin_level() {
+    reset_map();
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int length = (int)strlen(game_map[y]);
+        while (length > 0 && game_map[y][length - 1] == ' ') length--;
+        rows[y] = (char*)malloc((size_t)length + 1);
+        memcpy(rows[y], game_map[y], (size_t)length);
+        row_length[y] = length;
+        if (length > level_width) level_width = length;
+    }
+}
+
+// 重复后第x列第y行的格子编码
+static int tile_code(int x, int y, int repeat) {
+    int copy = x / level_width;
+    int column = x % level_width;
+    if (column >= row_length[y]) return BLOCK_NONE;
+    char tile = rows[y][column];
+    if (tile == 't' && copy != repeat - 1) return BLOCK_NONE;
+    return tilepage_code_from_char(tile);
+}
+
+int main(int argc, char* argv[]) {
+    const char* input = NULL;
+    const char* output = NULL;
+    int repeat = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-f") == 0) input = argv[i + 1];
+        else if (strcmp(argv[i], "-o") == 0) output = argv[i + 1];
+        else if (strcmp(argv[i], "-r") == 0) repeat = atoi(argv[i + 1]);
+        else {
+            printf("未知参数: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!output) {
+        printf("用法: %s -o 输出文件 [-f 关卡文件] [-r 重复次数]\n", argv[0]);
+        return 1;
+    }
+    if (repeat < 1) repeat = 1;
+
+    if (input) {
+        if (!load_level_file(input)) return 1;
+    } else {
+        load_builtin_level();
+    }
+    if ((long long)level_width * repeat > TILEPAGE_MAX_WIDTH) {
+        printf("关卡太宽：%lld 列，最多 %d 列（坐标是float像素，更远处物理精度不够）\n",
+               (long long)level_width * repeat, TILEPAGE_MAX_WIDTH);
+        return 1;
+    }
+
+    TilePageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TILEPAGE_MAGIC;
+    header.version = TILEPAGE_VERSION;
+    header.width = (uint32_t)(level_width * repeat);
+    header.height = MAP_HEIGHT;
+    header.page_columns = TILEPAGE_COLUMNS;
+    header.page_count = (header.width + TILEPAGE_COLUMNS - 1) / TILEPAGE_COLUMNS;
+
+    FILE* file = fopen(output, "wb");
+    if (!file) {
+        printf("无法写入: %s\n", output);
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+
+    // 逐页写入：每列TILEPAGE_ROWS格，偶数行在低4位
+    int counts[16] = { 0 };
+    uint8_t page[TILEPAGE_BYTES];
+    for (uint32_t p = 0; p < header.page_count; p++) {
+        memset(page, 0, sizeof(page));
+        for (int column = 0; column < TILEPAGE_COLUMNS; column++) {
+            int x = (int)p * TILEPAGE_COLUMNS + column;
+            if (x >= (int)header.width) break;
+            for (int y = 0; y < MAP_HEIGHT; y++) {
+                int code = tile_code(x, y, repeat);
+                int index = column * TILEPAGE_ROWS + y;
+                page[index >> 1] |= (uint8_t)(code << ((index & 1) * 4));
+                counts[code]++;
+            }
+        }
+        fwrite(page, sizeof(page), 1, file);
+    }
+    if (fclose(file) != 0) {
+        printf("写入失败: %s\n", output);
+        return 1;
+    }
+
+    size_t bytes = sizeof(header) + (size_t)header.page_count * TILEPAGE_BYTES;
+    printf("已写入 %s：%u 列 × %d 行，%u 页，%zu 字节（每格 %.2f 字节）\n", output, header.width,
+           MAP_HEIGHT, header.page_count, bytes, (double)bytes / ((double)header.width * MAP_HEIGHT));
+    printf("敌人 %d 个，存档点 %d 格，陷阱 %d 格\n", counts[TILE_CODE_ENEMY], counts[BLOCK_SAVE], counts[BLOCK_TRAP]);
+    for (int y = 0; y < MAP_HEIGHT; y++) free(rows[y]);
+    return 0;
+}
@@ -0,0 +1,728 @@
+// level_validate.c
+// 关卡可达性检查工具：找出玩家无法到达的二连跳、冲刺、存档点和终点方块
+//
+// 用法：
+//   level_validate [-f 关卡文件] [-r 重复次数] [-t 线程数]
+//   不指定 -f 时检查内置关卡。关卡文件每行一行地图（字符与map.c相同），行数为MAP_HEIGHT，
+//   宽度不限。-r 把关卡横向重复多次，用于测试长关卡的检查速度。
+//   有不可到达的方块时返回1。
+//
+// 第一步按knight.h中的物理常量，在空旷地形上模拟各种起跳方式（原地/助跑起跳、走下平台、
+// 空中改变方向、二连跳和冲刺的时机），得到每种能力组合下从一个站立格子出发能落到的
+// 相对位置（跳跃包络），每个落点保留几条不同形状的轨迹，记录轨迹经过的格子。
+// 第二步在关卡中对(站立格子, 已获得的能力)做广度优先搜索：轨迹经过的格子都不是实心方块、
+// 中心不碰陷阱、且在落点之前没有提前着地时，这条边才成立。轨迹经过奖励方块时获得对应能力。
+// 搜索按层推进，每层的节点由多个线程分担展开。
+//
+// 检查是保守的：撞墙、撞天花板后继续移动的路线不算，因此报告不可到达时请实际试玩确认。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <SDL.h>
+#include "map.h"
+#include "knight.h"
+
+#define LAYER_COUNT 4            // 能力组合：位0二连跳，位1冲刺
+#define ABILITY_DOUBLE_JUMP 1
+#define ABILITY_DASH 2
+
+#define ARC_MAX_TICKS 120        // 单条轨迹最多模拟的帧数
+#define ARC_VARIANTS 3           // 每个落点保留的轨迹数
+#define ARC_DX_RANGE 40          // 落点的水平范围（格）
+#define ARC_DY_UP 12             // 落点的最大上升高度（格）
+#define ARC_DY_DOWN 16           // 落点的最大下降高度（格）
+#define ARC_KEY_W (ARC_DX_RANGE * 2 + 1)
+#define ARC_KEY_H (ARC_DY_UP + ARC_DY_DOWN + 1)
+#define NO_PROBE 127
+
+#define MAX_THREADS 64
+#define PARALLEL_MIN_FRONTIER 64 // 一层节点少于这个数时由主线程直接展开
+
+// ---------------------------------------------------------------------------
+// 关卡
+
+typedef struct {
+    int width, height;
+    char* tiles;                 // height行，每行width个字符
+} Level;
+
+static Level level;
+
+static char level_tile(int x, int y) {
+    if (x < 0 || x >= level.width || y < 0 || y >= level.height) return 'M';
+    return level.tiles[(size_t)y * level.width + x];
+}
+
+// 与check_collision相同：地图外和草地、泥土、砖块是实心的
+static int is_solid(char tile) {
+    return tile == 'G' || tile == 'M' || tile == '#';
+}
+
+static int solid_at(int x, int y) {
+    return is_solid(level_tile(x, y));
+}
+
+// 方块对应的能力
+static int tile_ability(char tile) {
+    if (tile == 'F') return ABILITY_DOUBLE_JUMP;
+    if (tile == 'D') return ABILITY_DASH;
+    return 0;
+}
+
+static int is_item(char tile) {
+    return tile == 'F' || tile == 'D' || tile == 'S' || tile == 't';
+}
+
+// 骑士能否站在(x, y)：身体占据的两格不是实心、中心不是陷阱、脚下是实心
+static int standable(int x, int y) {
+    if (x < 0 || x >= level.width || y < 1 || y >= level.height) return 0;
+    char tile = level_tile(x, y);
+    return !is_solid(tile) && tile != 'T' && !solid_at(x, y - 1) && solid_at(x, y + 1);
+}
+
+// 读取关卡文件，缺少的行和列补空格
+static int load_level_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("无法打开关卡文件: %s\n", path);
+        return 0;
+    }
+    char** rows = (char**)calloc(MAP_HEIGHT, sizeof(char*));
+    int width = 0;
+    char* line = NULL;
+    size_t capacity = 0;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        // 逐字符读取，行的长度不限
+        size_t length = 0;
+        int c;
+        while ((c = fgetc(file)) != EOF && c != '\n') {
+            if (c == '\r') continue;
+            if (length + 1 >= capacity) {
+                capacity = capacity ? capacity * 2 : 1024;
+                line = (char*)realloc(line, capacity);
+            }
+            line[length++] = (char)c;
+        }
+        rows[y] = (char*)malloc(length + 1);
+        if (length) memcpy(rows[y], line, length);
+        rows[y][length] = '\0';
+        if ((int)length > width) width = (int)length;
+        if (c == EOF) break;
+    }
+    fclose(file);
+    free(line);
+
+    level.width = width;
+    level.height = MAP_HEIGHT;
+    level.tiles = (char*)malloc((size_t)width * MAP_HEIGHT);
+    memset(level.tiles, ' ', (size_t)width * MAP_HEIGHT);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        if (rows[y]) memcpy(level.tiles + (size_t)y * width, rows[y], strlen(rows[y]));
+        free(rows[y]);
+    }
+    free(rows);
+    return width > 0;
+}
+
+// 使用内置关卡（去掉右侧空白），横向重复repeat次
+static void load_builtin_level(int repeat) {
+    reset_map();
+    int width = 0;
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int length = (int)strlen(game_map[y]);
+        while (length > 0 && game_map[y][length - 1] == ' ') length--;
+        if (length > width) width = length;
+    }
+    level.width = width * repeat;
+    level.height = MAP_HEIGHT;
+    level.tiles = (char*)malloc((size_t)level.width * MAP_HEIGHT);
+    memset(level.tiles, ' ', (size_t)level.width * MAP_HEIGHT);
+    for (int y = 0; y < MAP_HEIGHT; y++) {
+        int length = (int)strlen(game_map[y]);
+        if (length > width) length = width;
+        for (int r = 0; r < repeat; r++) {
+            memcpy(level.tiles + (size_t)y * level.width + (size_t)r * width, game_map[y], length);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 跳跃包络
+
+// 轨迹中的一帧（坐标相对起跳格子，单位为格）
+typedef struct {
+    signed char x0, x1, y0, y1;  // 碰撞框覆盖的格子范围
+    signed char cx, cy;          // 中心所在格子（拾取和陷阱判定）
+    signed char px0, px1, py;    // 下落时脚下的着地探测格子（上升时py为NO_PROBE）
+} ArcFrame;
+
+typedef struct {
+    int first, count;            // 在frame_pool中的位置
+} Arc;
+
+// 一个落点（中心所在列dx，落地后所站的行dy）
+typedef struct {
+    signed char dx, dy;
+    int arc_count;
+    Arc arcs[ARC_VARIANTS * LAYER_COUNT];
+} ArcTarget;
+
+typedef struct {
+    ArcTarget* targets;
+    int target_count;
+} ArcTable;
+
+static ArcTable tables[LAYER_COUNT];
+static ArcFrame* frame_pool = NULL;
+static int frame_count = 0, frame_capacity = 0;
+
+// 起跳方式
+enum {
+    START_STAND,                 // 原地起跳
+    START_EDGE_RIGHT,            // 站在格子右边缘向右助跑起跳
+    START_EDGE_LEFT,
+    START_WALK_OFF_RIGHT,        // 向右走下平台（不起跳）
+    START_WALK_OFF_LEFT,
+    START_COUNT
+};
+
+// 一条轨迹的操作
+typedef struct {
+    int start;
+    int dir1, dir2;              // 方向（-1左 0不按 1右），switch_tick帧起改为dir2
+    int switch_tick;
+    int jump_tick;               // 二连跳（走下平台时为起跳）的帧，-1表示不跳
+    int dash_tick;               // 冲刺的帧，-1表示不冲刺
+} ArcPlan;
+
+// 与update_knight相同的空中物理（没有地形）
+typedef struct {
+    float x, y, vx, vy, target_vx;
+    int on_ground, double_jump_used, is_dashing, facing_right;
+    int dash_end;                // 冲刺结束的帧（与骑士的冲刺计时器相同）
+} ArcBody;
+
+static int floor_tile(float pixel) {
+    return (int)floorf(pixel / TILE_SIZE);
+}
+
+// 模拟一帧：先处理输入（process_input），再更新速度和位置
+static void arc_step(ArcBody* b, const ArcPlan* plan, int tick, int abilities) {
+    int dir = (plan->switch_tick >= 0 && tick >= plan->switch_tick) ? plan->dir2 : plan->dir1;
+    int standing_jump = tick == 0 && plan->start <= START_EDGE_LEFT;
+    if (!b->is_dashing) b->target_vx = dir * KNIGHT_MAX_SPEED;
+    if (standing_jump || tick == plan->jump_tick) {
+        if (b->on_ground) {
+            b->vy = JUMP_FORCE;
+            b->on_ground = 0;
+            b->double_jump_used = 0;
+        } else if ((abilities & ABILITY_DOUBLE_JUMP) && !b->double_jump_used) {
+            b->vy = JUMP_FORCE;
+            b->double_jump_used = 1;
+        }
+    }
+    if (tick == plan->dash_tick && (abilities & ABILITY_DASH) && !b->is_dashing) {
+        b->is_dashing = 1;
+        b->dash_end = tick + (int)TIMER_TICKS(DASH_DURATION);
+        b->vx = b->facing_right ? DASH_SPEED : -DASH_SPEED;
+    }
+
+    if (b->vx > 0.1f) b->facing_right = 1;
+    else if (b->vx < -0.1f) b->facing_right = 0;
+    if (b->is_dashing && tick >= b->dash_end) b->is_dashing = 0;
+
+    float friction = b->on_ground ? GROUND_FRICTION : AIR_FRICTION;
+    if (b->target_vx > 0) {
+        if (b->vx < b->target_vx) b->vx += KNIGHT_ACCELERATION;
+        else b->vx -= friction;
+    } else if (b->target_vx < 0) {
+        if (b->vx > b->target_vx) b->vx -= KNIGHT_ACCELERATION;
+        else b->vx += friction;
+    } else if (b->vx > 0) {
+        b->vx -= friction;
+        if (b->vx < 0) b->vx = 0;
+    } else if (b->vx < 0) {
+        b->vx += friction;
+        if (b->vx > 0) b->vx = 0;
+    }
+    b->vy += GRAVITY;
+    if (b->vy > MAX_FALL_SPEED) b->vy = MAX_FALL_SPEED;
+    b->x += b->vx;
+    b->y += b->vy;
+    b->on_ground = 0;
+}
+
+// 模拟一条轨迹，把每帧覆盖的格子写入frames（相邻相同的帧合并），返回帧数
+// peaks[i]为到第i帧为止的最高点（像素，越小越高）
+static int simulate_arc(const ArcPlan* plan, int abilities, ArcFrame* frames, float* peaks) {
+    ArcBody b;
+    memset(&b, 0, sizeof(b));
+    b.on_ground = 1;
+    b.facing_right = 1;
+    // 站立时骑士脚底贴着起跳格子的底边
+    b.y = TILE_SIZE - KNIGHT_HEIGHT;
+    switch (plan->start) {
+    case START_STAND: b.x = 0; break;
+    case START_EDGE_RIGHT: b.x = TILE_SIZE - 1; b.vx = KNIGHT_MAX_SPEED; break;
+    case START_EDGE_LEFT: b.x = 1 - KNIGHT_WIDTH; b.vx = -KNIGHT_MAX_SPEED; b.facing_right = 0; break;
+    case START_WALK_OFF_RIGHT: b.x = TILE_SIZE; b.vx = KNIGHT_MAX_SPEED; break;
+    case START_WALK_OFF_LEFT: b.x = -KNIGHT_WIDTH; b.vx = -KNIGHT_MAX_SPEED; b.facing_right = 0; break;
+    }
+
+    int count = 0;
+    float peak = b.y;
+    for (int tick = 0; tick < ARC_MAX_TICKS; tick++) {
+        arc_step(&b, plan, tick, abilities);
+        if (b.y < peak) peak = b.y;
+
+        ArcFrame f;
+        // 水平碰撞检查的是x + width，这里同样多算一个像素
+        f.x0 = (signed char)floor_tile(b.x);
+        f.x1 = (signed char)floor_tile(b.x + KNIGHT_WIDTH);
+        f.y0 = (signed char)floor_tile(b.y);
+        f.y1 = (signed char)floor_tile(b.y + KNIGHT_HEIGHT - 1);
+        f.cx = (signed char)floor_tile(b.x + KNIGHT_WIDTH / 2);
+        f.cy = (signed char)floor_tile(b.y + KNIGHT_HEIGHT / 2);
+        if (b.vy > 0) {
+            f.px0 = (signed char)floor_tile(b.x);
+            f.px1 = (signed char)floor_tile(b.x + KNIGHT_WIDTH - 1);
+            f.py = (signed char)floor_tile(b.y + KNIGHT_HEIGHT);
+        } else {
+            f.px0 = f.px1 = 0;
+            f.py = NO_PROBE;
+        }
+        if (f.cx < -ARC_DX_RANGE || f.cx > ARC_DX_RANGE || (f.py != NO_PROBE && f.py - 1 > ARC_DY_DOWN)) break;
+        if (count > 0 && memcmp(&frames[count - 1], &f, sizeof(f)) == 0) continue;
+        frames[count] = f;
+        peaks[count] = peak;
+        count++;
+    }
+    return count;
+}
+
+// 落点的候选轨迹（第一遍只记录是哪条轨迹的第几帧）
+typedef struct {
+    int plan;                    // -1表示空
+    int frame;                   // 落地所在帧（合并后的下标）
+    float metric;
+} ArcCandidate;
+
+// 候选轨迹的评价（越小越好）：0最低的顶点（适合低矮的天花板），
+// 1最少的帧数（最直接），2顶点最高（适合先升高再越过墙）
+static float candidate_metric(int variant, float peak, int frames) {
+    if (variant == 0) return -peak * 1000.0f + frames;
+    if (variant == 1) return frames * 1000.0f - peak;
+    return peak * 1000.0f + frames;
+}
+
+static ArcPlan* plans = NULL;
+static int plan_count = 0, plan_capacity = 0;
+
+static void add_plan(const ArcPlan* plan) {
+    if (plan_count == plan_capacity) {
+        plan_capacity = plan_capacity ? plan_capacity * 2 : 4096;
+        plans = (ArcPlan*)realloc(plans, sizeof(ArcPlan) * plan_capacity);
+    }
+    plans[plan_count++] = *plan;
+}
+
+// 生成某种能力组合下的所有操作
+static void build_plans(int abilities) {
+    plan_count = 0;
+    for (int start = 0; start < START_COUNT; start++) {
+        int walk_off = start >= START_WALK_OFF_RIGHT;
+        for (int dir1 = -1; dir1 <= 1; dir1++) {
+            for (int switch_tick = -1; switch_tick <= 40; switch_tick += (switch_tick < 0 ? 5 : 4)) {
+                for (int dir2 = -1; dir2 <= 1; dir2++) {
+                    if ((switch_tick < 0) != (dir2 == dir1)) continue;
+                    // 二连跳的时机（走下平台后的第一次跳跃也是二连跳）
+                    int max_jump = (abilities & ABILITY_DOUBLE_JUMP) ? 40 : -1;
+                    for (int jump_tick = -1; jump_tick <= max_jump; jump_tick += (jump_tick < 0 ? (walk_off ? 2 : 5) : 4)) {
+                        int max_dash = (abilities & ABILITY_DASH) ? 36 : -1;
+                        for (int dash_tick = -1; dash_tick <= max_dash; dash_tick += (dash_tick < 0 ? 1 : 4)) {
+                            ArcPlan plan = { start, dir1, dir2, switch_tick, jump_tick, dash_tick };
+                            add_plan(&plan);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 计算一种能力组合的跳跃包络
+static void build_family(int abilities) {
+    build_plans(abilities);
+
+    ArcCandidate* candidates = (ArcCandidate*)malloc(sizeof(ArcCandidate) * ARC_KEY_W * ARC_KEY_H * ARC_VARIANTS);
+    for (int i = 0; i < ARC_KEY_W * ARC_KEY_H * ARC_VARIANTS; i++) candidates[i].plan = -1;
+
+    ArcFrame frames[ARC_MAX_TICKS];
+    float peaks[ARC_MAX_TICKS];
+    for (int p = 0; p < plan_count; p++) {
+        int count = simulate_arc(&plans[p], abilities, frames, peaks);
+        for (int i = 0; i < count; i++) {
+            const ArcFrame* f = &frames[i];
+            if (f->py == NO_PROBE) continue;
+            int dx = f->cx, dy = f->py - 1;
+            if (dy < -ARC_DY_UP || dy > ARC_DY_DOWN) continue;
+            if (dx == 0 && dy == 0) continue; // 落回原地
+            int key = (dy + ARC_DY_UP) * ARC_KEY_W + dx + ARC_DX_RANGE;
+            for (int v = 0; v < ARC_VARIANTS; v++) {
+                ArcCandidate* c = &candidates[key * ARC_VARIANTS + v];
+                float metric = candidate_metric(v, peaks[i], i);
+                if (c->plan < 0 || metric < c->metric) {
+                    c->plan = p;
+                    c->frame = i;
+                    c->metric = metric;
+                }
+            }
+        }
+    }
+
+    // 第二遍：重新模拟选中的轨迹，保存到frame_pool，并加入包含这些能力的每一层
+    // （有更多能力时最优的轨迹会变成冲刺或二连跳，少用能力的轨迹在狭窄地形中仍然有用）
+    for (int key = 0; key < ARC_KEY_W * ARC_KEY_H; key++) {
+        ArcCandidate* c = &candidates[key * ARC_VARIANTS];
+        if (c[0].plan < 0) continue;
+        for (int v = 0; v < ARC_VARIANTS; v++) {
+            // 不同评价选中同一条轨迹时只保存一次
+            int duplicate = 0;
+            for (int u = 0; u < v; u++) {
+                if (c[u].plan == c[v].plan && c[u].frame == c[v].frame) duplicate = 1;
+            }
+            if (duplicate) continue;
+            simulate_arc(&plans[c[v].plan], abilities, frames, peaks);
+            int length = c[v].frame + 1;
+            if (frame_count + length > frame_capacity) {
+                frame_capacity = (frame_count + length) * 2;
+                frame_pool = (ArcFrame*)realloc(frame_pool, sizeof(ArcFrame) * frame_capacity);
+            }
+            memcpy(frame_pool + frame_count, frames, sizeof(ArcFrame) * length);
+            for (int layer = 0; layer < LAYER_COUNT; layer++) {
+                if ((layer & abilities) != abilities) continue;
+                ArcTarget* target = &tables[layer].targets[key];
+                Arc* arc = &target->arcs[target->arc_count++];
+                arc->first = frame_count;
+                arc->count = length;
+            }
+            frame_count += length;
+        }
+    }
+    free(candidates);
+}
+
+// 计算所有层的跳跃包络，去掉没有轨迹的落点
+static void build_tables() {
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        tables[layer].targets = (ArcTarget*)calloc(ARC_KEY_W * ARC_KEY_H, sizeof(ArcTarget));
+        for (int key = 0; key < ARC_KEY_W * ARC_KEY_H; key++) {
+            tables[layer].targets[key].dx = (signed char)(key % ARC_KEY_W - ARC_DX_RANGE);
+            tables[layer].targets[key].dy = (signed char)(key / ARC_KEY_W - ARC_DY_UP);
+        }
+    }
+    for (int abilities = 0; abilities < LAYER_COUNT; abilities++) build_family(abilities);
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        ArcTable* table = &tables[layer];
+        table->target_count = 0;
+        for (int key = 0; key < ARC_KEY_W * ARC_KEY_H; key++) {
+            if (table->targets[key].arc_count > 0) table->targets[table->target_count++] = table->targets[key];
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// 可达性搜索
+
+static int thread_count = 1;
+static SDL_atomic_t* visited = NULL;     // 每个(格子, 能力)一个标记
+static SDL_atomic_t* touched = NULL;     // 每个格子一个标记（奖励方块是否被碰到过）
+
+typedef struct {
+    int index;
+    SDL_Thread* thread;
+    SDL_sem* start;
+    int* next;                   // 本线程发现的下一层节点
+    int next_count, next_capacity;
+    int items[ARC_MAX_TICKS];    // 检查轨迹时经过的奖励方块
+    unsigned long long arcs_checked;
+} Worker;
+
+static Worker workers[MAX_THREADS];
+static SDL_sem* done_sem;
+static int* frontier = NULL;
+static int frontier_count = 0;
+static SDL_atomic_t frontier_cursor;
+static int quitting = 0;
+
+static int node_id(int x, int y, int layer) {
+    return ((y * level.width) + x) * LAYER_COUNT + layer;
+}
+
+// 到达一个站立格子：碰到的奖励方块立即生效
+static void visit(Worker* w, int x, int y, int layer) {
+    char tile = level_tile(x, y);
+    if (is_item(tile)) SDL_AtomicSet(&touched[y * level.width + x], 1);
+    layer |= tile_ability(tile);
+    int id = node_id(x, y, layer);
+    if (SDL_AtomicGet(&visited[id]) || !SDL_AtomicCAS(&visited[id], 0, 1)) return;
+    if (w->next_count == w->next_capacity) {
+        w->next_capacity = w->next_capacity ? w->next_capacity * 2 : 256;
+        w->next = (int*)realloc(w->next, sizeof(int) * w->next_capacity);
+    }
+    w->next[w->next_count++] = id;
+}
+
+// 在(x, y)起跳检查一条轨迹，成立时返回1并写出落点和途中获得的能力
+static int check_arc(Worker* w, int x, int y, const Arc* arc, int* land_x, int* land_y, int* gained) {
+    const ArcFrame* frames = frame_pool + arc->first;
+    const ArcFrame* last = &frames[arc->count - 1];
+
+    // 先看落点：最后一帧脚下必须有实心方块（绝大多数轨迹在这里就被排除）
+    int py = y + last->py;
+    int cx = x + last->cx;
+    int lx;
+    if (solid_at(cx, py)) lx = cx;
+    else if (solid_at(x + last->px0, py)) lx = x + last->px0;
+    else if (solid_at(x + last->px1, py)) lx = x + last->px1;
+    else return 0;
+    if (!standable(lx, py - 1)) return 0;
+
+    int item_count = 0;
+    w->arcs_checked++;
+    for (int i = 0; i < arc->count - 1; i++) {
+        const ArcFrame* f = &frames[i];
+        for (int fy = y + f->y0; fy <= y + f->y1; fy++) {
+            for (int fx = x + f->x0; fx <= x + f->x1; fx++) {
+                if (solid_at(fx, fy)) return 0;
+            }
+        }
+        // 提前着地的轨迹属于别的落点
+        if (f->py != NO_PROBE && (solid_at(x + f->px0, y + f->py) || solid_at(x + f->px1, y + f->py))) return 0;
+        char center = level_tile(x + f->cx, y + f->cy);
+        if (center == 'T') return 0;
+        if (is_item(center)) w->items[item_count++] = (y + f->cy) * level.width + x + f->cx;
+    }
+
+    *gained = 0;
+    for (int i = 0; i < item_count; i++) {
+        SDL_AtomicSet(&touched[w->items[i]], 1);
+        *gained |= tile_ability(level.tiles[w->items[i]]);
+    }
+    *land_x = lx;
+    *land_y = py - 1;
+    return 1;
+}
+
+// 展开一个节点：左右走一格，以及当前能力下的所有轨迹
+static void expand(Worker* w, int id) {
+    int layer = id % LAYER_COUNT;
+    int tile = id / LAYER_COUNT;
+    int x = tile % level.width, y = tile / level.width;
+
+    if (standable(x - 1, y)) visit(w, x - 1, y, layer);
+    if (standable(x + 1, y)) visit(w, x + 1, y, layer);
+
+    const ArcTable* table = &tables[layer];
+    for (int t = 0; t < table->target_count; t++) {
+        const ArcTarget* target = &table->targets[t];
+        int tx = x + target->dx;
+        if (tx < -1 || tx > level.width) continue;
+        for (int a = 0; a < target->arc_count; a++) {
+            int land_x, land_y, gained;
+            if (check_arc(w, x, y, &target->arcs[a], &land_x, &land_y, &gained)) {
+                visit(w, land_x, land_y, layer | gained);
+                break;
+            }
+        }
+    }
+}
+
+// 展开当前层中还没被领取的节点
+static void expand_frontier(Worker* w) {
+    for (;;) {
+        int i = SDL_AtomicAdd(&frontier_cursor, 16);
+        if (i >= frontier_count) break;
+        int end = i + 16 < frontier_count ? i + 16 : frontier_count;
+        for (; i < end; i++) expand(w, frontier[i]);
+    }
+}
+
+static int worker_main(void* data) {
+    Worker* w = (Worker*)data;
+    for (;;) {
+        SDL_SemWait(w->start);
+        if (quitting) break;
+        expand_frontier(w);
+        SDL_SemPost(done_sem);
+    }
+    return 0;
+}
+
+// 从出生点开始的按层广度优先搜索，返回访问的节点数
+static long long search(int start_x, int start_y) {
+    size_t nodes = (size_t)level.width * level.height * LAYER_COUNT;
+    visited = (SDL_atomic_t*)calloc(nodes, sizeof(SDL_atomic_t));
+    touched = (SDL_atomic_t*)calloc((size_t)level.width * level.height, sizeof(SDL_atomic_t));
+    if (!visited || !touched) {
+        printf("内存不足\n");
+        exit(1);
+    }
+
+    visit(&workers[0], start_x, start_y, 0);
+    long long total = 0;
+    int frontier_capacity = 0;
+    for (;;) {
+        // 把各线程发现的节点合并为新的一层
+        int count = 0;
+        for (int t = 0; t < thread_count; t++) count += workers[t].next_count;
+        if (count == 0) break;
+        if (count > frontier_capacity) {
+            frontier_capacity = count * 2;
+            frontier = (int*)realloc(frontier, sizeof(int) * frontier_capacity);
+        }
+        frontier_count = 0;
+        for (int t = 0; t < thread_count; t++) {
+            memcpy(frontier + frontier_count, workers[t].next, sizeof(int) * workers[t].next_count);
+            frontier_count += workers[t].next_count;
+            workers[t].next_count = 0;
+        }
+        total += frontier_count;
+
+        SDL_AtomicSet(&frontier_cursor, 0);
+        if (thread_count == 1 || frontier_count < PARALLEL_MIN_FRONTIER) {
+            expand_frontier(&workers[0]);
+        } else {
+            for (int t = 1; t < thread_count; t++) SDL_SemPost(workers[t].start);
+            expand_frontier(&workers[0]);
+            for (int t = 1; t < thread_count; t++) SDL_SemWait(done_sem);
+        }
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+
+static const char* item_name(char tile) {
+    switch (tile) {
+    case 'F': return "二连跳";
+    case 'D': return "冲刺";
+    case 'S': return "存档点";
+    case 't': return "终点";
+    }
+    return "?";
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    int repeat = 1;
+    thread_count = SDL_GetCPUCount();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-f") == 0) path = argv[i + 1];
+        else if (strcmp(argv[i], "-r") == 0) repeat = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0) thread_count = atoi(argv[i + 1]);
+        else {
+            printf("未知参数: %s\n", argv[i]);
+            printf("用法: %s [-f 关卡文件] [-r 重复次数] [-t 线程数]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+    if (repeat < 1) repeat = 1;
+
+    if (path) {
+        if (!load_level_file(path)) return 1;
+        if (repeat > 1) {
+            // 文件关卡同样支持重复
+            Level single = level;
+            level.width = single.width * repeat;
+            level.tiles = (char*)malloc((size_t)level.width * level.height);
+            for (int y = 0; y < level.height; y++) {
+                for (int r = 0; r < repeat; r++) {
+                    memcpy(level.tiles + (size_t)y * level.width + (size_t)r * single.width,
+                           single.tiles + (size_t)y * single.width, single.width);
+                }
+            }
+            free(single.tiles);
+        }
+    } else {
+        load_builtin_level(repeat);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    build_tables();
+    double build_ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+
+    static const char* layer_names[LAYER_COUNT] = { "无能力", "二连跳", "冲刺", "二连跳+冲刺" };
+    printf("关卡 %d 列 × %d 行，%d 个线程\n", level.width, level.height, thread_count);
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        int rise = 0, reach = 0, arcs = 0;
+        for (int t = 0; t < tables[layer].target_count; t++) {
+            const ArcTarget* target = &tables[layer].targets[t];
+            if (-target->dy > rise) rise = -target->dy;
+            if (target->dy == 0 && abs(target->dx) > reach) reach = abs(target->dx);
+            arcs += target->arc_count;
+        }
+        printf("跳跃包络（%s）: 最高上升 %d 格，同一高度最远 %d 格，%d 个落点，%d 条轨迹\n",
+               layer_names[layer], rise, reach, tables[layer].target_count, arcs);
+    }
+
+    // 出生点：与init_knight相同，从(2, 6)格向下落到第一个能站立的格子
+    int start_x = 2, start_y = -1;
+    for (int y = 6; y < level.height; y++) {
+        if (standable(start_x, y)) {
+            start_y = y;
+            break;
+        }
+    }
+    if (start_y < 0) {
+        printf("出生点下方没有可以站立的格子\n");
+        return 1;
+    }
+
+    done_sem = SDL_CreateSemaphore(0);
+    for (int t = 0; t < thread_count; t++) {
+        workers[t].index = t;
+        if (t == 0) continue; // 主线程充当0号线程
+        workers[t].start = SDL_CreateSemaphore(0);
+        workers[t].thread = SDL_CreateThread(worker_main, "validate_worker", &workers[t]);
+        if (!workers[t].thread) {
+            printf("无法创建线程: %s\n", SDL_GetError());
+            return 1;
+        }
+    }
+
+    Uint64 search_start = SDL_GetPerformanceCounter();
+    long long nodes = search(start_x, start_y);
+    double search_ms = (double)(SDL_GetPerformanceCounter() - search_start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    unsigned long long arcs_checked = 0;
+    for (int t = 0; t < thread_count; t++) arcs_checked += workers[t].arcs_checked;
+
+    int items = 0, unreachable = 0;
+    for (int y = 0; y < level.height; y++) {
+        for (int x = 0; x < level.width; x++) {
+            char tile = level_tile(x, y);
+            if (!is_item(tile)) continue;
+            items++;
+            if (!SDL_AtomicGet(&touched[y * level.width + x])) {
+                if (unreachable < 50) printf("不可到达: %s (%d, %d)\n", item_name(tile), x, y);
+                unreachable++;
+            }
+        }
+    }
+    printf("包络计算 %.1f ms，搜索 %.1f ms（%lld 个状态，检查 %llu 条轨迹）\n",
+           build_ms, search_ms, nodes, arcs_checked);
+    if (unreachable) {
+        printf("%d 个方块中有 %d 个不可到达\n", items, unreachable);
+    } else {
+        printf("全部 %d 个方块都可以到达\n", items);
+    }
+
+    quitting = 1;
+    for (int t = 1; t < thread_count; t++) SDL_SemPost(workers[t].start);
+    for (int t = 1; t < thread_count; t++) SDL_WaitThread(workers[t].thread, NULL);
+    return unreachable ? 1 : 0;
+}
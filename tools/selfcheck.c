@@ -0,0 +1,339 @@
+// selfcheck.c
+// 模块自检工具：检查回溯、读档、联机回滚、计时器、分页关卡、动画片段表和绘制队列
+// 这些不在物理回归场景里的部分
+//
+// 用法：
+//   selfcheck [录像文件]   默认使用golden/full_run.input，每项检查输出[通过]/[失败]，
+//                          有失败时返回1
+//
+// 检查过程中会在当前目录写几个临时文件（selfcheck.*），结束时删除。
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <SDL.h>
+#include "game.h"
+#include "input.h"
+#include "camera.h"
+#include "knight.h"
+#include "blocks.h"
+#include "map.h"
+#include "ui.h"
+#include "replay.h"
+#include "statehash.h"
+#include "snapshot.h"
+#include "rewind.h"
+#include "timer.h"
+#include "tilepage.h"
+#include "anim.h"
+#include "drawlist.h"
+
+#define REWIND_CHECK_TICKS 300     // 回溯检查前进和倒退的帧数
+#define QUICKLOAD_CHECK_TICKS 120  // 读档检查在存档后模拟的帧数
+#define ROLLBACK_CHECK_TICKS 10    // 联机检查中待确认的帧数
+#define LEVEL_PAGES (TILEPAGE_RESIDENT * 4) // 分页关卡检查的页数（常驻页的4倍）
+#define LEVEL_EDIT_STEP 3          // 每隔几列改一格
+
+#define TEMP_RECORD "selfcheck.input"
+#define TEMP_HASH_LOG "selfcheck.hash"
+#define TEMP_LEVEL "selfcheck.klv"
+#define TEMP_ANIM_TABLE "selfcheck.anim"
+
+static unsigned char masks[REPLAY_MAX_TICKS];
+static int mask_count = 0;
+static unsigned char buffer[SNAPSHOT_MAX_SIZE];
+static uint64_t hashes[REWIND_CHECK_TICKS + 1];
+static int failures = 0;
+
+static void report(const char* name, int passed) {
+    printf("[%s] %s\n", passed ? "通过" : "失败", name);
+    if (!passed) failures++;
+}
+
+// 重新开始一局
+static void start_run() {
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+}
+
+// 按录像第index帧的按键模拟一帧（录像结束后没有按键）
+static void step(int index) {
+    set_input_mask(index < mask_count ? masks[index] : 0);
+    game_tick();
+}
+
+// 前进若干帧并逐帧保存历史，再逐帧倒退，每一帧的世界状态哈希都应与前进时相同
+static int check_rewind() {
+    start_run();
+    rewind_reset();
+    rewind_push();
+    hashes[0] = game_get_world_hash()->total;
+    unsigned int first = game_get_tick();
+    for (int i = 0; i < REWIND_CHECK_TICKS; i++) {
+        step(i);
+        rewind_push();
+        hashes[i + 1] = game_get_world_hash()->total;
+    }
+    for (int i = REWIND_CHECK_TICKS - 1; i >= 0; i--) {
+        if (!rewind_step_back()) return 0;
+        if (game_get_tick() != first + (unsigned int)i || game_get_world_hash()->total != hashes[i]) return 0;
+    }
+    return !rewind_step_back(); // 已经回到最早一帧
+}
+
+// 录制、回放或写哈希日志时不能回溯和读档，关闭后恢复
+static int check_restore_gate() {
+    if (!snapshot_can_restore()) return 0;
+    int ok = 1;
+    if (replay_record_begin(TEMP_RECORD)) {
+        ok &= !snapshot_can_restore();
+        replay_record_end();
+    } else {
+        ok = 0;
+    }
+    ok &= snapshot_can_restore();
+    if (replay_play_begin(TEMP_RECORD)) {
+        ok &= !snapshot_can_restore();
+        replay_play_end();
+    } else {
+        ok = 0;
+    }
+    if (statehash_log_begin(TEMP_HASH_LOG)) {
+        ok &= !snapshot_can_restore();
+        statehash_log_end();
+    } else {
+        ok = 0;
+    }
+    remove(TEMP_RECORD);
+    remove(TEMP_HASH_LOG);
+    return ok && snapshot_can_restore();
+}
+
+// 存档后继续模拟，读档后再按同样的按键模拟，结果应相同
+static int check_quickload() {
+    start_run();
+    for (int i = 0; i < QUICKLOAD_CHECK_TICKS; i++) step(i);
+    if (!quicksave_save(0)) return 0;
+    unsigned int saved_tick = game_get_tick();
+    uint64_t saved_hash = game_get_world_hash()->total;
+    for (int i = 0; i < QUICKLOAD_CHECK_TICKS; i++) step(QUICKLOAD_CHECK_TICKS + i);
+    uint64_t expected = game_get_world_hash()->total;
+
+    if (!quicksave_load(0)) return 0;
+    if (game_get_tick() != saved_tick || game_get_world_hash()->total != saved_hash) return 0;
+    for (int i = 0; i < QUICKLOAD_CHECK_TICKS; i++) step(QUICKLOAD_CHECK_TICKS + i);
+    return game_get_world_hash()->total == expected;
+}
+
+// 没有在到期那一帧检查的计时器下一次检查时到期（只到期一次）；恢复快照后到期帧和时钟
+// 一起回到过去，再次经过到期帧时照常到期
+static int check_timers() {
+    start_run();
+    GameCounters counters;
+    int ok = 1;
+    timer_start(&knight.hurt_timer, 30);
+    size_t size = snapshot_save(buffer, sizeof(buffer));
+    if (size == 0) return 0;
+
+    game_get_counters(&counters);
+    counters.tick += 40; // 跳过到期帧
+    game_set_counters(&counters);
+    ok &= !timer_running(knight.hurt_timer);
+    ok &= timer_expired(&knight.hurt_timer);
+    ok &= !timer_expired(&knight.hurt_timer);
+
+    if (!snapshot_load(buffer, size)) return 0;
+    ok &= timer_running(knight.hurt_timer);
+    game_get_counters(&counters);
+    counters.tick += 40;
+    game_set_counters(&counters);
+    ok &= timer_expired(&knight.hurt_timer);
+    return ok;
+}
+
+// 联机回滚：待确认帧的哈希日志先挂起，回滚时丢弃，重新模拟并确认后只写出一次
+static int check_rollback_output() {
+    start_run();
+    if (!statehash_log_begin(TEMP_HASH_LOG)) return 0;
+    size_t size = snapshot_save(buffer, sizeof(buffer));
+    unsigned int first = game_get_tick();
+
+    // 先按错误的预测（没有按键）模拟，然后丢弃
+    for (int i = 0; i < ROLLBACK_CHECK_TICKS; i++) {
+        game_set_pending_tick(first + (unsigned int)i);
+        set_input_mask(0);
+        game_tick();
+    }
+    game_discard_output(first);
+
+    // 回滚后按确认的按键重新模拟
+    snapshot_load(buffer, size);
+    for (int i = 0; i < ROLLBACK_CHECK_TICKS; i++) {
+        game_set_pending_tick(first + (unsigned int)i);
+        step(i);
+        hashes[i] = game_get_world_hash()->total;
+    }
+    game_set_pending_tick(GAME_TICK_CONFIRMED);
+    game_commit_output(first + ROLLBACK_CHECK_TICKS);
+    statehash_log_end();
+
+    FILE* file = fopen(TEMP_HASH_LOG, "r");
+    if (!file) return 0;
+    char line[256];
+    int count = 0, ok = size > 0;
+    while (fgets(line, sizeof(line), file)) {
+        unsigned int tick;
+        unsigned long long total;
+        if (line[0] == '#' || sscanf(line, "%u %llx", &tick, &total) != 2) continue;
+        ok &= count < ROLLBACK_CHECK_TICKS && tick == first + (unsigned int)count + 1 && total == hashes[count];
+        count++;
+    }
+    fclose(file);
+    remove(TEMP_HASH_LOG);
+    return ok && count == ROLLBACK_CHECK_TICKS;
+}
+
+// 写一个全空的分页关卡文件
+static int write_empty_level(const char* path, int pages) {
+    TilePageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = TILEPAGE_MAGIC;
+    header.version = TILEPAGE_VERSION;
+    header.width = (uint32_t)(pages * TILEPAGE_COLUMNS);
+    header.height = MAP_HEIGHT;
+    header.page_columns = TILEPAGE_COLUMNS;
+    header.page_count = (uint32_t)pages;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return 0;
+    static const unsigned char empty_page[TILEPAGE_BYTES];
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; i < pages && ok; i++) {
+        ok = fwrite(empty_page, sizeof(empty_page), 1, file) == 1;
+    }
+    fclose(file);
+    return ok;
+}
+
+// 分页关卡：改动分布在远多于常驻页的页上（改动表也会扩容），页被淘汰后重新载入时
+// 改动都还在；分页关卡打开时不能回溯和读档
+static int check_tilepage_edits() {
+    if (!write_empty_level(TEMP_LEVEL, LEVEL_PAGES) || !tilepage_open(TEMP_LEVEL)) {
+        remove(TEMP_LEVEL);
+        return 0;
+    }
+    int width = tilepage_width(), edits = 0, ok = !snapshot_can_restore();
+    for (int x = 0; x < width; x += LEVEL_EDIT_STEP) {
+        tilepage_set(x, x % MAP_HEIGHT, BLOCK_NORMAL);
+        edits++;
+    }
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            int edited = x % LEVEL_EDIT_STEP == 0 && y == x % MAP_HEIGHT;
+            ok &= tilepage_get(x, y) == (edited ? BLOCK_NORMAL : BLOCK_NONE);
+        }
+    }
+    TilePageStats stats;
+    tilepage_get_stats(&stats);
+    ok &= edits > TILEPAGE_EDIT_INITIAL && stats.edit_count == edits && stats.evictions > 0;
+
+    tilepage_reset();
+    for (int x = 0; x < width; x += LEVEL_EDIT_STEP) {
+        ok &= tilepage_get(x, x % MAP_HEIGHT) == BLOCK_NONE;
+    }
+    tilepage_close();
+    remove(TEMP_LEVEL);
+    return ok && snapshot_can_restore();
+}
+
+// 写一行片段的片段表并尝试载入
+static int load_anim_table(SDL_Renderer* renderer, const char* pattern) {
+    FILE* file = fopen(TEMP_ANIM_TABLE, "w");
+    if (!file) return -1;
+    fprintf(file, "player_idle 4 6 loop %s\n", pattern);
+    fclose(file);
+    int result = anim_load(renderer, TEMP_ANIM_TABLE);
+    remove(TEMP_ANIM_TABLE);
+    return result;
+}
+
+// 动画片段表：内置片段表可以载入；帧文件名模板必须正好包含一个%d
+static int check_anim_table(SDL_Renderer* renderer) {
+    int ok = anim_load(renderer, ANIM_TABLE_PATH) == 1;
+    int clip = anim_find_clip("player_run");
+    ok &= clip >= 0 && anim_get_clip(clip)->frame_count == 16;
+    anim_unload();
+
+    static const char* bad_patterns[] = {
+        "assets/sprites/player/player_idle%s.png",
+        "assets/sprites/player/player_idle%d%d.png",
+        "assets/sprites/player/player_idle%n.png",
+        "assets/sprites/player/player_idle.png",
+        "assets/sprites/player/player_idle%d.png%",
+    };
+    for (int i = 0; i < (int)(sizeof(bad_patterns) / sizeof(bad_patterns[0])); i++) {
+        ok &= load_anim_table(renderer, bad_patterns[i]) == 0;
+    }
+    ok &= load_anim_table(renderer, "assets/sprites/player/player_idle%d.png") == 1;
+    anim_unload();
+    return ok;
+}
+
+// 绘制队列：先按图层、再按纹理排序，同一纹理的连续命令合成一批；视野外的命令被剔除
+static int check_drawlist(SDL_Renderer* renderer) {
+    SDL_Texture* a = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 16, 16);
+    SDL_Texture* b = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, 16, 16);
+    if (!a || !b) return 0;
+
+    DrawStats before, after;
+    drawlist_get_stats(&before);
+    SDL_Rect source = { 0, 0, 16, 16 };
+    SDL_Rect dest = { 16, 16, 16, 16 };
+    SDL_Rect outside = { CAMERA_LOGICAL_WIDTH + 16, 16, 16, 16 };
+    drawlist_begin(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+    // 放入顺序交替使用两张纹理：按放入顺序画要切换5次纹理，排序后是 a | b b | a 三批
+    drawlist_texture(DRAW_LAYER_PLAYERS, 0, a, &source, &dest, 0);
+    drawlist_texture(DRAW_LAYER_TILES, 0, b, &source, &dest, 0);
+    drawlist_texture(DRAW_LAYER_TILES, 0, a, &source, &dest, 1);
+    drawlist_texture(DRAW_LAYER_TILES, 0, b, &source, &dest, 0);
+    drawlist_texture(DRAW_LAYER_TILES, 0, a, &source, &outside, 0);
+    drawlist_submit(renderer);
+    drawlist_get_stats(&after);
+
+    SDL_DestroyTexture(a);
+    SDL_DestroyTexture(b);
+    return after.commands - before.commands == 4 && after.runs - before.runs == 3 &&
+           after.culled - before.culled == 1 && after.frames - before.frames == 1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* input_path = argc > 1 ? argv[1] : "golden/full_run.input";
+    mask_count = replay_load(input_path, masks, REPLAY_MAX_TICKS);
+    if (mask_count < 0) return 1;
+
+    init_input();
+    init_camera(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+
+    report("时间回溯：倒退的每一帧与前进时一致", check_rewind());
+    report("录制、回放、写哈希日志时不能回溯和读档", check_restore_gate());
+    report("读档后按同样的按键模拟，结果与存档后直接模拟一致", check_quickload());
+    report("计时器：跳过到期帧后仍到期一次，恢复快照后重新到期", check_timers());
+    report("联机回滚：丢弃预测帧的哈希，确认后每帧只写出一次", check_rollback_output());
+    report("分页关卡：超出常驻页的改动在页重新载入后仍然有效", check_tilepage_edits());
+
+    // 动画和绘制队列用软件渲染器检查（不需要窗口）
+    SDL_Surface* surface = SDL_CreateRGBSurface(0, CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT, 32, 0, 0, 0, 0);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (renderer) {
+        report("动画片段表：帧文件名模板校验", check_anim_table(renderer));
+        report("绘制队列：按图层和纹理排序成批提交", check_drawlist(renderer));
+        SDL_DestroyRenderer(renderer);
+    } else {
+        printf("无法创建软件渲染器: %s\n", SDL_GetError());
+        failures++;
+    }
+    if (surface) SDL_FreeSurface(surface);
+
+    printf("%d 项检查失败\n", failures);
+    return failures > 0 ? 1 : 0;
+}
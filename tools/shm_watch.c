@@ -0,0 +1,139 @@
+// shm_watch.c
+// 共享内存状态查看工具：读取游戏导出的每帧状态，也可以通过按键接管通道控制骑士
+//
+// 用法：
+//   shm_watch 名称 [-i 按键掩码] [-n 次数] [-p 间隔毫秒]
+//   名称与游戏的 --shm 参数相同。
+//   -i  接管按键（INPUT_BIT位掩码：1=左 2=右 4=跳 32=冲刺），退出时交还键盘
+//   -n  打印多少次后退出（默认一直运行，Ctrl+C退出）
+//   -p  打印间隔（默认200毫秒）
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "shm_export.h"
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+// 按顺序锁协议写入按键接管通道
+static void write_override(ShmRegion* region, uint32_t active, uint32_t mask) {
+    ShmOverride* channel = &region->input_override;
+    uint32_t seq = __atomic_load_n(&channel->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&channel->active, active, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->mask, mask, __ATOMIC_RELAXED);
+    __atomic_store_n(&channel->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// 读取最新一帧，成功返回1；retries累计因写入冲突而重读的次数
+static int read_latest(const ShmRegion* region, ShmFrame* out, unsigned int* retries) {
+    for (int attempt = 0; attempt < 100; attempt++) {
+        uint64_t published = __atomic_load_n(&region->published, __ATOMIC_ACQUIRE);
+        if (published == 0) return 0;
+        const ShmSlot* slot = &region->slots[(published - 1) % SHM_EXPORT_RING];
+        uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if ((before & 1) == 0) {
+            memcpy(out, (const void*)&slot->frame, sizeof(*out));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == before) {
+                return 1;
+            }
+        }
+        (*retries)++;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("用法: %s 名称 [-i 按键掩码] [-n 次数] [-p 间隔毫秒]\n", argv[0]);
+        return 1;
+    }
+    int override = 0;
+    unsigned int override_mask = 0;
+    long count = -1;
+    long period_ms = 200;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-i") == 0) {
+            override = 1;
+            override_mask = (unsigned int)strtoul(argv[i + 1], NULL, 0);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            count = atol(argv[i + 1]);
+        } else if (strcmp(argv[i], "-p") == 0) {
+            period_ms = atol(argv[i + 1]);
+        } else {
+            printf("未知参数: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "/%s", argv[1][0] == '/' ? argv[1] + 1 : argv[1]);
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        printf("无法打开共享内存 %s（游戏是否以 --shm 启动？）\n", name);
+        return 1;
+    }
+    void* memory = mmap(NULL, sizeof(ShmRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+        printf("无法映射共享内存 %s\n", name);
+        return 1;
+    }
+    ShmRegion* region = (ShmRegion*)memory;
+    if (__atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) != SHM_EXPORT_MAGIC ||
+        region->version != SHM_EXPORT_VERSION || region->header_size != sizeof(ShmRegion)) {
+        printf("共享内存布局不匹配（版本 %u，大小 %u）\n", region->version, region->header_size);
+        munmap(memory, sizeof(ShmRegion));
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+    if (override) {
+        write_override(region, 1, override_mask);
+        printf("已接管按键: 0x%x\n", override_mask);
+    }
+
+    unsigned int retries = 0;
+    uint64_t last_published = 0;
+    struct timespec period = { period_ms / 1000, (period_ms % 1000) * 1000000L };
+    while (!stop && count != 0) {
+        ShmFrame frame;
+        uint64_t published = __atomic_load_n(&region->published, __ATOMIC_ACQUIRE);
+        if (published != last_published && read_latest(region, &frame, &retries)) {
+            int alive = 0;
+            for (uint32_t i = 0; i < frame.enemy_count && i < SHM_EXPORT_MAX_ENEMIES; i++) {
+                alive += frame.enemies[i].alive != 0;
+            }
+            printf("帧 %6u  骑士 (%7.1f, %6.1f) 速度 (%5.2f, %5.2f) 着地 %d 生命 %d  按键 0x%02x  敌人 %u/%u  摄像机 (%.1f, %.1f)  重读 %u\n",
+                   frame.tick, frame.knight_x, frame.knight_y, frame.knight_vx, frame.knight_vy,
+                   frame.on_ground, frame.lives, frame.input_mask, alive, frame.enemy_count,
+                   frame.camera_x, frame.camera_y, retries);
+            fflush(stdout);
+            last_published = published;
+            if (count > 0) count--;
+        }
+        nanosleep(&period, NULL);
+    }
+
+    if (override) {
+        write_override(region, 0, 0);
+        printf("已交还键盘控制\n");
+    }
+    munmap(memory, sizeof(ShmRegion));
+    return 0;
+}
@@ -0,0 +1,93 @@
+// snapshot_bench.c
+// 快照性能测试工具：测量快照大小和保存/恢复耗时，并验证恢复后的模拟结果一致
+//
+// 用法：
+//   snapshot_bench [录像文件] [次数]   默认使用golden/full_run.input，重复100000次
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL.h>
+#include "game.h"
+#include "input.h"
+#include "camera.h"
+#include "ui.h"
+#include "replay.h"
+#include "snapshot.h"
+
+#define VERIFY_TICKS 200  // 恢复后重新模拟的帧数
+
+static unsigned char masks[REPLAY_MAX_TICKS];
+static unsigned char buffer[SNAPSHOT_MAX_SIZE];
+static unsigned char scratch[SNAPSHOT_MAX_SIZE];
+
+// 从第start帧开始模拟count帧（离开游戏状态时停止），返回实际模拟帧数
+static int simulate(int start, int count, int total) {
+    int ticks = 0;
+    for (int i = start; i < start + count && i < total; i++) {
+        if (get_game_state() != GAME_STATE_PLAYING) break;
+        set_input_mask(masks[i]);
+        game_tick();
+        ticks++;
+    }
+    return ticks;
+}
+
+static double elapsed_ns(Uint64 start, Uint64 end) {
+    return (double)(end - start) * 1e9 / (double)SDL_GetPerformanceFrequency();
+}
+
+int main(int argc, char* argv[]) {
+    const char* input_path = argc > 1 ? argv[1] : "golden/full_run.input";
+    int iterations = argc > 2 ? atoi(argv[2]) : 100000;
+    if (iterations <= 0) iterations = 1;
+    
+    int count = replay_load(input_path, masks, REPLAY_MAX_TICKS);
+    if (count < 0) return 1;
+    
+    init_input();
+    init_camera(CAMERA_LOGICAL_WIDTH, CAMERA_LOGICAL_HEIGHT);
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    
+    // 先模拟到录像中间，使快照包含敌人状态和地图改动
+    int middle = simulate(0, count / 2, count);
+    size_t size = snapshot_save(buffer, sizeof(buffer));
+    if (size == 0) {
+        printf("快照保存失败\n");
+        return 1;
+    }
+    printf("录像 %s：在第 %d 帧保存快照，大小 %u 字节\n", input_path, middle, (unsigned int)size);
+    
+    // 不经过快照直接继续模拟，作为验证的期望结果
+    int ticks = simulate(middle, VERIFY_TICKS, count);
+    WorldHash expected = *game_get_world_hash();
+    
+    // 保存耗时
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++) {
+        snapshot_save(scratch, sizeof(scratch));
+    }
+    Uint64 end = SDL_GetPerformanceCounter();
+    printf("保存：%d 次，平均 %.1f ns\n", iterations, elapsed_ns(start, end) / iterations);
+    
+    // 恢复耗时
+    start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < iterations; i++) {
+        snapshot_load(buffer, size);
+    }
+    end = SDL_GetPerformanceCounter();
+    printf("恢复：%d 次，平均 %.1f ns\n", iterations, elapsed_ns(start, end) / iterations);
+    
+    // 验证：恢复快照后重新模拟，结果必须与直接模拟完全一致
+    snapshot_load(buffer, size);
+    simulate(middle, VERIFY_TICKS, count);
+    WorldHash actual = *game_get_world_hash();
+    
+    if (expected.total != actual.total) {
+        printf("[失败] 恢复快照后模拟 %d 帧，状态哈希不一致：%016llx / %016llx\n", ticks,
+               (unsigned long long)expected.total, (unsigned long long)actual.total);
+        return 1;
+    }
+    printf("[通过] 恢复快照后模拟 %d 帧，状态哈希一致 %016llx\n", ticks, (unsigned long long)actual.total);
+    return 0;
+}
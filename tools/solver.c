@@ -0,0 +1,500 @@
+// solver.c
+// 速通求解工具：在确定性模拟上做束搜索，寻找从出生点到通关方块最快的按键序列
+//
+// 用法：
+//   solver [-w 束宽] [-k 每步帧数] [-t 线程数] [-g 最大步数] [-o 输出录像]
+//   默认 -w 1000 -k 3 -t CPU核心数 -g 1000 -o solver.input
+//
+// 每一步对束中的每个状态尝试所有动作（按键组合，持续k帧），用状态快照克隆世界。
+// 子状态按世界状态哈希去重，每个格子（位置、能力、运动方向）先保留一个代表，
+// 再按启发式分数（向右的进度和已获得的能力）补满束宽，进入下一步。
+// 第一次有子状态通关时，取其中帧数最少的一条输出为录像文件（可用 --replay 回放）。
+//
+// 需要以WORLD_THREAD_LOCAL编译（make solver）：每个工作线程有独立的世界。
+// 父状态按线程平均分段，线程处理完自己的一段后从其他线程的段中窃取，直到全部处理完。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "game.h"
+#include "knight.h"
+#include "input.h"
+#include "map.h"
+#include "ui.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "hash.h"
+#include "statehash.h"
+#include "events.h"
+
+// 可选动作（按键位掩码）
+static const unsigned int ACTIONS[] = {
+    INPUT_BIT(INPUT_RIGHT),
+    INPUT_BIT(INPUT_RIGHT) | INPUT_BIT(INPUT_JUMP),
+    INPUT_BIT(INPUT_RIGHT) | INPUT_BIT(INPUT_DASH),
+    INPUT_BIT(INPUT_RIGHT) | INPUT_BIT(INPUT_JUMP) | INPUT_BIT(INPUT_DASH),
+    0,
+    INPUT_BIT(INPUT_JUMP),
+    INPUT_BIT(INPUT_LEFT),
+    INPUT_BIT(INPUT_LEFT) | INPUT_BIT(INPUT_JUMP),
+};
+#define ACTION_COUNT ((int)(sizeof(ACTIONS) / sizeof(ACTIONS[0])))
+
+#define CELL_CAP 6               // 每个格子最多保留的状态数
+#define CELL_ROWS 32
+#define CELL_COUNT (MAP_WIDTH * CELL_ROWS * 4 * 8)
+#define MAX_THREADS 64
+
+// 一个子状态
+typedef struct {
+    uint64_t hash;
+    float score;
+    int parent;                  // 父状态在束中的下标
+    unsigned char action;
+    unsigned char won_ticks;     // 通关时为这一步用掉的帧数，否则为0
+    unsigned short cell;         // 所在格子（x）
+    unsigned char cell_y;
+    unsigned char abilities;     // 位0二连跳，位1冲刺
+    unsigned char motion;        // 水平方向（0左 1静止 2右）*2 + 是否着地
+    unsigned char duplicate;     // 选择时使用
+    unsigned char selected;
+    int worker;                  // 快照所在的线程缓冲区
+    size_t offset;
+    size_t size;
+} Child;
+
+// 每个线程的任务段和输出
+typedef struct {
+    int index;
+    SDL_Thread* thread;
+    SDL_sem* start;
+    SDL_atomic_t cursor;         // 下一个要处理的父状态（本线程和窃取者共用）
+    int end;
+    Child* children;
+    int child_count, child_capacity;
+    unsigned char* arena;        // 子状态快照
+    size_t arena_used, arena_capacity;
+    unsigned long long ticks;    // 模拟的逻辑帧数
+    unsigned int steals;         // 从其他线程窃取的父状态数
+} Worker;
+
+static Worker workers[MAX_THREADS];
+static int thread_count = 1;
+static SDL_sem* done_sem;
+static int quitting = 0;
+static SDL_atomic_t load_failed;     // 有线程恢复快照失败（这一步的结果不可用）
+
+// 当前一步的参数（主线程写入后发信号）
+static unsigned char* beam = NULL;   // 父状态快照，每个占SNAPSHOT_MAX_SIZE
+static size_t* beam_sizes = NULL;
+static int beam_count = 0;
+static int ticks_per_step = 3;
+static int root_lives = 0;
+
+// 追加一个子状态（只在所属线程中调用）
+static void push_child(Worker* w, const Child* child, const unsigned char* data) {
+    if (w->child_count == w->child_capacity) {
+        w->child_capacity = w->child_capacity ? w->child_capacity * 2 : 1024;
+        w->children = (Child*)realloc(w->children, sizeof(Child) * w->child_capacity);
+    }
+    if (w->arena_used + child->size > w->arena_capacity) {
+        w->arena_capacity = w->arena_capacity ? w->arena_capacity * 2 : (1 << 20);
+        while (w->arena_used + child->size > w->arena_capacity) w->arena_capacity *= 2;
+        w->arena = (unsigned char*)realloc(w->arena, w->arena_capacity);
+    }
+    if (!w->children || !w->arena) {
+        printf("内存不足\n");
+        exit(1);
+    }
+    Child* out = &w->children[w->child_count++];
+    *out = *child;
+    out->worker = w->index;
+    out->offset = w->arena_used;
+    memcpy(w->arena + w->arena_used, data, child->size);
+    w->arena_used += child->size;
+}
+
+// 取下一个父状态：先取自己的段，取完后依次从其他线程的段中窃取
+static int take_parent(Worker* w) {
+    for (int k = 0; k < thread_count; k++) {
+        Worker* victim = &workers[(w->index + k) % thread_count];
+        if (SDL_AtomicGet(&victim->cursor) >= victim->end) continue;
+        int i = SDL_AtomicAdd(&victim->cursor, 1);
+        if (i < victim->end) {
+            if (k > 0) w->steals++;
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 启发式分数：向右的进度为主，获得能力给予奖励（关卡后段需要二连跳和冲刺）
+static float score_state() {
+    float score = knight.x;
+    if (knight.can_dash) score += 2000.0f;
+    if (knight.can_double_jump) score += 500.0f;
+    return score;
+}
+
+// 展开一个父状态的所有动作
+static void expand(Worker* w, int parent) {
+    unsigned char snapshot[SNAPSHOT_MAX_SIZE];
+    for (int a = 0; a < ACTION_COUNT; a++) {
+        if (!snapshot_load(beam + (size_t)parent * SNAPSHOT_MAX_SIZE, beam_sizes[parent])) {
+            printf("线程%d: 无法恢复父状态%d的快照\n", w->index, parent);
+            SDL_AtomicSet(&load_failed, 1);
+            return;
+        }
+
+        Child child;
+        memset(&child, 0, sizeof(child));
+        child.parent = parent;
+        child.action = (unsigned char)a;
+        int dead = 0;
+        for (int t = 1; t <= ticks_per_step; t++) {
+            set_input_mask(ACTIONS[a]);
+            game_tick();
+            w->ticks++;
+            KnightProgress progress;
+            knight_get_progress(&progress);
+            if (progress.game_won) {
+                child.won_ticks = (unsigned char)t;
+                break;
+            }
+            if (knight.lives < root_lives || get_game_state() != GAME_STATE_PLAYING) {
+                dead = 1;
+                break;
+            }
+        }
+        if (dead) continue;
+
+        // 去重哈希只包括骑士、敌人和地图（摄像机不影响模拟）
+        const WorldHash* hash = game_get_world_hash();
+        uint64_t parts[3] = { hash->knight, hash->enemies, hash->map };
+        child.hash = hash64(parts, sizeof(parts), 0);
+        child.score = score_state();
+        int cell_x = (int)(knight.x / TILE_SIZE);
+        int cell_y = (int)(knight.y / TILE_SIZE);
+        child.cell = (unsigned short)(cell_x < 0 ? 0 : cell_x);
+        child.cell_y = (unsigned char)(cell_y < 0 ? 0 : cell_y >= CELL_ROWS ? CELL_ROWS - 1 : cell_y);
+        child.abilities = (unsigned char)((knight.can_double_jump ? 1 : 0) | (knight.can_dash ? 2 : 0));
+        int direction = knight.vx < -0.5f ? 0 : (knight.vx > 0.5f ? 2 : 1);
+        child.motion = (unsigned char)(direction * 2 + (knight.on_ground ? 1 : 0));
+        child.size = snapshot_save(snapshot, sizeof(snapshot));
+        push_child(w, &child, snapshot);
+    }
+}
+
+// 工作线程
+static int worker_main(void* data) {
+    Worker* w = (Worker*)data;
+    events_set_dropping(1); // 工作线程的世界没有界面和声音，只保留游戏状态切换
+    // 快照只恢复动态状态，出生点、巡逻和触发器索引是每个线程自己的，要先完整重置一次
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    for (;;) {
+        SDL_SemWait(w->start);
+        if (quitting) break;
+        int parent;
+        while (!SDL_AtomicGet(&load_failed) && (parent = take_parent(w)) >= 0) {
+            expand(w, parent);
+        }
+        SDL_SemPost(done_sem);
+    }
+    return 0;
+}
+
+// 子状态所在的格子编号（位置、能力、运动方向和是否着地）
+// 同一位置上朝不同方向运动的状态分开保留，否则掉头的状态总会输给继续向右的状态
+static int cell_index(const Child* c) {
+    int x = c->cell < MAP_WIDTH ? c->cell : MAP_WIDTH - 1;
+    return ((x * CELL_ROWS + c->cell_y) * 4 + c->abilities) * 8 + c->motion;
+}
+
+// 分数从高到低排序；分数相同时按父状态和动作排序，
+// 这样结果与各线程产生子状态的先后（窃取顺序）无关，搜索可以复现
+static int compare_children(const void* a, const void* b) {
+    const Child* ca = (const Child*)a;
+    const Child* cb = (const Child*)b;
+    if (ca->score != cb->score) return (ca->score < cb->score) - (ca->score > cb->score);
+    if (ca->parent != cb->parent) return (ca->parent > cb->parent) - (ca->parent < cb->parent);
+    return (ca->action > cb->action) - (ca->action < cb->action);
+}
+
+// 每一步束中各状态的来源（用于回溯出按键序列）
+typedef struct {
+    int* parents;
+    unsigned char* actions;
+} StepHistory;
+
+int main(int argc, char* argv[]) {
+    int beam_width = 1000;
+    int max_steps = 1000;
+    const char* output = "solver.input";
+    thread_count = SDL_GetCPUCount();
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-w") == 0) beam_width = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-k") == 0) ticks_per_step = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0) thread_count = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-g") == 0) max_steps = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-o") == 0) output = argv[i + 1];
+        else {
+            printf("未知参数: %s\n", argv[i]);
+            printf("用法: %s [-w 束宽] [-k 每步帧数] [-t 线程数] [-g 最大步数] [-o 输出录像]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > MAX_THREADS) thread_count = MAX_THREADS;
+    if (beam_width < 1 || ticks_per_step < 1 || ticks_per_step > 255) {
+        printf("参数无效\n");
+        return 1;
+    }
+
+    // 初始状态
+    set_game_state(GAME_STATE_PLAYING);
+    reset_game();
+    root_lives = knight.lives;
+    beam = (unsigned char*)malloc((size_t)beam_width * SNAPSHOT_MAX_SIZE);
+    beam_sizes = (size_t*)malloc(sizeof(size_t) * beam_width);
+    StepHistory* history = (StepHistory*)calloc((size_t)max_steps, sizeof(StepHistory));
+    int* cell_counts = (int*)calloc((size_t)CELL_COUNT, sizeof(int));
+    if (!beam || !beam_sizes || !history || !cell_counts) {
+        printf("内存不足\n");
+        return 1;
+    }
+    beam_sizes[0] = snapshot_save(beam, SNAPSHOT_MAX_SIZE);
+    beam_count = 1;
+
+    done_sem = SDL_CreateSemaphore(0);
+    for (int t = 0; t < thread_count; t++) {
+        workers[t].index = t;
+        workers[t].start = SDL_CreateSemaphore(0);
+        workers[t].thread = SDL_CreateThread(worker_main, "solver_worker", &workers[t]);
+        if (!workers[t].thread) {
+            printf("无法创建线程: %s\n", SDL_GetError());
+            return 1;
+        }
+    }
+    printf("束搜索: 束宽 %d, 每步 %d 帧, %d 个动作, %d 个线程\n", beam_width, ticks_per_step, ACTION_COUNT, thread_count);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    int found_step = -1, found_index = -1, found_ticks = 0;
+    Child* all = NULL;
+    int all_capacity = 0;
+    uint64_t* seen = NULL;
+    int seen_capacity = 0;
+
+    for (int step = 0; step < max_steps; step++) {
+        // 分发父状态
+        for (int t = 0; t < thread_count; t++) {
+            Worker* w = &workers[t];
+            int begin = (int)((long long)beam_count * t / thread_count);
+            w->end = (int)((long long)beam_count * (t + 1) / thread_count);
+            SDL_AtomicSet(&w->cursor, begin);
+            w->child_count = 0;
+            w->arena_used = 0;
+        }
+        for (int t = 0; t < thread_count; t++) SDL_SemPost(workers[t].start);
+        for (int t = 0; t < thread_count; t++) SDL_SemWait(done_sem);
+        if (SDL_AtomicGet(&load_failed)) {
+            printf("第%d步：快照恢复失败，搜索中止\n", step);
+            break;
+        }
+
+        // 汇总子状态
+        int total = 0;
+        for (int t = 0; t < thread_count; t++) total += workers[t].child_count;
+        if (total == 0) {
+            printf("第%d步：所有状态都已死亡，搜索失败\n", step);
+            break;
+        }
+        if (total > all_capacity) {
+            all_capacity = total * 2;
+            all = (Child*)realloc(all, sizeof(Child) * all_capacity);
+        }
+        int n = 0;
+        for (int t = 0; t < thread_count; t++) {
+            memcpy(all + n, workers[t].children, sizeof(Child) * workers[t].child_count);
+            n += workers[t].child_count;
+        }
+
+        // 通关：取这一步中用帧最少的
+        for (int i = 0; i < n; i++) {
+            if (all[i].won_ticks && (found_index < 0 || all[i].won_ticks < found_ticks)) {
+                found_index = i;
+                found_ticks = all[i].won_ticks;
+            }
+        }
+
+        qsort(all, n, sizeof(Child), compare_children);
+        if (found_index >= 0) {
+            // 排序后重新找到通关的子状态
+            found_index = -1;
+            for (int i = 0; i < n; i++) {
+                if (all[i].won_ticks == found_ticks) {
+                    found_index = i;
+                    break;
+                }
+            }
+        }
+
+        // 去重（开放寻址哈希集合）并限制每个格子的状态数
+        if (seen_capacity < n * 2) {
+            seen_capacity = 1;
+            while (seen_capacity < n * 2) seen_capacity <<= 1;
+            seen = (uint64_t*)realloc(seen, sizeof(uint64_t) * seen_capacity);
+        }
+        memset(seen, 0, sizeof(uint64_t) * seen_capacity);
+        memset(cell_counts, 0, sizeof(int) * CELL_COUNT);
+
+        history[step].parents = (int*)malloc(sizeof(int) * beam_width);
+        history[step].actions = (unsigned char*)malloc(beam_width);
+        unsigned char* next_beam = (unsigned char*)malloc((size_t)beam_width * SNAPSHOT_MAX_SIZE);
+        size_t* next_sizes = (size_t*)malloc(sizeof(size_t) * beam_width);
+        if (!history[step].parents || !history[step].actions || !next_beam || !next_sizes || !all || !seen) {
+            printf("内存不足\n");
+            return 1;
+        }
+
+        int kept = 0, duplicates = 0;
+        float best_score = all[0].score;
+        if (found_index >= 0) {
+            // 已通关：只需要记录通关状态的来源
+            history[step].parents[0] = all[found_index].parent;
+            history[step].actions[0] = all[found_index].action;
+            found_index = 0;
+            kept = 1;
+        } else {
+            // 第一遍：去重，每个格子先保留一个代表，保证束里有各处的状态
+            // （例如去拿冲刺能力要先爬上高台，这段路上的分数比地面上的状态低）。
+            // 代表按哈希而不是分数选：按分数选时总是刚进入格子的状态胜出，
+            // 在格子里多走了几帧的状态永远被淘汰，向左或向上就走不出去
+            for (int i = 0; i < n; i++) {
+                Child* c = &all[i];
+                uint64_t key = c->hash ? c->hash : 1;
+                int slot = (int)(key & (uint64_t)(seen_capacity - 1));
+                c->selected = 0;
+                c->duplicate = 0;
+                while (seen[slot]) {
+                    if (seen[slot] == key) { c->duplicate = 1; break; }
+                    slot = (slot + 1) & (seen_capacity - 1);
+                }
+                if (c->duplicate) { duplicates++; continue; }
+                seen[slot] = key;
+                int cell = cell_index(c);
+                int rep = cell_counts[cell] - 1;
+                if (rep < 0 || all[rep].hash > c->hash) cell_counts[cell] = i + 1;
+            }
+            for (int i = 0; i < n && kept < beam_width; i++) {
+                if (all[i].duplicate || cell_counts[cell_index(&all[i])] != i + 1) continue;
+                all[i].selected = 1;
+                kept++;
+            }
+            memset(cell_counts, 0, sizeof(int) * CELL_COUNT);
+            for (int i = 0; i < n; i++) {
+                if (all[i].selected) cell_counts[cell_index(&all[i])] = 1;
+            }
+            // 第二遍：按分数补满束宽，每个格子最多CELL_CAP个
+            for (int i = 0; i < n && kept < beam_width; i++) {
+                Child* c = &all[i];
+                if (c->duplicate || c->selected) continue;
+                int cell = cell_index(c);
+                if (cell_counts[cell] >= CELL_CAP) continue;
+                cell_counts[cell]++;
+                c->selected = 1;
+                kept++;
+            }
+            kept = 0;
+            for (int i = 0; i < n; i++) {
+                Child* c = &all[i];
+                if (!c->selected) continue;
+                history[step].parents[kept] = c->parent;
+                history[step].actions[kept] = c->action;
+                memcpy(next_beam + (size_t)kept * SNAPSHOT_MAX_SIZE, workers[c->worker].arena + c->offset, c->size);
+                next_sizes[kept] = c->size;
+                kept++;
+            }
+        }
+        free(beam);
+        free(beam_sizes);
+        beam = next_beam;
+        beam_sizes = next_sizes;
+        beam_count = kept;
+
+        if ((step + 1) % 50 == 0 || found_index >= 0) {
+            printf("第%4d步 (第%5d帧): 子状态 %d, 重复 %d, 保留 %d, 最高分 %.1f\n",
+                   step + 1, (step + 1) * ticks_per_step, n, duplicates, kept, best_score);
+        }
+        if (found_index >= 0) {
+            found_step = step;
+            break;
+        }
+    }
+
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    unsigned long long ticks = 0;
+    unsigned int steals = 0;
+    for (int t = 0; t < thread_count; t++) {
+        ticks += workers[t].ticks;
+        steals += workers[t].steals;
+    }
+    printf("用时 %.2f 秒，模拟 %llu 帧（%.0f 帧/秒），窃取 %u 次\n", seconds, ticks, ticks / seconds, steals);
+
+    int result = 1;
+    if (found_step >= 0) {
+        // 回溯按键序列
+        int total_ticks = found_step * ticks_per_step + found_ticks;
+        unsigned char* masks = (unsigned char*)malloc((size_t)total_ticks);
+        int index = found_index;
+        for (int step = found_step; step >= 0; step--) {
+            unsigned int mask = ACTIONS[history[step].actions[index]];
+            int ticks_in_step = step == found_step ? found_ticks : ticks_per_step;
+            for (int t = 0; t < ticks_in_step; t++) {
+                masks[step * ticks_per_step + t] = (unsigned char)mask;
+            }
+            index = history[step].parents[index];
+        }
+
+        // 从头重放验证
+        set_game_state(GAME_STATE_PLAYING);
+        reset_game();
+        for (int t = 0; t < total_ticks; t++) {
+            set_input_mask(masks[t]);
+            game_tick();
+        }
+        KnightProgress progress;
+        knight_get_progress(&progress);
+        if (progress.game_won && replay_save(output, masks, total_ticks)) {
+            printf("找到通关路线: %d 帧（%.2f 秒），已写入 %s\n", total_ticks, total_ticks / 60.0, output);
+            result = 0;
+        } else {
+            printf("重放验证失败\n");
+        }
+        free(masks);
+    } else {
+        printf("没有找到通关路线\n");
+    }
+
+    quitting = 1;
+    for (int t = 0; t < thread_count; t++) SDL_SemPost(workers[t].start);
+    for (int t = 0; t < thread_count; t++) {
+        SDL_WaitThread(workers[t].thread, NULL);
+        SDL_DestroySemaphore(workers[t].start);
+        free(workers[t].children);
+        free(workers[t].arena);
+    }
+    SDL_DestroySemaphore(done_sem);
+    for (int step = 0; step < max_steps; step++) {
+        free(history[step].parents);
+        free(history[step].actions);
+    }
+    free(history);
+    free(cell_counts);
+    free(all);
+    free(seen);
+    free(beam);
+    free(beam_sizes);
+    return result;
+}
@@ -0,0 +1,166 @@
+// udp_relay.c
+// 本机UDP中继：在两个联机进程之间转发数据包，并注入延迟、抖动和丢包，用于在一台机器上测试回滚同步
+//
+// 用法：
+//   udp_relay 端口A 端口B [-d 延迟毫秒] [-j 抖动毫秒] [-l 丢包百分比] [-s 随机种子]
+//   玩家1把数据包发往端口A，玩家2发往端口B，中继把一边收到的包延迟后从另一边转发出去。
+//   例如：
+//     udp_relay 7100 7101 -d 60 -j 20 -l 5
+//     knight_game --netplay 0 7001 127.0.0.1:7100
+//     knight_game --netplay 1 7002 127.0.0.1:7101
+//   每5秒打印一次转发统计，Ctrl+C退出。
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#define MAX_PENDING 4096
+#define MAX_PACKET 512
+
+// 等待转发的数据包
+typedef struct {
+    double release_ms;   // 到达该时刻后转发
+    int to;              // 转发到哪一边
+    size_t size;
+    unsigned char data[MAX_PACKET];
+} PendingPacket;
+
+static PendingPacket pending[MAX_PENDING];
+static int pending_count = 0;
+
+static int sockets[2];
+static struct sockaddr_storage peers[2];  // 每一边最近一次发来数据包的地址
+static socklen_t peer_lengths[2];
+static int peer_known[2];
+
+static unsigned int forwarded = 0, dropped = 0;
+
+// 当前时间（毫秒）
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+// 绑定本地端口
+static int open_socket(int port) {
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) return -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((unsigned short)port);
+    if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+// 转发所有到期的数据包
+static void release_due(double now) {
+    int kept = 0;
+    for (int i = 0; i < pending_count; i++) {
+        PendingPacket* packet = &pending[i];
+        if (packet->release_ms <= now) {
+            int to = packet->to;
+            if (peer_known[to]) {
+                sendto(sockets[to], packet->data, packet->size, 0,
+                       (struct sockaddr*)&peers[to], peer_lengths[to]);
+                forwarded++;
+            } else {
+                dropped++; // 另一边还没有发过包，不知道它的地址
+            }
+        } else {
+            if (kept != i) pending[kept] = *packet;
+            kept++;
+        }
+    }
+    pending_count = kept;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printf("用法: %s 端口A 端口B [-d 延迟毫秒] [-j 抖动毫秒] [-l 丢包百分比] [-s 随机种子]\n", argv[0]);
+        return 1;
+    }
+    int ports[2] = { atoi(argv[1]), atoi(argv[2]) };
+    double delay = 0.0, jitter = 0.0, loss = 0.0;
+    unsigned int seed = 1;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-d") == 0) {
+            delay = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "-j") == 0) {
+            jitter = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "-l") == 0) {
+            loss = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            seed = (unsigned int)atoi(argv[i + 1]);
+        } else {
+            printf("未知参数: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    srand(seed);
+
+    for (int side = 0; side < 2; side++) {
+        sockets[side] = open_socket(ports[side]);
+        if (sockets[side] < 0) {
+            printf("无法绑定端口 %d\n", ports[side]);
+            return 1;
+        }
+    }
+    printf("UDP中继: %d <-> %d, 延迟%.0fms, 抖动%.0fms, 丢包%.1f%%\n", ports[0], ports[1], delay, jitter, loss);
+
+    double next_report = now_ms() + 5000.0;
+    while (1) {
+        // 等到下一个包到期（最多1毫秒），期间接收新包
+        struct pollfd fds[2] = { { sockets[0], POLLIN, 0 }, { sockets[1], POLLIN, 0 } };
+        poll(fds, 2, 1);
+        double now = now_ms();
+
+        for (int side = 0; side < 2; side++) {
+            if (!(fds[side].revents & POLLIN)) continue;
+            PendingPacket incoming;
+            struct sockaddr_storage from;
+            socklen_t from_length = sizeof(from);
+            ssize_t size = recvfrom(sockets[side], incoming.data, MAX_PACKET, 0,
+                                    (struct sockaddr*)&from, &from_length);
+            if (size <= 0) continue;
+            peers[side] = from;
+            peer_lengths[side] = from_length;
+            peer_known[side] = 1;
+
+            if (loss > 0.0 && rand() % 10000 < (int)(loss * 100.0)) {
+                dropped++;
+                continue;
+            }
+            if (pending_count >= MAX_PENDING) {
+                dropped++;
+                continue;
+            }
+            incoming.size = (size_t)size;
+            incoming.to = 1 - side;
+            incoming.release_ms = now + delay + (jitter > 0.0 ? jitter * rand() / (double)RAND_MAX : 0.0);
+            pending[pending_count++] = incoming;
+        }
+
+        release_due(now);
+
+        if (now >= next_report) {
+            printf("已转发 %u 包, 丢弃 %u 包, 排队 %d 包\n", forwarded, dropped, pending_count);
+            fflush(stdout);
+            next_report = now + 5000.0;
+        }
+    }
+    return 0;
+}